@@ -105,7 +105,6 @@ static int init_comm_buffers(void) {
     }
 
     /* we'll reference emcmotStruct directly */
-    c = &emcmotStruct->command;
     emcmotStatus = &emcmotStruct->status;
     emcmotConfig = &emcmotStruct->config;
     emcmotInternal = &emcmotStruct->internal;
@@ -125,6 +124,8 @@ static int init_comm_buffers(void) {
        override, and feed hold are on */
     emcmotStatus->enables_new = FS_ENABLED | SS_ENABLED | FH_ENABLED;
     emcmotStatus->enables_queued = emcmotStatus->enables_new;
+    /* moves are only logged, so there is always room for more */
+    emcmotStatus->queueSpace = DEFAULT_TC_QUEUE_SIZE;
     SET_MOTION_INPOS_FLAG(1);
     emcmotConfig->kinType = KINEMATICS_IDENTITY;
 
@@ -179,6 +180,8 @@ static int init_comm_buffers(void) {
         axis_set_acc_limit(axis_num, 1.0);
     }
 
+    emcmotStatusPublish(&emcmotStruct->status_snapshot, emcmotStatus);
+
     rtapi_print_msg(RTAPI_MSG_INFO, "MOTION: init_comm_buffers() complete\n");
     return 0;
 }
@@ -315,11 +318,10 @@ int main(int argc, char* argv[]) {
     }
 
     while (!quit) {
-        rtapi_mutex_get(&emcmotStruct->command_mutex);
+        c = emcmotCommandPeek(&emcmotStruct->command);
 
-        if (c->commandNum == emcmotStatus->commandNumEcho) {
+        if (c == NULL) {
             // nothing new
-            rtapi_mutex_give(&emcmotStruct->command_mutex);
             maybe_reopen_logfile();
             usleep(10 * 1000);
             continue;
@@ -329,8 +331,6 @@ int main(int argc, char* argv[]) {
         // new incoming command!
         //
 
-        emcmotStatus->head++;
-
         switch (c->command) {
             case EMCMOT_ABORT:
                 log_print("ABORT\n");
@@ -453,34 +453,40 @@ int main(int argc, char* argv[]) {
                 log_print("JOG_ABS\n");
                 break;
 
-            case EMCMOT_SET_LINE:
-                log_print(
-                    "SET_LINE x=%.6g, y=%.6g, z=%.6g, a=%.6g, b=%.6g, c=%.6g, u=%.6g, v=%.6g, w=%.6g, id=%d, motion_type=%d, vel=%.6g, ini_maxvel=%.6g, acc=%.6g, turn=%d\n",
-                    c->pos.tran.x, c->pos.tran.y, c->pos.tran.z,
-                    c->pos.a, c->pos.b, c->pos.c,
-                    c->pos.u, c->pos.v, c->pos.w,
-                    c->id, c->motion_type,
-                    c->vel, c->ini_maxvel,
-                    c->acc, c->turn
-                );
-                break;
-
-            case EMCMOT_SET_CIRCLE:
-                log_print("SET_CIRCLE:\n");
-                log_print(
-                    "    pos: x=%.6g, y=%.6g, z=%.6g, a=%.6g, b=%.6g, c=%.6g, u=%.6g, v=%.6g, w=%.6g\n",
-                    c->pos.tran.x, c->pos.tran.y, c->pos.tran.z,
-                    c->pos.a, c->pos.b, c->pos.c,
-                    c->pos.u, c->pos.v, c->pos.w
-                );
-                log_print("    center: x=%.6g, y=%.6g, z=%.6g\n", c->center.x, c->center.y, c->center.z);
-                log_print("    normal: x=%.6g, y=%.6g, z=%.6g\n", c->normal.x, c->normal.y, c->normal.z);
-                log_print("    id=%d, motion_type=%d, vel=%.6g, ini_maxvel=%.6g, acc=%.6g, turn=%d\n",
-                    c->id, c->motion_type,
-                    c->vel, c->ini_maxvel,
-                    c->acc, c->turn
-                );
+            case EMCMOT_SET_SEGMENTS: {
+                // one line per move, as when each came in its own command
+                int i;
+                for (i = 0; i < c->num_segments; i++) {
+                    emcmot_segment_t *seg = &c->segment[i];
+                    if (!seg->circle) {
+                        log_print(
+                            "SET_LINE x=%.6g, y=%.6g, z=%.6g, a=%.6g, b=%.6g, c=%.6g, u=%.6g, v=%.6g, w=%.6g, id=%d, motion_type=%d, vel=%.6g, ini_maxvel=%.6g, acc=%.6g, turn=%d\n",
+                            seg->pos.tran.x, seg->pos.tran.y, seg->pos.tran.z,
+                            seg->pos.a, seg->pos.b, seg->pos.c,
+                            seg->pos.u, seg->pos.v, seg->pos.w,
+                            seg->id, seg->motion_type,
+                            seg->vel, seg->ini_maxvel,
+                            seg->acc, seg->turn
+                        );
+                        continue;
+                    }
+                    log_print("SET_CIRCLE:\n");
+                    log_print(
+                        "    pos: x=%.6g, y=%.6g, z=%.6g, a=%.6g, b=%.6g, c=%.6g, u=%.6g, v=%.6g, w=%.6g\n",
+                        seg->pos.tran.x, seg->pos.tran.y, seg->pos.tran.z,
+                        seg->pos.a, seg->pos.b, seg->pos.c,
+                        seg->pos.u, seg->pos.v, seg->pos.w
+                    );
+                    log_print("    center: x=%.6g, y=%.6g, z=%.6g\n", seg->center.x, seg->center.y, seg->center.z);
+                    log_print("    normal: x=%.6g, y=%.6g, z=%.6g\n", seg->normal.x, seg->normal.y, seg->normal.z);
+                    log_print("    id=%d, motion_type=%d, vel=%.6g, ini_maxvel=%.6g, acc=%.6g, turn=%d\n",
+                        seg->id, seg->motion_type,
+                        seg->vel, seg->ini_maxvel,
+                        seg->acc, seg->turn
+                    );
+                }
                 break;
+            }
 
             case EMCMOT_CLEAR_PROBE_FLAGS:
                 log_print("CLEAR_PROBE_FLAGS\n");
@@ -711,9 +717,9 @@ int main(int argc, char* argv[]) {
         emcmotStatus->commandEcho = c->command;
         emcmotStatus->commandNumEcho = c->commandNum;
         emcmotStatus->commandStatus = EMCMOT_COMMAND_OK;
-        emcmotStatus->tail = emcmotStatus->head;
+        emcmotStatusPublish(&emcmotStruct->status_snapshot, emcmotStatus);
 
-        rtapi_mutex_give(&emcmotStruct->command_mutex);
+        emcmotCommandTake(&emcmotStruct->command);
     }
 
     if((r = rtapi_shmem_delete(shmem_id, mot_comp_id)) < 0) {
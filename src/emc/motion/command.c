@@ -56,8 +56,8 @@
 
 #include <float.h>
 #include <rtapi.h>
-#include <rtapi_mutex.h>
 #include <rtapi_math.h>
+#include <rtapi_string.h>
 #include <hal.h>
 #include <motion_types.h>
 #include <posemath.h>
@@ -77,9 +77,14 @@
 #define _(s) (s)
 
 extern int motion_num_spindles;
+extern int motion_commands_per_period;
 
 static int rehomeAll;
 
+/* set when a queued move has failed: the moves task queued after it,
+   before it heard of the failure, are dropped until task aborts */
+static int dropMoves;
+
 /* ===== BEGIN PLANNER_SWITCH_DEFER (reversible) =====================================
  * Deferred PLANNER_TYPE switching. Switching 0<->1 mid-motion causes an acceleration
  * discontinuity (the very thing the S-curve planner exists to avoid), so a switch
@@ -409,14 +414,159 @@ STATIC int is_feed_type(int motion_type)
     }
 }
 
+/* the state tag of a move, from the move's fields and the file name
+   of the command it came in */
+STATIC struct state_tag_t segment_tag(const emcmot_segment_t *seg)
+{
+    struct state_tag_t tag;
+
+    memcpy(tag.fields_float, seg->fields_float, sizeof(tag.fields_float));
+    memcpy(tag.fields, seg->fields, sizeof(tag.fields));
+    tag.packed_flags = seg->packed_flags;
+    memcpy(tag.filename, emcmotCommand->tag.filename, sizeof(tag.filename));
+    return tag;
+}
 
 /*
-  emcmotCommandHandler() is called each main cycle to read the
-  shared memory buffer
+  set_line() and set_circle() add one move of an EMCMOT_SET_SEGMENTS
+  command to the coordinated planner queue.  If it can't be added they
+  set emcmotStatus->commandStatus, and abort the queue unless the move
+  just came at the wrong time.
+  */
+STATIC void set_line(const emcmot_segment_t *seg)
+{
+    char issue_atspeed = 0;
+
+    /* requires motion enabled, coordinated mode, not on limits */
+    rtapi_print_msg(RTAPI_MSG_DBG, " SET_LINE");
+    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
+	reportError(_("need to be enabled, in coord mode for linear move"));
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    } else if (!inRange(seg->pos, seg->id, "Linear")) {
+	reportError(_("invalid params in linear command"));
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    } else if (!limits_ok()) {
+	reportError(_("can't do linear move with limits exceeded"));
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    }
+
+    if (emcmotStatus->atspeed_next_feed && is_feed_type(seg->motion_type)) {
+	issue_atspeed = 1;
+	emcmotStatus->atspeed_next_feed = 0;
+    }
+    if (!is_feed_type(seg->motion_type) &&
+	    emcmotStatus->spindle_status[seg->spindle].css_factor) {
+	emcmotStatus->atspeed_next_feed = 1;
+    }
+
+    /* append it to the emcmotInternal->coord_tp */
+    tpSetId(&emcmotInternal->coord_tp, seg->id);
+    int res_addline = tpAddLine(&emcmotInternal->coord_tp,
+				seg->pos,
+				seg->motion_type,
+				seg->vel,
+				seg->ini_maxvel,
+				seg->acc,
+				seg->ini_maxjerk,
+				emcmotStatus->enables_new,
+				issue_atspeed,
+				seg->turn,
+				segment_tag(seg));
+    //KLUDGE ignore zero length line
+    if (res_addline < 0) {
+	reportError(_("can't add linear move at line %d, error code %d"),
+		seg->id, res_addline);
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+    } else if (res_addline != 0) {
+	//TODO make this hand-shake more explicit
+	//KLUDGE Non fatal error, need to restore state so that the next
+	//line properly handles at_speed
+	if (issue_atspeed) {
+	    emcmotStatus->atspeed_next_feed = 1;
+	}
+    } else {
+	SET_MOTION_ERROR_FLAG(0);
+	/* set flag that indicates all joints need rehoming, if any
+	   joint is moved in joint mode, for machines with no forward
+	   kins */
+	rehomeAll = 1;
+    }
+}
+
+STATIC void set_circle(const emcmot_segment_t *seg)
+{
+    char issue_atspeed = 0;
+
+    /* requires coordinated mode, enable on, not on limits */
+    rtapi_print_msg(RTAPI_MSG_DBG, " SET_CIRCLE");
+    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
+	reportError(_("need to be enabled, in coord mode for circular move"));
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    } else if (!inRange(seg->pos, seg->id, "Circular")) {
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    } else if (!limits_ok()) {
+	reportError(_("can't do circular move with limits exceeded"));
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+	return;
+    }
+    if (emcmotStatus->atspeed_next_feed) {
+	issue_atspeed = 1;
+	emcmotStatus->atspeed_next_feed = 0;
+    }
+    /* append it to the emcmotInternal->coord_tp */
+    tpSetId(&emcmotInternal->coord_tp, seg->id);
+    int res_addcircle = tpAddCircle(&emcmotInternal->coord_tp, seg->pos,
+				    seg->center, seg->normal,
+				    seg->turn, seg->motion_type,
+				    seg->vel, seg->ini_maxvel,
+				    seg->acc, seg->ini_maxjerk, emcmotStatus->enables_new,
+				    issue_atspeed, segment_tag(seg));
+    if (res_addcircle < 0) {
+	reportError(_("can't add circular move at line %d, error code %d"),
+		seg->id, res_addcircle);
+	emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
+	tpAbort(&emcmotInternal->coord_tp);
+	SET_MOTION_ERROR_FLAG(1);
+    } else if (res_addcircle != 0) {
+	//FIXME! This is a band-aid for a single issue, but there may be
+	//other consequences of non-fatal errors from AddXXX functions. We
+	//either need to fix the root cause (subtle position error after
+	//homing), or have a full restore here.
+	if (issue_atspeed) {
+	    emcmotStatus->atspeed_next_feed = 1;
+	}
+    } else {
+	SET_MOTION_ERROR_FLAG(0);
+	/* set flag that indicates all joints need rehoming, if any
+	   joint is moved in joint mode, for machines with no forward
+	   kins */
+	rehomeAll = 1;
+    }
+}
+
 
-  This function runs with the emcmotCommand struct locked.
+/*
+  emcmotCommandHandleOne() handles the command emcmotCommand points
+  to, in its slot of the command ring.
   */
-void emcmotCommandHandler_locked(void *arg, long servo_period)
+static void emcmotCommandHandleOne(void *arg, long servo_period)
 {
     (void)arg;
     int joint_num, spindle_num;
@@ -429,8 +579,7 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
     char* emsg = "";
 
     if (emcmotCommand->commandNum != emcmotStatus->commandNumEcho) {
-	/* increment head count-- we'll be modifying emcmotStatus */
-	emcmotStatus->head++;
+	/* increment head count-- we'll be modifying emcmotInternal */
 	emcmotInternal->head++;
 
 	/* got a new command-- echo command and number... */
@@ -534,6 +683,7 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 	       does yet), and if in free mode, it disables the free mode traj
 	       planners which stops joint motion */
 	    rtapi_print_msg(RTAPI_MSG_DBG, "ABORT");
+	    dropMoves = 0;
 	    /* check for coord or free space motion active */
 	    if (GET_MOTION_TELEOP_FLAG()) {
                 axis_jog_abort_all(0);
@@ -1054,129 +1204,28 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 		tpSetSpindleSync(&emcmotInternal->coord_tp, emcmotCommand->spindle, emcmotCommand->spindlesync, emcmotCommand->flags);
 		break;
 
-	case EMCMOT_SET_LINE:
-	    /* emcmotInternal->coord_tp up a linear move */
-	    /* requires motion enabled, coordinated mode, not on limits */
-	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_LINE");
-	    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
-		reportError(_("need to be enabled, in coord mode for linear move"));
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
-		SET_MOTION_ERROR_FLAG(1);
-		break;
-	    } else if (!inRange(emcmotCommand->pos, emcmotCommand->id, "Linear")) {
-		reportError(_("invalid params in linear command"));
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
-		tpAbort(&emcmotInternal->coord_tp);
-		SET_MOTION_ERROR_FLAG(1);
+	case EMCMOT_SET_SEGMENTS:
+	    /* set up a run of linear and circular moves, stopping at
+	       the first one that fails */
+	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_SEGMENTS %d", emcmotCommand->num_segments);
+	    if (dropMoves) {
+		rtapi_print_msg(RTAPI_MSG_DBG, " dropped");
 		break;
-	    } else if (!limits_ok()) {
-		reportError(_("can't do linear move with limits exceeded"));
+	    }
+	    if (emcmotCommand->num_segments < 0 ||
+		emcmotCommand->num_segments > EMCMOT_MAX_SEGMENTS) {
 		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
-		tpAbort(&emcmotInternal->coord_tp);
-		SET_MOTION_ERROR_FLAG(1);
 		break;
 	    }
-
-		if(emcmotStatus->atspeed_next_feed && is_feed_type(emcmotCommand->motion_type) ) {
-			issue_atspeed = 1;
-			emcmotStatus->atspeed_next_feed = 0;
+	    for (n = 0; n < emcmotCommand->num_segments; n++) {
+		if (emcmotCommand->segment[n].circle) {
+		    set_circle(&emcmotCommand->segment[n]);
+		} else {
+		    set_line(&emcmotCommand->segment[n]);
 		}
-		if(!is_feed_type(emcmotCommand->motion_type) &&
-				emcmotStatus->spindle_status[emcmotCommand->spindle].css_factor) {
-			emcmotStatus->atspeed_next_feed = 1;
+		if (emcmotStatus->commandStatus != EMCMOT_COMMAND_OK) {
+		    break;
 		}
-
-	    /* append it to the emcmotInternal->coord_tp */
-	    tpSetId(&emcmotInternal->coord_tp, emcmotCommand->id);
-	    int res_addline = tpAddLine(&emcmotInternal->coord_tp,
-					emcmotCommand->pos,
-					emcmotCommand->motion_type,
-					emcmotCommand->vel,
-					emcmotCommand->ini_maxvel,
-					emcmotCommand->acc,
-					emcmotCommand->ini_maxjerk, 
-					emcmotStatus->enables_new,
-					issue_atspeed,
-					emcmotCommand->turn,
-					emcmotCommand->tag);
-        //KLUDGE ignore zero length line
-        if (res_addline < 0) {
-            reportError(_("can't add linear move at line %d, error code %d"),
-                    emcmotCommand->id, res_addline);
-            emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
-            tpAbort(&emcmotInternal->coord_tp);
-            SET_MOTION_ERROR_FLAG(1);
-            break;
-        } else if (res_addline != 0) {
-            //TODO make this hand-shake more explicit
-            //KLUDGE Non fatal error, need to restore state so that the next
-            //line properly handles at_speed
-            if (issue_atspeed) {
-                emcmotStatus->atspeed_next_feed = 1;
-            }
-        } else {
-		SET_MOTION_ERROR_FLAG(0);
-		/* set flag that indicates all joints need rehoming, if any
-		   joint is moved in joint mode, for machines with no forward
-		   kins */
-		rehomeAll = 1;
-	    }
-	    break;
-
-	case EMCMOT_SET_CIRCLE:
-	    /* emcmotInternal->coord_tp up a circular move */
-	    /* requires coordinated mode, enable on, not on limits */
-	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_CIRCLE");
-	    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
-		reportError(_("need to be enabled, in coord mode for circular move"));
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
-		SET_MOTION_ERROR_FLAG(1);
-		break;
-	    } else if (!inRange(emcmotCommand->pos, emcmotCommand->id, "Circular")) {
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
-		tpAbort(&emcmotInternal->coord_tp);
-		SET_MOTION_ERROR_FLAG(1);
-		break;
-	    } else if (!limits_ok()) {
-		reportError(_("can't do circular move with limits exceeded"));
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
-		tpAbort(&emcmotInternal->coord_tp);
-		SET_MOTION_ERROR_FLAG(1);
-		break;
-	    }
-            if(emcmotStatus->atspeed_next_feed) {
-                issue_atspeed = 1;
-                emcmotStatus->atspeed_next_feed = 0;
-            }
-	    /* append it to the emcmotInternal->coord_tp */
-	    tpSetId(&emcmotInternal->coord_tp, emcmotCommand->id);
-	    int res_addcircle = tpAddCircle(&emcmotInternal->coord_tp, emcmotCommand->pos,
-                            emcmotCommand->center, emcmotCommand->normal,
-                            emcmotCommand->turn, emcmotCommand->motion_type,
-                            emcmotCommand->vel, emcmotCommand->ini_maxvel,
-                            emcmotCommand->acc, emcmotCommand->ini_maxjerk, emcmotStatus->enables_new,
-			    issue_atspeed, emcmotCommand->tag);
-        if (res_addcircle < 0) {
-            reportError(_("can't add circular move at line %d, error code %d"),
-                    emcmotCommand->id, res_addcircle);
-		emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
-		tpAbort(&emcmotInternal->coord_tp);
-		SET_MOTION_ERROR_FLAG(1);
-		break;
-        } else if (res_addcircle != 0) {
-            //FIXME! This is a band-aid for a single issue, but there may be
-            //other consequences of non-fatal errors from AddXXX functions. We
-            //either need to fix the root cause (subtle position error after
-            //homing), or have a full restore here.
-            if (issue_atspeed) {
-                emcmotStatus->atspeed_next_feed = 1;
-            }
-        } else {
-		SET_MOTION_ERROR_FLAG(0);
-		/* set flag that indicates all joints need rehoming, if any
-		   joint is moved in joint mode, for machines with no forward
-		   kins */
-		rehomeAll = 1;
 	    }
 	    break;
 
@@ -1552,7 +1601,7 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 	    break;
 
 	case EMCMOT_PROBE:
-	    /* most of this is taken from EMCMOT_SET_LINE */
+	    /* most of this is taken from set_line() */
 	    /* emcmotInternal->coord_tp up a linear move */
 	    /* requires coordinated mode, enable off, not on limits */
 	    rtapi_print_msg(RTAPI_MSG_DBG, "PROBE");
@@ -1630,7 +1679,7 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 	    break;
 
 	case EMCMOT_RIGID_TAP:
-	    /* most of this is taken from EMCMOT_SET_LINE */
+	    /* most of this is taken from set_line() */
 	    /* emcmotInternal->coord_tp up a linear move */
 	    /* requires coordinated mode, enable off, not on limits */
 	    rtapi_print_msg(RTAPI_MSG_DBG, "RIGID_TAP");
@@ -2082,10 +2131,14 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 	if (emcmotStatus->commandStatus != EMCMOT_COMMAND_OK) {
 	    rtapi_print_msg(RTAPI_MSG_DBG, "ERROR: %d",
 		emcmotStatus->commandStatus);
+	    /* task may not be waiting for this one, tell it later */
+	    emcmotStatus->commandNumFailed = emcmotCommand->commandNum;
+	    if (emcmotCommand->command == EMCMOT_SET_SEGMENTS) {
+		dropMoves = 1;
+	    }
 	}
 	rtapi_print_msg(RTAPI_MSG_DBG, "\n");
 	/* synch tail count */
-	emcmotStatus->tail = emcmotStatus->head;
 	emcmotConfig->tail = emcmotConfig->head;
 	emcmotInternal->tail = emcmotInternal->head;
 
@@ -2096,13 +2149,28 @@ void emcmotCommandHandler_locked(void *arg, long servo_period)
 }
 
 
+/*
+  emcmotCommandHandler() is called each main cycle to take the commands
+  task has put in the shared memory ring.  A run of EMCMOT_SET_SEGMENTS
+  commands is taken up to commands_per_period at a time, so that short
+  segments reach the planner faster than one per cycle.  Any other
+  command ends the run, since the controller may have to run once before the next command
+  sees what it did (enabling, changing modes and so on).
+  */
 void emcmotCommandHandler(void *arg, long servo_period) {
-    if (rtapi_mutex_try(&emcmotStruct->command_mutex) != 0) {
-        // Failed to take the mutex, because it is held by Task.
-        // This means Task is in the process of updating the command.
-        // Give up for now, and try again on the next invocation.
-        return;
+    cmd_code_t command;
+    int n;
+
+    for (n = 0; n < motion_commands_per_period; n++) {
+        emcmotCommand = emcmotCommandPeek(&emcmotStruct->command);
+        if (emcmotCommand == NULL) {
+            break;
+        }
+        command = emcmotCommand->command;
+        emcmotCommandHandleOne(arg, servo_period);
+        emcmotCommandTake(&emcmotStruct->command);
+        if (command != EMCMOT_SET_SEGMENTS) {
+            break;
+        }
     }
-    emcmotCommandHandler_locked(arg, servo_period);
-    rtapi_mutex_give(&emcmotStruct->command_mutex);
 }
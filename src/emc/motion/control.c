@@ -31,6 +31,7 @@
 #include "simple_tp.h"
 #include "motion.h"
 #include "mot_priv.h"
+#include "motion_struct.h"
 #include "homing.h"
 #include "axis.h"
 #include "../nml_intf/state_tag.h"
@@ -240,8 +241,6 @@ void emcmotController(void *arg, long period)
         last_period = period;
     }
 
-    /* increment head count to indicate work in progress */
-    emcmotStatus->head++;
     /* here begins the core of the controller */
 
     read_homing_in_pins(ALL_JOINTS);
@@ -274,8 +273,8 @@ void emcmotController(void *arg, long period)
     update_status();
     /* here ends the core of the controller */
     emcmotStatus->heartbeat++;
-    /* set tail to head, to indicate work complete */
-    emcmotStatus->tail = emcmotStatus->head;
+    /* let userspace see the status of this period, all at once */
+    emcmotStatusPublish(&emcmotStruct->status_snapshot, emcmotStatus);
 /* end of controller function */
 }
 
@@ -2102,7 +2101,7 @@ static void output_to_hal(void)
 
 static void update_status(void)
 {
-    int joint_num, axis_num, dio, aio, misc_error;
+    int joint_num, axis_num, dio, aio, misc_error, tc_fill;
     emcmot_joint_t *joint;
     emcmot_joint_status_t *joint_status;
     emcmot_axis_status_t *axis_status;
@@ -2210,6 +2209,12 @@ static void update_status(void)
     emcmotStatus->tag = tpGetExecTag(&emcmotInternal->coord_tp);
     emcmotStatus->motionType = tpGetMotionType(&emcmotInternal->coord_tp);
     emcmotStatus->queueFull = tcqFull(&emcmotInternal->coord_tp.queue);
+    emcmotStatus->queueSpace = tcqSpace(&emcmotInternal->coord_tp.queue);
+    tc_fill = tcqLen(&emcmotInternal->coord_tp.queue);
+    hal_set_si32(emcmot_hal_data->tc_queue_fill, tc_fill);
+    if (tc_fill > hal_get_si32(emcmot_hal_data->tc_queue_high_water)) {
+        hal_set_si32(emcmot_hal_data->tc_queue_high_water, tc_fill);
+    }
 
     /* check to see if we should pause in order to implement
        single emcmotStatus->stepping */
@@ -130,3 +130,164 @@ int emcmotErrorGet(emcmot_error_t * errlog, char *error)
 
     return 0;
 }
+
+/*
+ * Lockfree single-producer single-consumer (SPSC) ring buffer of commands.
+ *
+ * The producer is task (usrmotintf.cc), the consumer is the motion
+ * command handler.  Neither ever waits for the other here: a full ring
+ * makes emcmotCommandPut() fail, an empty one makes emcmotCommandPeek()
+ * return NULL.
+ *
+ * Producer:
+ *   1. Bail if write_seq - read_seq is the size of the ring.
+ *   2. Copy the command into slot write_seq % EMCMOT_COMMAND_NUM.
+ *   3. Increment write_seq with release ordering.
+ * Consumer:
+ *   1. If read_seq == write_seq there is nothing to do.
+ *   2. Otherwise handle the command in slot read_seq where it is, then
+ *      increment read_seq with release ordering to hand the slot back.
+ *
+ * Both counters start at zero in fresh shared memory and are never
+ * reset, so that commands task puts in before motion is up aren't lost.
+ */
+
+int emcmotCommandPut(emcmot_command_ring_t * ring, const emcmot_command_t * c)
+{
+    unsigned int w, r;
+
+    if (ring == NULL) {
+	return -1;
+    }
+
+    w = atomic_load_explicit(&ring->write_seq, memory_order_relaxed);
+    r = atomic_load_explicit(&ring->read_seq, memory_order_acquire);
+    if (w - r >= (unsigned int)EMCMOT_COMMAND_NUM) {
+	return -1;
+    }
+
+    ring->command[w % EMCMOT_COMMAND_NUM] = *c;
+    atomic_store_explicit(&ring->write_seq, w + 1, memory_order_release);
+
+    return 0;
+}
+
+emcmot_command_t *emcmotCommandPeek(emcmot_command_ring_t * ring)
+{
+    unsigned int w, r;
+
+    if (ring == NULL) {
+	return NULL;
+    }
+
+    r = atomic_load_explicit(&ring->read_seq, memory_order_relaxed);
+    w = atomic_load_explicit(&ring->write_seq, memory_order_acquire);
+    if (r == w) {
+	return NULL;
+    }
+
+    return &ring->command[r % EMCMOT_COMMAND_NUM];
+}
+
+void emcmotCommandTake(emcmot_command_ring_t * ring)
+{
+    unsigned int r;
+
+    r = atomic_load_explicit(&ring->read_seq, memory_order_relaxed);
+    atomic_store_explicit(&ring->read_seq, r + 1, memory_order_release);
+}
+
+/*
+ * Double buffered seqlock of status snapshots.
+ *
+ * The writer is the motion controller, once at the end of each servo
+ * period (or motion-logger in its place).  Readers are task and anything
+ * else in userspace.  The writer never waits for a reader, and a reader
+ * never gives up: it always gets a copy of one complete period.
+ *
+ * Writer:
+ *   1. Pick the copy n that is not the latest.
+ *   2. Make seq[n] odd, copy the status in, make seq[n] even again with
+ *      release ordering.
+ *   3. Store n in latest with release ordering.
+ * Reader:
+ *   1. Load latest, then seq[n] with acquire ordering.  An odd seq means
+ *      the writer has already come round to this copy again: start over.
+ *   2. Copy the parts asked for, then load seq[n] again.  If it changed
+ *      the copy may be torn: start over.
+ *
+ * As the writer only ever fills the copy readers aren't sent to, a reader
+ * has to start over only if one copy takes it longer than a servo period.
+ */
+
+#define STATUS_END_OF(m) \
+    (offsetof(emcmot_status_t, m) + sizeof(((emcmot_status_t *)0)->m))
+
+static void status_copy(emcmot_status_t * s, const emcmot_status_t * from,
+    size_t start, size_t end)
+{
+    memcpy((char *) s + start, (const char *) from + start, end - start);
+}
+
+void emcmotStatusPublish(emcmot_status_snapshot_t * snap,
+    const emcmot_status_t * s)
+{
+    unsigned int n, seq;
+
+    n = !atomic_load_explicit(&snap->latest, memory_order_relaxed);
+    seq = atomic_load_explicit(&snap->seq[n], memory_order_relaxed);
+
+    atomic_store_explicit(&snap->seq[n], seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    snap->status[n] = *s;
+    atomic_store_explicit(&snap->seq[n], seq + 2, memory_order_release);
+
+    atomic_store_explicit(&snap->latest, n, memory_order_release);
+}
+
+int emcmotStatusGet(emcmot_status_snapshot_t * snap, emcmot_status_t * s,
+    int parts)
+{
+    const emcmot_status_t *from;
+    unsigned int n, seq;
+
+    if (snap == NULL) {
+	return -1;
+    }
+
+    for (;;) {
+	n = atomic_load_explicit(&snap->latest, memory_order_acquire) & 1;
+	seq = atomic_load_explicit(&snap->seq[n], memory_order_acquire);
+	if (seq & 1) {
+	    continue;
+	}
+	from = &snap->status[n];
+
+	if ((parts & EMCMOT_STATUS_ALL) == EMCMOT_STATUS_ALL) {
+	    *s = *from;
+	} else {
+	    if (parts & EMCMOT_STATUS_TRAJ) {
+		status_copy(s, from, 0, offsetof(emcmot_status_t, joint_status));
+		status_copy(s, from, STATUS_END_OF(spindle_status),
+		    sizeof(emcmot_status_t));
+	    }
+	    if (parts & EMCMOT_STATUS_JOINTS) {
+		status_copy(s, from, offsetof(emcmot_status_t, joint_status),
+		    STATUS_END_OF(joint_status));
+	    }
+	    if (parts & EMCMOT_STATUS_AXES) {
+		status_copy(s, from, offsetof(emcmot_status_t, axis_status),
+		    STATUS_END_OF(axis_status));
+	    }
+	    if (parts & EMCMOT_STATUS_SPINDLES) {
+		status_copy(s, from, offsetof(emcmot_status_t, spindleSync),
+		    STATUS_END_OF(spindle_status));
+	    }
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+	if (atomic_load_explicit(&snap->seq[n], memory_order_relaxed) == seq) {
+	    return 0;
+	}
+    }
+}
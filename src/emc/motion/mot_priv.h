@@ -147,6 +147,9 @@ typedef struct {
     hal_real_t current_vel;	/* RPI: velocity magnitude in machine units */
     hal_real_t requested_vel;   /* RPI: requested velocity magnitude in machine units */
     hal_real_t distance_to_go;	/* RPI: distance to go in current move*/
+    hal_sint_t tc_queue_size;	/* RPI: length of the trajectory planner queue */
+    hal_sint_t tc_queue_fill;	/* RPI: segments currently in the queue */
+    hal_sint_t tc_queue_high_water; /* RPI: most segments ever in the queue */
 
     hal_bool_t debug_bit_0;	/* RPA: generic param, for debugging */
     hal_bool_t debug_bit_1;	/* RPA: generic param, for debugging */
@@ -50,6 +50,12 @@ int base_thread_fp = 0;	/* default is no floating point in base thread */
 RTAPI_MP_INT(base_thread_fp, "floating point in base thread?");
 static long servo_period_nsec = 1000000;	/* servo thread period */
 RTAPI_MP_LONG(servo_period_nsec, "servo thread period (nsecs)");
+static int base_thread_cpu = -1;	/* CPU for the base thread */
+RTAPI_MP_INT(base_thread_cpu, "CPU to run the base thread on (-1 = default)");
+static int servo_thread_cpu = -1;	/* CPU for the servo thread */
+RTAPI_MP_INT(servo_thread_cpu, "CPU to run the servo thread on (-1 = default)");
+static int servo_thread_workers[HAL_THREAD_WORKERS] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+RTAPI_MP_ARRAY_INT(servo_thread_workers, HAL_THREAD_WORKERS, "CPUs of the workers of the servo thread");
 static long traj_period_nsec = 0;	/* trajectory planner period */
 RTAPI_MP_LONG(traj_period_nsec, "trajectory planner period (nsecs)");
 static int num_spindles = 1; /* default number of spindles is 1 */
@@ -81,6 +87,13 @@ RTAPI_MP_ARRAY_STRING(names_misc_errors, EMCMOT_MAX_MISC_ERROR, "names of errors
 
 static int unlock_joints_mask = 0;/* mask to select joints for unlock pins */
 RTAPI_MP_INT(unlock_joints_mask, "mask to select joints for unlock pins");
+
+static int tc_queue_size = DEFAULT_TC_QUEUE_SIZE; /* trajectory planner queue length */
+RTAPI_MP_INT(tc_queue_size, "number of segments in the trajectory planner queue");
+
+static int commands_per_period = DEFAULT_COMMANDS_PER_PERIOD;
+RTAPI_MP_INT(commands_per_period, "most commands from task handled each servo period");
+int motion_commands_per_period;
 /***********************************************************************
 *                  GLOBAL VARIABLE DEFINITIONS                         *
 ************************************************************************/
@@ -99,8 +112,10 @@ emcmot_joint_t joints[EMCMOT_MAX_JOINTS];
 
   emcmotStruct is ptr to this memory.
 
-  emcmotCommand points to emcmotStruct->command,
-  emcmotStatus points to emcmotStruct->status,
+  emcmotCommand points to the command being handled, in the
+  emcmotStruct->command ring,
+  emcmotStatus points to emcmotStruct->status, which is copied to
+  emcmotStruct->status_snapshot for userspace at the end of each period,
   emcmotError points to emcmotStruct->error, and
  */
 emcmot_struct_t *emcmotStruct = 0;
@@ -293,7 +308,7 @@ static int module_intfc() {
 }
 
 static int tp_init() {
-    if (-1 == tpCreate(&emcmotInternal->coord_tp, DEFAULT_TC_QUEUE_SIZE,mot_comp_id)) {
+    if (-1 == tpCreate(&emcmotInternal->coord_tp, tc_queue_size, mot_comp_id)) {
         rtapi_print_msg(RTAPI_MSG_ERR,
             "MOTION: tpCreate failed\n");
         return -1;
@@ -350,6 +365,21 @@ int rtapi_app_main(void)
     }
     motion_num_spindles = num_spindles;
 
+    if (tc_queue_size < MIN_TC_QUEUE_SIZE) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: tc_queue_size is %d, must be at least %d\n"), tc_queue_size, MIN_TC_QUEUE_SIZE);
+	hal_exit(mot_comp_id);
+	return -1;
+    }
+
+    if (( commands_per_period < 1 ) || ( commands_per_period > EMCMOT_COMMAND_NUM )) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    _("MOTION: commands_per_period is %d, must be between 1 and %d\n"), commands_per_period, EMCMOT_COMMAND_NUM);
+	hal_exit(mot_comp_id);
+	return -1;
+    }
+    motion_commands_per_period = commands_per_period;
+
     if (num_dio != NOT_INITIALIZED && (names_dout[0] || names_din[0])) {
       rtapi_print_msg(RTAPI_MSG_ERR, _("MOTION: Can't specify both names and number for digital pins\n"));
       return -1;
@@ -473,6 +503,10 @@ void rtapi_app_exit(void)
     }
     /* free the S-curve planner + Ruckig pool (threads are stopped, safe) */
     sp_scurve_cleanup();
+    /* free the trajectory planner queue */
+    if (emcmotInternal) {
+	tpDelete(&emcmotInternal->coord_tp);
+    }
     /* free shared memory */
     retval = rtapi_shmem_delete(emc_shmem_id, mot_comp_id);
     if (retval < 0) {
@@ -604,6 +638,9 @@ static int init_hal_io(void)
     CALL_CHECK(hal_pin_new_real(mot_comp_id, HAL_OUT, &(emcmot_hal_data->distance_to_go), 0.0, "motion.distance-to-go"));
     CALL_CHECK(hal_pin_new_si32(mot_comp_id, HAL_OUT, &(emcmot_hal_data->program_line), 0, "motion.program-line"));
     CALL_CHECK(hal_pin_new_bool(mot_comp_id, HAL_OUT, &(emcmot_hal_data->jog_is_active), 0, "motion.jog-is-active"));
+    CALL_CHECK(hal_pin_new_si32(mot_comp_id, HAL_OUT, &(emcmot_hal_data->tc_queue_size), tc_queue_size, "motion.tc-queue-size"));
+    CALL_CHECK(hal_pin_new_si32(mot_comp_id, HAL_OUT, &(emcmot_hal_data->tc_queue_fill), 0, "motion.tc-queue-fill"));
+    CALL_CHECK(hal_pin_new_si32(mot_comp_id, HAL_OUT, &(emcmot_hal_data->tc_queue_high_water), 0, "motion.tc-queue-high-water"));
 
     /* Standard Interp State Pins */
     CALL_CHECK(hal_pin_new_si32(mot_comp_id, HAL_OUT, &(emcmot_hal_data->interp_line_number), 0, "motion.interp.line-number"));
@@ -841,7 +878,6 @@ static int init_comm_buffers(void)
     }
 
     /* we'll reference emcmotStruct directly */
-    emcmotCommand = &emcmotStruct->command;
     emcmotStatus = &emcmotStruct->status;
     emcmotConfig = &emcmotStruct->config;
     emcmotInternal = &emcmotStruct->internal;
@@ -851,21 +887,17 @@ static int init_comm_buffers(void)
     emcmotErrorInit(emcmotError);
 
     /*
-     * DO NOT init the command struct!
+     * DO NOT init the command ring!
      * This is a reader process and the writer (f.ex. milltask) may already
-     * have written a command in there before we get attached to shared memory.
-     * We might (actually will) lose a command if we write to the command
-     * structure.
-     *
-     * emcmotCommand->command = 0;
-     * emcmotCommand->commandNum = 0;
+     * have put commands in there before we get attached to shared memory.
+     * We might (actually will) lose them if we reset the ring.
      */
 
     /* init status struct */
-    emcmotStatus->head = 0;
     emcmotStatus->commandEcho = 0;
     emcmotStatus->commandNumEcho = 0;
     emcmotStatus->commandStatus = 0;
+    emcmotStatus->commandNumFailed = 0;
 
     /* init more stuff */
     emcmotInternal->head = 0;
@@ -974,7 +1006,7 @@ static int init_comm_buffers(void)
 	cubicInit(&(joint->cubic));
     }
 
-    emcmotStatus->tail = 0;
+    emcmotStatusPublish(&emcmotStruct->status_snapshot, emcmotStatus);
 
     rtapi_print_msg(RTAPI_MSG_INFO, "MOTION: init_comm_buffers() complete\n");
     return 0;
@@ -987,7 +1019,7 @@ static int init_threads(void)
 {
     double base_period_sec, servo_period_sec;
     int servo_base_ratio;
-    int retval;
+    int retval, n;
 
     rtapi_print_msg(RTAPI_MSG_INFO, "MOTION: init_threads() starting...\n");
 
@@ -1014,7 +1046,8 @@ static int init_threads(void)
     /* create HAL threads for each period */
     /* only create base thread if it is faster than servo thread */
     if (servo_base_ratio > 1) {
-	retval = hal_create_thread("base-thread", base_period_nsec, base_thread_fp);
+	retval = hal_create_thread_cpu("base-thread", base_period_nsec,
+	    base_thread_fp, base_thread_cpu);
 	if (retval < 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
 		"MOTION: failed to create %ld nsec base thread\n",
@@ -1022,13 +1055,23 @@ static int init_threads(void)
 	    return -1;
 	}
     }
-    retval = hal_create_thread("servo-thread", servo_period_nsec, 1);
+    retval = hal_create_thread_cpu("servo-thread", servo_period_nsec, 1,
+	servo_thread_cpu);
     if (retval < 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "MOTION: failed to create %ld nsec servo thread\n",
 	    servo_period_nsec);
 	return -1;
     }
+    for (n = 0; n < HAL_THREAD_WORKERS && servo_thread_workers[n] >= 0; n++) {
+	retval = hal_thread_add_worker("servo-thread", servo_thread_workers[n]);
+	if (retval < 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"MOTION: failed to add servo thread worker on CPU %d\n",
+		servo_thread_workers[n]);
+	    return -1;
+	}
+    }
     /* export realtime functions that do the real work */
     retval = hal_export_funct("motion-controller", emcmotController, 0	/* arg
 	 */ , 1 /* uses_fp */ , 0 /* reentrant */ , mot_comp_id);
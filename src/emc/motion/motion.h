@@ -114,8 +114,7 @@ extern "C" {
 	EMCMOT_AF_ENABLE,	/* enable/disable adaptive feedrate */
 	EMCMOT_OVERRIDE_LIMITS,	/* temporarily ignore limits until jog done */
 
-	EMCMOT_SET_LINE,	/* queue up a linear move */
-	EMCMOT_SET_CIRCLE,	/* queue up a circular move */
+	EMCMOT_SET_SEGMENTS,	/* queue up linear and circular moves */
 	EMCMOT_CLEAR_PROBE_FLAGS,	/* clears probeTripped flag */
 	EMCMOT_PROBE,		/* go to pos, stop if probe trips, record
 				   trip pos */
@@ -199,8 +198,32 @@ extern "C" {
        COMMAND STRUCTURE
 *********************************/
 
-/* This is the command structure.  There is one of these in shared
-   memory, and all commands from higher level code come thru it.
+/* One move of an EMCMOT_SET_SEGMENTS command.  Its state tag is packed
+   in here but for the file name, which all the moves of a command share
+   and which is in the tag of the command.
+*/
+    typedef struct emcmot_segment_t {
+	EmcPose pos;		/* line/circle endpt */
+	PmCartesian center;	/* center for circle */
+	PmCartesian normal;	/* normal vec for circle */
+	double vel;		/* max velocity */
+	double ini_maxvel;	/* max velocity allowed by machine
+				   constraints (the INI file) */
+	double acc;		/* max acceleration */
+	double ini_maxjerk;
+	int id;			/* id for motion */
+	int motion_type;	/* traverse, feed, arc, or toolchange */
+	int turn;		/* turns for circle or joint number for a
+				   locking indexer */
+	int spindle;		/* spindle whose CSS the move is for */
+	unsigned char circle;	/* circular move, not linear */
+	double fields_float[GM_FIELD_FLOAT_MAX_FIELDS];
+	int fields[GM_FIELD_MAX_FIELDS];
+	unsigned long int packed_flags;
+    } emcmot_segment_t;
+
+/* This is the command structure.  A ring of these is in shared memory,
+   and all commands from higher level code come thru it.
 */
     typedef struct emcmot_command_t {
 	cmd_code_t command;	/* command code (enum) */
@@ -270,6 +293,8 @@ extern "C" {
     double ext_offset_vel;	/* velocity for an external axis offset */
     double ext_offset_acc;	/* acceleration for an external axis offset */
     struct state_tag_t tag;
+    int num_segments;		/* moves in segment */
+    emcmot_segment_t segment[EMCMOT_MAX_SEGMENTS];
     } emcmot_command_t;
 
 /*! \todo FIXME - these packed bits might be replaced with chars
@@ -575,11 +600,11 @@ Suggestion: Split this in to an Error and a Status flag register..
 */
 
     typedef struct emcmot_status_t {
-	unsigned char head;	/* flag count for mutex detect */
 	/* these three are updated only when a new command is handled */
 	cmd_code_t commandEcho;	/* echo of input command */
 	int commandNumEcho;	/* echo of input command number */
 	cmd_status_t commandStatus;	/* result of most recent command */
+	int commandNumFailed;	/* number of the latest command that failed */
 	/* these are config info, updated when a command changes them */
 	double feed_scale;	/* velocity scale factor for all motion but rapids */
 	double rapid_scale;	/* velocity scale factor for rapids */
@@ -633,6 +658,7 @@ Suggestion: Split this in to an Error and a Status flag register..
 	int depth;		/* motion queue depth */
 	int activeDepth;	/* depth of active blend elements */
 	int queueFull;		/* Flag to indicate the tc queue is full */
+	int queueSpace;		/* tcs that fit before the queue is full */
 	int paused;		/* Flag to signal motion paused */
 	int overrideLimitMask;	/* non-zero means one or more limits ignored */
 				/* 1 << (joint-num*2) = ignore neg limit */
@@ -661,7 +687,6 @@ Suggestion: Split this in to an Error and a Status flag register..
 	unsigned int tcqlen;
 	EmcPose tool_offset;
 	int atspeed_next_feed;  /* at next feed move, wait for spindle to be at speed  */
-	unsigned char tail;	/* flag count for mutex detect */
 	int external_offsets_applied;
 	EmcPose eoffset_pose;
 	int numExtraJoints;
@@ -748,6 +773,29 @@ Suggestion: Split this in to an Error and a Status flag register..
 	rtapi_atomic_ullong read_seq;
     } emcmot_error_t;
 
+/* command structure - lockfree SPSC ring buffer from task to motion.
+   See emcmotutil.c. */
+    typedef struct emcmot_command_ring_t {
+	emcmot_command_t command[EMCMOT_COMMAND_NUM];
+	rtapi_atomic_uint write_seq;	/* commands put in, by task */
+	rtapi_atomic_uint read_seq;	/* commands taken out, by motion */
+    } emcmot_command_ring_t;
+
+/* status snapshots - double buffered seqlock from motion to task.
+   See emcmotutil.c. */
+    typedef struct emcmot_status_snapshot_t {
+	emcmot_status_t status[2];
+	rtapi_atomic_uint seq[2];	/* odd while status[n] is being written */
+	rtapi_atomic_uint latest;	/* index of the last complete copy */
+    } emcmot_status_snapshot_t;
+
+/* parts of the status that can be read from a snapshot on their own */
+#define EMCMOT_STATUS_TRAJ	0x01	/* all but the arrays below */
+#define EMCMOT_STATUS_JOINTS	0x02	/* joint_status[] */
+#define EMCMOT_STATUS_AXES	0x04	/* axis_status[] */
+#define EMCMOT_STATUS_SPINDLES	0x08	/* spindleSync and spindle_status[] */
+#define EMCMOT_STATUS_ALL	0x0f
+
 
 typedef struct emcmot_internal_t {
     unsigned char head; /* flag count for mutex detect */
@@ -769,6 +817,18 @@ typedef struct emcmot_internal_t {
     extern int emcmotErrorPutf(emcmot_error_t * errlog, const char *fmt, ...);
     extern int emcmotErrorGet(emcmot_error_t * errlog, char *error);
 
+/* command ring access functions */
+    extern int emcmotCommandPut(emcmot_command_ring_t * ring,
+	const emcmot_command_t * c);
+    extern emcmot_command_t *emcmotCommandPeek(emcmot_command_ring_t * ring);
+    extern void emcmotCommandTake(emcmot_command_ring_t * ring);
+
+/* status snapshot access functions */
+    extern void emcmotStatusPublish(emcmot_status_snapshot_t * snap,
+	const emcmot_status_t * s);
+    extern int emcmotStatusGet(emcmot_status_snapshot_t * snap,
+	emcmot_status_t * s, int parts);
+
 #define GET_JOINT_ACTIVE_FLAG(joint) ((joint)->flag & EMCMOT_JOINT_ACTIVE_BIT ? 1 : 0)
 #define GET_JOINT_INPOS_FLAG(joint) ((joint)->flag & EMCMOT_JOINT_INPOS_BIT ? 1 : 0)
 
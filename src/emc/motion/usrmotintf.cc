@@ -40,8 +40,9 @@ using namespace linuxcnc;
 
 static int inited = 0;		/* flag if inited */
 
-static emcmot_command_t *emcmotCommand = NULL;
+static emcmot_command_ring_t *emcmotCommand = NULL;
 static emcmot_status_t *emcmotStatus = NULL;
+static emcmot_status_snapshot_t *emcmotStatusSnapshot = NULL;
 static emcmot_config_t *emcmotConfig = NULL;
 static emcmot_internal_t *emcmotInternal = NULL;
 static emcmot_error_t *emcmotError = NULL;
@@ -74,11 +75,27 @@ int usrmotIniLoad(const char *filename)
     return 0;
 }
 
-/* writes command from c */
-int usrmotWriteEmcmotCommand(emcmot_command_t * c)
+/*
+  Task is the only writer of the command ring.  Every command gets the
+  next number; motion echoes the number of each command it has handled
+  in its status, and the number of the latest one that failed.
+*/
+static int commandNum = 0;		/* number of the last command put in */
+static int commandNumFailedSeen = 0;	/* latest failure already reported */
+static int movesPut[EMCMOT_COMMAND_NUM];	/* moves in the latest commands
+					   put in, by number */
+
+/*
+  Moves are gathered into one EMCMOT_SET_SEGMENTS command, which goes
+  in the ring when it is full, before any other command, or when task
+  calls usrmotFlushEmcmotMoves() because it has nothing else to do.
+*/
+static emcmot_command_t segmentBatch;
+
+/* numbers c and puts it in the command ring, waiting for a free slot
+   if motion hasn't caught up yet */
+static int usrmotPutEmcmotCommand(emcmot_command_t * c)
 {
-    emcmot_status_t s;
-    static int commandNum = 0;
     double end;
 
     if (!MOTION_ID_VALID(c->id)) {
@@ -86,18 +103,88 @@ int usrmotWriteEmcmotCommand(emcmot_command_t * c)
 	return EMCMOT_COMM_INVALID_MOTION_ID;
     }
 
-    c->commandNum = ++commandNum;
-
     /* check for mapped mem still around */
     if (NULL == emcmotCommand) {
         rcs_print("USRMOT: ERROR: can't connect to shared memory\n");
 	return EMCMOT_COMM_ERROR_CONNECT;
     }
 
-    /* copy entire command structure to shared memory */
-    rtapi_mutex_get(&emcmotStruct->command_mutex);
-    *emcmotCommand = *c;
-    rtapi_mutex_give(&emcmotStruct->command_mutex);
+    c->commandNum = commandNum + 1;
+    end = etime() + EMCMOT_COMM_TIMEOUT;
+    while (emcmotCommandPut(emcmotCommand, c) != 0) {
+	if (etime() >= end) {
+	    rcs_print("USRMOT: ERROR: command %u timeout, command ring full (seq: %d)\n",
+		c->command, c->commandNum);
+	    return EMCMOT_COMM_ERROR_TIMEOUT;
+	}
+	esleep(25e-6);
+    }
+    commandNum = c->commandNum;
+    movesPut[(unsigned int)commandNum % EMCMOT_COMMAND_NUM] =
+	c->command == EMCMOT_SET_SEGMENTS ? c->num_segments : 0;
+
+    return EMCMOT_COMM_OK;
+}
+
+/* puts the moves gathered so far in the ring */
+int usrmotFlushEmcmotMoves(void)
+{
+    int retval;
+
+    if (segmentBatch.num_segments == 0) {
+	return EMCMOT_COMM_OK;
+    }
+    retval = usrmotPutEmcmotCommand(&segmentBatch);
+    segmentBatch.num_segments = 0;
+
+    return retval;
+}
+
+/* returns EMCMOT_COMM_ERROR_COMMAND, once, if motion has recorded in
+   failed a failure of a queued command that task hasn't heard of */
+static int usrmotCheckQueuedFailure(int failed)
+{
+    if (failed == commandNumFailedSeen) {
+	return EMCMOT_COMM_OK;
+    }
+    commandNumFailedSeen = failed;
+    /* the moves gathered since would be dropped by motion anyway */
+    segmentBatch.num_segments = 0;
+    rcs_print("USRMOT: ERROR: queued command (seq: %d) failed\n", failed);
+    return EMCMOT_COMM_ERROR_COMMAND;
+}
+
+/* writes command from c, and waits for motion to handle it */
+int usrmotWriteEmcmotCommand(emcmot_command_t * c)
+{
+    emcmot_status_t s;
+    double end;
+    int retval;
+
+    /* an abort is how task takes note of a failed queued command, and
+       what makes motion stop dropping the moves after it.  Any other
+       command must not run as if the program could carry on. */
+    if (c->command != EMCMOT_ABORT && NULL != emcmotStatus) {
+	retval = usrmotCheckQueuedFailure(emcmotStatus->commandNumFailed);
+	if (retval != EMCMOT_COMM_OK) {
+	    return retval;
+	}
+    }
+
+    /* moves queued before c come before it, unless c is an abort,
+       which throws them away */
+    if (c->command == EMCMOT_ABORT) {
+	segmentBatch.num_segments = 0;
+	retval = EMCMOT_COMM_OK;
+    } else {
+	retval = usrmotFlushEmcmotMoves();
+    }
+    if (retval == EMCMOT_COMM_OK) {
+	retval = usrmotPutEmcmotCommand(c);
+    }
+    if (retval != EMCMOT_COMM_OK) {
+	return retval;
+    }
 
     /* poll for receipt of command */
     /* set timeout for comm failure, now + timeout */
@@ -105,7 +192,14 @@ int usrmotWriteEmcmotCommand(emcmot_command_t * c)
     /* now check to see if it got it */
     while (etime() < end) {
 	/* update status */
-	if (( usrmotReadEmcmotStatus(&s) == 0 ) && ( s.commandNumEcho == commandNum )) {
+	if (( usrmotReadEmcmotStatusParts(&s, EMCMOT_STATUS_TRAJ) == 0 ) && ( s.commandNumEcho == commandNum )) {
+	    /* a command queued before this one may have failed while
+	       we waited; a failure of this one is in commandStatus */
+	    if (c->command == EMCMOT_ABORT || s.commandNumFailed == commandNum) {
+		commandNumFailedSeen = s.commandNumFailed;
+	    } else if (usrmotCheckQueuedFailure(s.commandNumFailed) != EMCMOT_COMM_OK) {
+		return EMCMOT_COMM_ERROR_COMMAND;
+	    }
 	    /* now check emcmot status flag */
 	    if (s.commandStatus == EMCMOT_COMMAND_OK) {
 		return EMCMOT_COMM_OK;
@@ -120,30 +214,93 @@ int usrmotWriteEmcmotCommand(emcmot_command_t * c)
     return EMCMOT_COMM_ERROR_TIMEOUT;
 }
 
+/* adds the move in seg, with the state in tag, to the moves going to
+   motion next, without waiting for motion */
+int usrmotQueueEmcmotMove(const emcmot_segment_t * seg,
+			  const struct state_tag_t * tag)
+{
+    emcmot_segment_t *next;
+    int retval;
+
+    if (NULL == emcmotStatus) {
+        rcs_print("USRMOT: ERROR: can't connect to shared memory\n");
+	return EMCMOT_COMM_ERROR_CONNECT;
+    }
+
+    /* a queued move that failed stops the ones after it */
+    retval = usrmotCheckQueuedFailure(emcmotStatus->commandNumFailed);
+    if (retval != EMCMOT_COMM_OK) {
+	return retval;
+    }
+
+    /* the moves of a command share the file name of their tags */
+    if (segmentBatch.num_segments > 0 &&
+	strcmp(segmentBatch.tag.filename, tag->filename) != 0) {
+	retval = usrmotFlushEmcmotMoves();
+	if (retval != EMCMOT_COMM_OK) {
+	    return retval;
+	}
+    }
+    if (segmentBatch.num_segments == 0) {
+	segmentBatch.command = EMCMOT_SET_SEGMENTS;
+	memcpy(segmentBatch.tag.filename, tag->filename,
+	       sizeof(segmentBatch.tag.filename));
+    }
+
+    next = &segmentBatch.segment[segmentBatch.num_segments];
+    *next = *seg;
+    memcpy(next->fields_float, tag->fields_float, sizeof(next->fields_float));
+    memcpy(next->fields, tag->fields, sizeof(next->fields));
+    next->packed_flags = tag->packed_flags;
+    segmentBatch.id = seg->id;
+    segmentBatch.num_segments++;
+
+    if (segmentBatch.num_segments == EMCMOT_MAX_SEGMENTS) {
+	return usrmotFlushEmcmotMoves();
+    }
+    return EMCMOT_COMM_OK;
+}
+
+/* number of moves queued that motion hadn't added to its queue when
+   it wrote s */
+int usrmotPendingEmcmotMoves(const emcmot_status_t * s)
+{
+    int behind = commandNum - s->commandNumEcho;
+    int moves = segmentBatch.num_segments;
+    int k;
+
+    if (behind > EMCMOT_COMMAND_NUM) {
+	behind = EMCMOT_COMMAND_NUM;
+    }
+    for (k = 0; k < behind; k++) {
+	moves += movesPut[(unsigned int)(commandNum - k) % EMCMOT_COMMAND_NUM];
+    }
+    return moves;
+}
+
+/* non-zero if motion recorded in s a failure task hasn't heard of */
+int usrmotQueuedMoveFailed(const emcmot_status_t * s)
+{
+    return s->commandNumFailed != commandNumFailedSeen;
+}
+
 /* copies status to s */
 int usrmotReadEmcmotStatus(emcmot_status_t * s)
 {
-    int split_read_count;
+    return usrmotReadEmcmotStatusParts(s, EMCMOT_STATUS_ALL);
+}
 
+/* copies the parts of status in the EMCMOT_STATUS_* mask parts to s,
+   all from the same servo period */
+int usrmotReadEmcmotStatusParts(emcmot_status_t * s, int parts)
+{
     /* check for shmem still around */
-    if (NULL == emcmotStatus) {
+    if (NULL == emcmotStatusSnapshot) {
 	return EMCMOT_COMM_ERROR_CONNECT;
     }
-    split_read_count = 0;
-    do {
-	if(split_read_count > 0) esleep(1e-6);	// Don't busy-loop and give time to process
-	/* copy status struct from shmem to local memory */
-	memcpy(s, emcmotStatus, sizeof(emcmot_status_t));
-	/* got it, now check head-tail matche */
-	if (s->head == s->tail) {
-	    /* head and tail match, done */
-	    return EMCMOT_COMM_OK;
-	}
-	/* inc counter and try again, max three times */
-    } while ( ++split_read_count < 3 );
-    /* A timeout is harmless. It will be tried again, soon enough */
-    /* rcs_print("%s: Split read timeout\n", __FUNCTION__); */
-    return EMCMOT_COMM_SPLIT_READ_TIMEOUT;
+    /* the snapshot is never torn, so there is no retry or timeout here */
+    emcmotStatusGet(emcmotStatusSnapshot, s, parts);
+    return EMCMOT_COMM_OK;
 }
 
 /* copies config to s */
@@ -593,10 +750,16 @@ int usrmotInit(const char *modname)
     /* got it */
     emcmotCommand = &(emcmotStruct->command);
     emcmotStatus = &(emcmotStruct->status);
+    emcmotStatusSnapshot = &(emcmotStruct->status_snapshot);
     emcmotInternal = &(emcmotStruct->internal);
     emcmotConfig = &(emcmotStruct->config);
     emcmotError = &(emcmotStruct->error);
 
+    /* carry on numbering from where motion is, in case we are a new
+       task talking to the same motion */
+    commandNum = emcmotStatus->commandNumEcho;
+    commandNumFailedSeen = emcmotStatus->commandNumFailed;
+
     inited = 1;
 
     return 0;
@@ -612,6 +775,7 @@ int usrmotExit(void)
     emcmotStruct = NULL;
     emcmotCommand = NULL;
     emcmotStatus = NULL;
+    emcmotStatusSnapshot = NULL;
     emcmotError = NULL;
 /*! \todo Another #if 0 */
 #if 0
@@ -17,6 +17,8 @@
 
 struct emcmot_status_t;
 struct emcmot_command_t;
+struct emcmot_segment_t;
+struct state_tag_t;
 struct emcmot_config_t;
 struct emcmot_internal_t;
 struct emcmot_error_t;
@@ -33,6 +35,11 @@ extern "C" {
    the emcmot controller and puts it in arg */
     extern int usrmotReadEmcmotStatus(emcmot_status_t * s);
 
+/* usrmotReadEmcmotStatusParts() gets only the parts of the status info
+   in the EMCMOT_STATUS_* mask parts, e.g. EMCMOT_STATUS_TRAJ, and leaves
+   the rest of arg as it was */
+    extern int usrmotReadEmcmotStatusParts(emcmot_status_t * s, int parts);
+
 /* usrmotReadEmcmotConfig() gets the config info out of
    the emcmot controller and puts it in arg */
     extern int usrmotReadEmcmotConfig(emcmot_config_t * s);
@@ -62,10 +69,37 @@ extern "C" {
 #define EMCMOT_COMM_SPLIT_READ_TIMEOUT -4	/* can't read without split */
 #define EMCMOT_COMM_INVALID_MOTION_ID -5 /* do not queue a motion id MOTION_INVALID_ID */
 
-/* usrmotWriteEmcmotCommand() writes the command to the emcmot process.
+/* usrmotWriteEmcmotCommand() writes the command to the emcmot process,
+   and waits for it to be handled.  If a command queued earlier has
+   failed and that hasn't been reported yet, it returns
+   EMCMOT_COMM_ERROR_COMMAND, unless the command is EMCMOT_ABORT, which
+   takes note of the failure.
    Return values are as per the #defines above */
     extern int usrmotWriteEmcmotCommand(emcmot_command_t * c);
 
+/* usrmotQueueEmcmotMove() adds a linear or circular move to the ones
+   going to the emcmot process next, in one EMCMOT_SET_SEGMENTS command,
+   and returns without waiting for it to be handled.  If a move queued
+   earlier has failed and that hasn't been reported yet, it returns
+   EMCMOT_COMM_ERROR_COMMAND instead. */
+    extern int usrmotQueueEmcmotMove(const emcmot_segment_t * seg,
+				     const struct state_tag_t * tag);
+
+/* usrmotFlushEmcmotMoves() puts the moves queued so far in the ring to
+   the emcmot process.  Writing any other command does this first,
+   except EMCMOT_ABORT, which throws them away. */
+    extern int usrmotFlushEmcmotMoves(void);
+
+/* usrmotPendingEmcmotMoves() returns how many moves had been queued
+   but not yet added to the motion queue when the emcmot process wrote
+   the status in s */
+    extern int usrmotPendingEmcmotMoves(const emcmot_status_t * s);
+
+/* usrmotQueuedMoveFailed() returns non-zero if the status in s records
+   a failed queued command that hasn't been reported yet.  It stays so
+   until an EMCMOT_ABORT is written. */
+    extern int usrmotQueuedMoveFailed(const emcmot_status_t * s);
+
 /* usrmotInit() initializes communication with the emcmot process */
     extern int usrmotInit(const char *name);
 
@@ -42,6 +42,18 @@
 #define EMCMOT_ERROR_NUM 32	/* how many errors we can queue */
 #define EMCMOT_ERROR_LEN 1024	/* how long error string can be */
 
+/* Commands from task to motion go through a ring of this many slots.
+   Task puts moves in without waiting for motion to take them, up to
+   EMCMOT_MAX_SEGMENTS of them in each command, which can hold more
+   moves than the margin tcq keeps for race conditions (see tcqFull()).
+   So task counts the moves in the ring and in the batch it is
+   gathering, twice for the blend arcs motion may add, against the
+   space motion reports before tcqFull().  Motion takes out at most
+   commands_per_period of them each servo period. */
+#define EMCMOT_COMMAND_NUM 16
+#define EMCMOT_MAX_SEGMENTS 8
+#define DEFAULT_COMMANDS_PER_PERIOD 2
+
 /*
   Shared memory keys for simulated motion process. No base address
   values need to be computed, since operating system does this for us
@@ -64,10 +76,12 @@
 #define DEFAULT_AIO 4
 #define DEFAULT_MISC_ERROR 0
 
-/* size of motion queue
- * a TC_STRUCT is about 512 bytes so this queue is
- * about a megabyte.  */
+/* size of motion queue, can be changed with the motmod tc_queue_size
+ * parameter. A TC_STRUCT is a bit less than 2 kilobytes so the default
+ * queue is about 3.5 megabytes. The queue must be larger than the margin
+ * tcq keeps for reverse run and race conditions. */
 #define DEFAULT_TC_QUEUE_SIZE 2000
+#define MIN_TC_QUEUE_SIZE 250
 
 /* max following error */
 #define DEFAULT_MAX_FERROR 100
@@ -15,6 +15,9 @@
  * Last change:
  ********************************************************************/
 
+#include <algorithm>
+#include <cstddef>
+
 #include "interpl.hh"   // these decls
 #include "emc.hh"
 #include "emcglb.h"
@@ -24,13 +27,99 @@
 NML_INTERP_LIST interp_list; /* NML Union, for interpreter */
 
 
+NML_INTERP_POOL::NML_INTERP_POOL(const char *name_, size_t size_) : name(name_)
+{
+    // every message in a slab must be aligned as the first one is
+    const size_t align = alignof(std::max_align_t);
+    size = (std::max(size_, sizeof(free_msg)) + align - 1) / align * align;
+}
+
+void *NML_INTERP_POOL::take()
+{
+    void *msg;
+
+    made++;
+    outstanding++;
+    if (free_list) {
+        reused++;
+        msg = free_list;
+        free_list = free_list->next;
+        return msg;
+    }
+    if (slab_used == SLAB_MESSAGES) {
+        slabs.emplace_back(new char[size * SLAB_MESSAGES]);
+        slab_used = 0;
+    }
+    return slabs.back().get() + size * slab_used++;
+}
+
+void NML_INTERP_POOL::put(void *msg)
+{
+    free_msg *f = static_cast<free_msg *>(msg);
+
+    f->next = free_list;
+    free_list = f;
+    if (--outstanding == 0 && detached) {
+        delete this;
+    }
+}
+
+// the list is going; go with it, or with the last message still held
+void NML_INTERP_POOL::detach()
+{
+    detached = true;
+    if (outstanding == 0) {
+        delete this;
+    }
+}
+
+void NML_INTERP_POOL::print()
+{
+    // one trip to the heap for each slab instead of for each message
+    unsigned long avoided = made - slabs.size();
+
+    rcs_print("NML_INTERP_POOL(%s): made=%lu, reused=%lu, slabs=%zu, "
+              "heap allocations avoided=%lu\n",
+              name, made, reused, slabs.size(), avoided);
+}
+
+void NML_INTERP_DELETER::operator()(NMLmsg *msg) const
+{
+    if (pool) {
+        pool->put(msg);
+    } else {
+        delete msg;
+    }
+}
+
+
+NML_INTERP_LIST::~NML_INTERP_LIST()
+{
+    // messages still on the list go back before their pools are let go
+    linked_list.clear();
+    for (auto p : pools) {
+        if (p) {
+            p->detach();
+        }
+    }
+}
+
+NML_INTERP_POOL *NML_INTERP_LIST::pool(int id, const char *name, size_t size)
+{
+    if (!pools[id]) {
+        pools[id] = new NML_INTERP_POOL(name, size);
+    }
+    return pools[id];
+}
+
+
 // sets the line number used for subsequent appends
 void NML_INTERP_LIST::set_line_number(int line)
 {
     next_line_number = line;
 }
 
-int NML_INTERP_LIST::append(std::unique_ptr<NMLmsg>&& nml_msg_ptr)
+int NML_INTERP_LIST::append(NML_INTERP_PTR<NMLmsg>&& nml_msg_ptr)
 {
     /* check for invalid data */
     if (NULL == nml_msg_ptr) {
@@ -66,7 +155,7 @@ int NML_INTERP_LIST::append(std::unique_ptr<NMLmsg>&& nml_msg_ptr)
     return 0;
 }
 
-std::unique_ptr<NMLmsg> NML_INTERP_LIST::get()
+NML_INTERP_PTR<NMLmsg> NML_INTERP_LIST::get()
 {
     if (linked_list.empty()) {
         line_number = 0;
@@ -95,6 +184,7 @@ void NML_INTERP_LIST::clear()
 {
     if (emc_debug & EMC_DEBUG_INTERP_LIST) {
         rcs_print("NML_INTERP_LIST(%p)::clear(): discarding %lu items\n", this, linked_list.size());
+        print_pools();
     }
     linked_list.clear();
 }
@@ -106,9 +196,19 @@ void NML_INTERP_LIST::print()
         auto& msg = *(i.command);
         rcs_print("--> type=%s,  line_number=%d\n", emc_symbol_lookup(msg._type), i.line_number);
     }
+    print_pools();
     rcs_print("\n");
 }
 
+void NML_INTERP_LIST::print_pools()
+{
+    for (auto p : pools) {
+        if (p) {
+            p->print();
+        }
+    }
+}
+
 int NML_INTERP_LIST::len()
 {
     return ((int)linked_list.size());
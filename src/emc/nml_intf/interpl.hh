@@ -19,36 +19,139 @@
 
 #include <deque>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 class NMLmsg;
+class EMC_TRAJ_LINEAR_MOVE;
+class EMC_TRAJ_CIRCULAR_MOVE;
+
+/*
+  A program turns into a long run of a few kinds of message, mostly
+  moves, each made by canon, queued here, taken off by task and freed.
+  So that this does not cost a trip to the heap each time, the list
+  keeps a pool for each of those kinds: messages are cut from slabs,
+  and go back on the pool's free list when whoever took them off the
+  list with get() lets go of them.  NML messages hold no resources of
+  their own, so nothing needs destroying on the way back.
+*/
+class NML_INTERP_POOL
+{
+public:
+    NML_INTERP_POOL(const char *name, size_t size);
+    void *take();
+    void put(void *msg);
+    void detach();
+    void print();
+
+    unsigned long made = 0;     // messages handed out
+    unsigned long reused = 0;   // of those, taken from the free list
+
+private:
+    enum { SLAB_MESSAGES = 64 };
+    struct free_msg { free_msg *next; };
+    const char *name;
+    size_t size;
+    std::vector<std::unique_ptr<char[]>> slabs;
+    size_t slab_used = SLAB_MESSAGES;  // messages cut from the last slab
+    free_msg *free_list = nullptr;
+    long outstanding = 0;       // handed out and not yet put back
+    bool detached = false;      // the list has gone
+};
+
+enum NML_INTERP_POOL_ID {
+    NML_INTERP_NO_POOL = -1,
+    NML_INTERP_POOL_LINEAR_MOVE,
+    NML_INTERP_POOL_CIRCULAR_MOVE,
+    NML_INTERP_POOL_NUM
+};
+
+// the message classes that are common enough to be pooled
+template <class T> struct NML_INTERP_POOL_OF {
+    static const int id = NML_INTERP_NO_POOL;
+    static const char *name() { return ""; }
+};
+template <> struct NML_INTERP_POOL_OF<EMC_TRAJ_LINEAR_MOVE> {
+    static const int id = NML_INTERP_POOL_LINEAR_MOVE;
+    static const char *name() { return "EMC_TRAJ_LINEAR_MOVE"; }
+};
+template <> struct NML_INTERP_POOL_OF<EMC_TRAJ_CIRCULAR_MOVE> {
+    static const int id = NML_INTERP_POOL_CIRCULAR_MOVE;
+    static const char *name() { return "EMC_TRAJ_CIRCULAR_MOVE"; }
+};
+
+// gives a message back to its pool, or to the heap if it came from there
+struct NML_INTERP_DELETER
+{
+    NML_INTERP_POOL *pool = nullptr;
+
+    NML_INTERP_DELETER() = default;
+    explicit NML_INTERP_DELETER(NML_INTERP_POOL *p) : pool(p) {}
+    // so that messages from std::make_unique can go on the list too
+    template <class T>
+    NML_INTERP_DELETER(const std::default_delete<T> &) {}
+
+    void operator()(NMLmsg *msg) const;
+};
+
+template <class T>
+using NML_INTERP_PTR = std::unique_ptr<T, NML_INTERP_DELETER>;
 
 // these go on the interp list
 struct NML_INTERP_LIST_NODE
 {
     int line_number;  // line number it was on
     // std::vector<char> command;
-    std::unique_ptr<NMLmsg> command;
+    NML_INTERP_PTR<NMLmsg> command;
 };
 
 // here's the interp list itself
 class NML_INTERP_LIST
 {
 public:
+    NML_INTERP_LIST() = default;
+    NML_INTERP_LIST(const NML_INTERP_LIST &) = delete;
+    NML_INTERP_LIST &operator=(const NML_INTERP_LIST &) = delete;
+    ~NML_INTERP_LIST();
+
+    // a new message to go on this list, from its pool if T has one
+    template <class T> NML_INTERP_PTR<T> make();
+
     void set_line_number(int line);
     int get_line_number();
-    int append(std::unique_ptr<NMLmsg>&& command);
-    std::unique_ptr<NMLmsg> get();
+    int append(NML_INTERP_PTR<NMLmsg>&& command);
+    NML_INTERP_PTR<NMLmsg> get();
     void clear();
     void print();
+    void print_pools();
     int len();
 
 private:
+    NML_INTERP_POOL *pool(int id, const char *name, size_t size);
+
     std::deque<NML_INTERP_LIST_NODE> linked_list;
+    // made when first used; a pool outlives the list while any of its
+    // messages are still held, as emcTaskCommand may be at exit
+    NML_INTERP_POOL *pools[NML_INTERP_POOL_NUM] = {};
     int next_line_number = 0;  // line number used to fill temp_node
     int line_number = 0;       // line number of node from get()
                                // NML_INTERP_LIST_NODE node; // pointer returned by get
 };
 
+template <class T>
+NML_INTERP_PTR<T> NML_INTERP_LIST::make()
+{
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "pooled messages are not destroyed before reuse");
+    const int id = NML_INTERP_POOL_OF<T>::id;
+    if (id == NML_INTERP_NO_POOL) {
+        return NML_INTERP_PTR<T>(new T());
+    }
+    NML_INTERP_POOL *p = pool(id, NML_INTERP_POOL_OF<T>::name(), sizeof(T));
+    return NML_INTERP_PTR<T>(new (p->take()) T(), NML_INTERP_DELETER(p));
+}
+
 extern NML_INTERP_LIST interp_list; /* NML Union, for interpreter */
 
 #endif
@@ -0,0 +1,163 @@
+/********************************************************************
+* Description: interp_blockcache.cc
+*   Cache of blocks read from NC files, keyed by file and offset.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <string.h>
+
+#include "interp_blockcache.hh"
+
+BlockCache::file_blocks *BlockCache::lookup(const InterpFile *f)
+{
+    const InterpFile::stamp &id = f->id();
+    if (max_entries == 0 || id.ino == 0)
+        return NULL;
+    file_blocks &fb = files[std::make_pair(id.dev, id.ino)];
+    if (fb.stamp != id) {
+        // new, or edited since its lines were cached
+        entries -= fb.blocks.size();
+        fb.blocks.clear();
+        fb.stamp = id;
+        fb.high_water = 0;
+    }
+    return &fb;
+}
+
+block_cache_entry *BlockCache::find(const InterpFile *f, long offset)
+{
+    file_blocks *fb = lookup(f);
+    if (fb) {
+        auto it = fb->blocks.find(offset);
+        if (it != fb->blocks.end()) {
+            hits++;
+            return &it->second;
+        }
+    }
+    misses++;
+    return NULL;
+}
+
+block_cache_entry *BlockCache::insert(const InterpFile *f, long offset,
+                                      long next, const char *raw,
+                                      const char *text)
+{
+    file_blocks *fb = lookup(f);
+    if (!fb)
+        return NULL;
+    if (next > fb->high_water) {
+        fb->high_water = next;
+        return NULL;
+    }
+    if (entries >= max_entries) {
+        // Rather than track use, start over; the lines of whatever loop
+        // is running now are back after one more pass.
+        long high_water = fb->high_water;
+        clear();
+        fb = lookup(f);
+        fb->high_water = high_water;
+    }
+    block_cache_entry &e = fb->blocks[offset];
+    e.next = next;
+    e.raw = raw;
+    e.text = text;
+    e.words.reset();
+    e.values.clear();
+    e.diameter_mode = false;
+    entries++;
+    return &e;
+}
+
+void BlockCache::set_words(block_cache_entry *e, const block_struct *block,
+                           bool diameter_mode)
+{
+    // Parameter references and assignments are read and evaluated in
+    // the same pass, O-words and M98/M99 depend on the call state, and a
+    // ';py,' comment runs Python while it is read.
+    if (strchr(e->text.c_str(), '#') || e->text[0] == ';')
+        return;
+    if (block->o_type != O_none)
+        return;
+    for (int n = 0; n < 11; n++) {
+        if (block->m_modes[n] == 98 || block->m_modes[n] == 99)
+            return;
+    }
+    e->words.reset(new block_struct(*block));
+    e->diameter_mode = diameter_mode;
+}
+
+void BlockCache::copy_words(block_pointer block, const block_struct *words)
+{
+    // the fields read_items() sets for a line without an O-word
+    memcpy(block->comment, words->comment, sizeof(block->comment));
+    block->a_flag = words->a_flag;
+    block->a_number = words->a_number;
+    block->b_flag = words->b_flag;
+    block->b_number = words->b_number;
+    block->c_flag = words->c_flag;
+    block->c_number = words->c_number;
+    block->d_flag = words->d_flag;
+    block->d_number_float = words->d_number_float;
+    block->dollar_flag = words->dollar_flag;
+    block->dollar_number = words->dollar_number;
+    block->e_flag = words->e_flag;
+    block->e_number = words->e_number;
+    block->f_flag = words->f_flag;
+    block->f_number = words->f_number;
+    memcpy(block->g_modes, words->g_modes, sizeof(block->g_modes));
+    block->h_flag = words->h_flag;
+    block->h_number = words->h_number;
+    block->i_flag = words->i_flag;
+    block->i_number = words->i_number;
+    block->j_flag = words->j_flag;
+    block->j_number = words->j_number;
+    block->k_flag = words->k_flag;
+    block->k_number = words->k_number;
+    block->l_flag = words->l_flag;
+    block->l_number = words->l_number;
+    block->m_count = words->m_count;
+    memcpy(block->m_modes, words->m_modes, sizeof(block->m_modes));
+    block->user_m = words->user_m;
+    block->n_number = words->n_number;
+    block->p_flag = words->p_flag;
+    block->p_number = words->p_number;
+    block->q_flag = words->q_flag;
+    block->q_number = words->q_number;
+    block->r_flag = words->r_flag;
+    block->r_number = words->r_number;
+    block->radius_flag = words->radius_flag;
+    block->radius = words->radius;
+    block->s_flag = words->s_flag;
+    block->s_number = words->s_number;
+    block->t_flag = words->t_flag;
+    block->t_number = words->t_number;
+    block->theta_flag = words->theta_flag;
+    block->theta = words->theta;
+    block->u_flag = words->u_flag;
+    block->u_number = words->u_number;
+    block->v_flag = words->v_flag;
+    block->v_number = words->v_number;
+    block->w_flag = words->w_flag;
+    block->w_number = words->w_number;
+    block->x_flag = words->x_flag;
+    block->x_number = words->x_number;
+    block->y_flag = words->y_flag;
+    block->y_number = words->y_number;
+    block->z_flag = words->z_flag;
+    block->z_number = words->z_number;
+}
+
+void BlockCache::rewind()
+{
+    for (auto &f : files)
+        f.second.high_water = 0;
+}
+
+void BlockCache::clear()
+{
+    files.clear();
+    entries = 0;
+}
@@ -0,0 +1,95 @@
+/********************************************************************
+* Description: interp_blockcache.hh
+*   Cache of blocks read from NC files, keyed by file and offset.
+*
+*   O-word loops and subroutines seek back and read the same lines
+*   again on every iteration or call.  The cache keeps what reading a
+*   line produced the first time it was read again: the raw and
+*   normalized text, and for lines whose words don't depend on
+*   parameters, the block as read_items() filled it in.
+*   For the others, the values on the line are kept compiled; see
+*   interp_expr.hh.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#ifndef INTERP_BLOCKCACHE_HH
+#define INTERP_BLOCKCACHE_HH
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "interp_internal.hh"
+#include "interp_file.hh"
+#include "interp_expr.hh"
+
+#define BLOCK_CACHE_SIZE_DEFAULT 4096
+
+struct block_cache_entry {
+    long next;                  // offset of the line after this one
+    std::string raw;            // linetext
+    std::string text;           // blocktext, after close_and_downcase()
+    // the words read_items() read from text, or NULL if the line refers
+    // to parameters or changes interpreter state while being read and so
+    // has to be read again every time
+    std::unique_ptr<block_struct> words;
+    bool diameter_mode;         // lathe_diameter_mode an X word was read in
+    // values read from text, compiled, by where they start and whether
+    // read as a value or a bracketed expression; NULL for one that
+    // can't be compiled
+    std::unordered_map<int, std::unique_ptr<expression>> values;
+};
+
+class BlockCache {
+public:
+    BlockCache() = default;
+    BlockCache(const BlockCache &) = delete;
+    BlockCache &operator=(const BlockCache &) = delete;
+
+    // The cached line starting at offset in f, or NULL.  Counts a hit or
+    // a miss; entries of a file that changed since they were made are
+    // dropped here.
+    block_cache_entry *find(const InterpFile *f, long offset);
+
+    // Called for each line read from f on a miss.  A line is only kept
+    // once it is read a second time, so that a program that runs
+    // straight through doesn't fill the cache.  Returns the new entry
+    // or NULL.
+    block_cache_entry *insert(const InterpFile *f, long offset, long next,
+                              const char *raw, const char *text);
+
+    // Keep the words read from an entry's text if they can be reused.
+    void set_words(block_cache_entry *e, const block_struct *block,
+                   bool diameter_mode);
+
+    // Fill in block, fresh from init_block(), from an entry's words.
+    static void copy_words(block_pointer block, const block_struct *words);
+
+    // Forget which lines were read; entries are kept.  Called when a
+    // program is opened.
+    void rewind();
+    void clear();
+
+    size_t max_entries = BLOCK_CACHE_SIZE_DEFAULT;  // 0 disables the cache
+    unsigned long hits = 0;     // lines whose text came from the cache
+    unsigned long misses = 0;   // lines read from the file
+    unsigned long parsed = 0;   // hits whose words were reused as well
+
+private:
+    struct file_blocks {
+        InterpFile::stamp stamp;
+        long high_water;        // end of the furthest line read
+        std::unordered_map<long, block_cache_entry> blocks;
+    };
+    file_blocks *lookup(const InterpFile *f);
+
+    std::map<std::pair<dev_t, ino_t>, file_blocks> files;
+    size_t entries = 0;
+};
+
+#endif // INTERP_BLOCKCACHE_HH
@@ -34,6 +34,7 @@
 #include "rs274ngc_interp.hh"
 #include "interp_internal.hh"
 #include "interp_queue.hh"
+#include "interp_file.hh"
 #include "interp_parameter_def.hh"
 #include <rtapi_string.h>
 
@@ -5223,7 +5224,7 @@ int Interp::convert_stop(block_pointer block,    //!< pointer to a block of RS27
     // Fanuc-style M99 main program endless loop
     // Only loops when running from a file; in MDI there is no file to
     // seek back to, so M99 falls through to the M2/M30 program-end path
-    // below (avoids a fseek(NULL) segfault).
+    // below (avoids seeking in a file that is not open).
     logDebug("M99 main program endless loop");
 
     loop_to_beginning(settings);  // return control to beginning of file
@@ -5362,13 +5363,13 @@ int Interp::convert_stop(block_pointer block,    //!< pointer to a block of RS27
     if (_setup.percent_flag && _setup.file_pointer) {
       line = _setup.linetext;
       for (;;) {                /* check for ending percent sign and comment if missing */
-        if (fgets(line, LINELEN, _setup.file_pointer) == NULL) {
+        if (_setup.file_pointer->read_line(line, LINELEN) == NULL) {
           enqueue_COMMENT("interpreter: percent sign missing from end of file");
           break;
         }
         length = strlen(line);
         if (length == (LINELEN - 1)) {       // line is too long. need to finish reading the line
-          for (; fgetc(_setup.file_pointer) != '\n' && !feof(_setup.file_pointer););
+          _setup.file_pointer->skip_line();
           continue;
         }
         for (index = (length - 1);      // index set on last char
@@ -0,0 +1,586 @@
+/********************************************************************
+* Description: interp_expr.cc
+*   Values read from a line, compiled for a small stack machine.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <math.h>
+#include <memory>
+
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "rs274ngc_interp.hh"
+#include "interp_blockcache.hh"
+
+using namespace interp_param_global;
+
+#define MAX_STACK 7             // as in read_real_expression
+
+static expr_op make_op(int code, int arg = 0, double number = 0.0,
+                       const char *name = NULL)
+{
+    expr_op op;
+    op.code = code;
+    op.check = false;
+    op.arg = arg;
+    op.number = number;
+    op.name = name;
+    return op;
+}
+
+static bool is_number(const expr_code &code, size_t start)
+{
+    return code.size() == start + 1 && code[start].code == EXPR_NUMBER &&
+        std::isfinite(code[start].number);
+}
+
+// The integer read_integer_value() makes of value, if it is close
+// enough to one.
+static bool integer_value(double value, int *index)
+{
+    *index = (int) floor(value);
+    if ((value - *index) > 0.9999)
+        *index = (int) ceil(value);
+    else if ((value - *index) > 0.0001)
+        return false;
+    return true;
+}
+
+// Whether an operation on constants can be done while compiling,
+// i.e. can't fail.  A result that isn't finite is checked for after.
+static bool can_fold_binary(double left, int operation, double right)
+{
+    switch (operation) {
+    case DIVIDED_BY:
+        return right != 0.0;
+    case POWER:
+        return !(left < 0.0 && floor(right) != right);
+    default:
+        return true;
+    }
+}
+
+static bool can_fold_unary(double value, int operation)
+{
+    switch (operation) {
+    case ACOS:
+    case ASIN:
+        return value >= -1.0 && value <= 1.0;
+    case LN:
+        return value > 0.0;
+    case SQRT:
+        return value >= 0.0;
+    default:
+        return true;
+    }
+}
+
+// How deep the stack of code gets when it runs.
+static int expression_depth(const expr_code &code)
+{
+    int depth = 0, max_depth = 0;
+    for (const expr_op &op : code) {
+        switch (op.code) {
+        case EXPR_NUMBER:
+        case EXPR_PARAM:
+        case EXPR_NAMED:
+        case EXPR_EXISTS_NAMED:
+            depth++;
+            break;
+        case EXPR_ATAN:
+        case EXPR_BINARY:
+            depth--;
+            break;
+        }
+        if (depth > max_depth)
+            max_depth = depth;
+    }
+    return max_depth;
+}
+
+/****************************************************************************/
+
+/*! read_compiled_value
+
+Returned Value: int
+   If reading or running the compiled value returns an error code, this
+   returns that code.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   As read_real_value, or read_real_expression if bracketed is true.
+   The first time a value is read from a cached line, its program is
+   stored in the line's block cache entry.
+
+Called by:
+   read_real_value
+   read_real_expression
+
+The first time, the value is read as it would be without the cache,
+and only if that worked is it compiled, so the compiler doesn't have to
+handle errors in the text.  The values within it are read the ordinary
+way, _setup.cached_block being NULL meanwhile.
+
+*/
+
+int Interp::read_compiled_value(char *line,       //!< string: line of RS274/NGC code being processed
+                                int *counter,     //!< pointer to a counter for position on the line
+                                double *double_ptr,       //!< pointer to double to be read
+                                double *parameters,       //!< array of system parameters
+                                bool bracketed)   //!< read as read_real_expression
+{
+  block_cache_entry *cached = _setup.cached_block;
+  int key = *counter * 2 + bracketed;
+  int end = *counter;
+  int status;
+
+  auto it = cached->values.find(key);
+  if (it != cached->values.end() && it->second) {
+    CHP(execute_expression(it->second.get(), double_ptr, parameters));
+    *counter = it->second->end;
+    return INTERP_OK;
+  }
+
+  _setup.cached_block = NULL;
+  if (bracketed)
+    status = read_real_expression(line, counter, double_ptr, parameters);
+  else
+    status = read_real_value(line, counter, double_ptr, parameters);
+  _setup.cached_block = cached;
+  CHP(status);
+  if (it != cached->values.end())
+    return INTERP_OK;           // known not to compile
+
+  std::unique_ptr<expression> e(new expression);
+  if (bracketed)
+    status = compile_real_expression(line, &end, e->code);
+  else
+    status = compile_real_value(line, &end, e->code);
+  if (status != INTERP_OK || end != *counter ||
+      e->code.size() > EXPRESSION_MAX_CODE ||
+      expression_depth(e->code) > EXPRESSION_MAX_DEPTH)
+    e.reset();
+  else
+    e->end = end;
+  cached->values[key] = std::move(e);
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! execute_expression
+
+Returned Value: int
+   If any of the operations of the program returns an error code, this
+   returns that code; these are the errors reading the value from the
+   text would return.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The value computed is put into what value points at.
+
+Called by: read_compiled_value
+
+*/
+
+int Interp::execute_expression(const expression *e,      //!< compiled value to compute
+                               double *value,     //!< pointer to double to be computed
+                               double *parameters)        //!< array of system parameters
+{
+  double stack[EXPRESSION_MAX_DEPTH];
+  int top = -1;
+  int index;
+  int exists;
+  double ignored;
+
+  for (const expr_op &op : e->code) {
+    switch (op.code) {
+    case EXPR_NUMBER:
+      stack[++top] = op.number;
+      break;
+    case EXPR_PARAM:
+      CHKS(((op.arg >= 5420) && (op.arg <= 5428) && (_setup.cutter_comp_side != CUTTER_COMP::OFF)),
+           _("Cannot read current position with cutter radius compensation on"));
+      stack[++top] = parameters[op.arg];
+      break;
+    case EXPR_PARAM_AT:
+      CHKS(!integer_value(stack[top], &index), NCE_NON_INTEGER_VALUE_FOR_INTEGER);
+      CHKS(((index < 1) || (index >= RS274NGC_MAX_PARAMETERS)),
+          NCE_PARAMETER_NUMBER_OUT_OF_RANGE);
+      CHKS(((index >= 5420) && (index <= 5428) && (_setup.cutter_comp_side != CUTTER_COMP::OFF)),
+           _("Cannot read current position with cutter radius compensation on"));
+      stack[top] = parameters[index];
+      break;
+    case EXPR_EXISTS_AT:
+      CHKS(!integer_value(stack[top], &index), NCE_NON_INTEGER_VALUE_FOR_INTEGER);
+      stack[top] = index >= 1 && index < RS274NGC_MAX_PARAMETERS;
+      break;
+    case EXPR_NAMED:
+      CHP(find_named_param(op.name, &exists, &stack[++top]));
+      if (!exists) {
+        // as in read_named_parameter
+        if (!_setup.defining_sub) {
+          logNP("execute_expression: referencing undefined named parameter '%s' level=%d",
+                op.name, (op.name[0] == '_') ? 0 : _setup.call_level);
+          ERS(_("Named parameter #<%s> not defined"), op.name);
+        }
+        stack[top] = 0.0;
+      }
+      break;
+    case EXPR_EXISTS_NAMED:
+      CHP(find_named_param(op.name, &exists, &ignored));
+      stack[++top] = exists ? 1.0 : 0.0;
+      break;
+    case EXPR_NEGATE:
+      stack[top] = -stack[top];
+      break;
+    case EXPR_UNARY:
+      CHP(execute_unary(&stack[top], op.arg));
+      break;
+    case EXPR_ATAN:
+      top--;
+      stack[top] = atan2(stack[top], stack[top + 1]);  /* value in radians */
+      stack[top] = ((stack[top] * 180.0) / M_PIl);     /* convert to degrees */
+      break;
+    case EXPR_BINARY:
+      top--;
+      CHP(execute_binary(&stack[top], op.arg, &stack[top + 1]));
+      break;
+    default:
+      ERS(NCE_BUG_UNKNOWN_OPERATION);
+    }
+    if (op.check) {
+      CHKS(std::isnan(stack[top]),
+              _("Calculation resulted in 'not a number'"));
+      CHKS(std::isinf(stack[top]),
+              _("Calculation resulted in 'infinity'"));
+    }
+  }
+  *value = stack[0];
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! compile_real_value
+
+Returned Value: int
+   If a function reading part of the value returns an error code, this
+   returns that code.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The program computing the value starting at counter is appended to
+   code.  The counter is reset to point to the first character after
+   the value.
+
+Called by:
+   read_compiled_value
+   compile_real_expression
+   compile_parameter
+
+The compile_ functions follow the read_ functions of the same names,
+appending to code what those would do rather than doing it.  Where
+the parts of a value are constants and the operation on them can't
+fail, the operation is done here.  The last operation of a value is
+marked for the check read_real_value makes of it.
+
+*/
+
+int Interp::compile_real_value(char *line,       //!< string: line of RS274/NGC code being processed
+                               int *counter,     //!< pointer to a counter for position on the line
+                               expr_code &code)  //!< program to append to
+{
+  char c, c1;
+  size_t start = code.size();
+  double number;
+
+  c = line[*counter];
+  CHKS((c == 0), NCE_NO_CHARACTERS_FOUND_IN_READING_REAL_VALUE);
+
+  c1 = line[*counter+1];
+
+  if (c == '[')
+    CHP(compile_real_expression(line, counter, code));
+  else if (c == '#')
+    CHP(compile_parameter(line, counter, code, false));
+  else if (c == '+' && c1 && !isdigit(c1) && c1 != '.')
+  {
+    (*counter)++;
+    CHP(compile_real_value(line, counter, code));
+  }
+  else if (c == '-' && c1 && !isdigit(c1) && c1 != '.')
+  {
+    (*counter)++;
+    CHP(compile_real_value(line, counter, code));
+    if (is_number(code, start))
+      code[start].number = -code[start].number;
+    else
+      code.push_back(make_op(EXPR_NEGATE));
+  }
+  else if ((c >= 'a') && (c <= 'z'))
+    CHP(compile_unary(line, counter, code));
+  else
+  {
+    CHP(read_real_number(line, counter, &number));
+    code.push_back(make_op(EXPR_NUMBER, 0, number));
+  }
+
+  code.back().check = !is_number(code, start);
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! compile_real_expression
+
+Returned Value: int
+   If a function reading part of the expression returns an error code,
+   this returns that code.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The program computing the expression starting at counter is
+   appended to code.  The counter is reset to point to the first
+   character after the expression.
+
+Called by:
+   read_compiled_value
+   compile_real_value
+   compile_unary
+
+This is read_real_expression with a program in place of each value on
+the stack; reducing two of them appends the right one and the
+operation to the left one, which leaves the operations in the order
+read_real_expression does them.
+
+*/
+
+int Interp::compile_real_expression(char *line,  //!< string: line of RS274/NGC code being processed
+                                    int *counter,        //!< pointer to a counter for position on the line
+                                    expr_code &code)     //!< program to append to
+{
+  expr_code values[MAX_STACK];
+  int operators[MAX_STACK];
+  int stack_index;
+
+  CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  *counter = (*counter + 1);
+  CHP(compile_real_value(line, counter, values[0]));
+  CHP(read_operation(line, counter, operators));
+  stack_index = 1;
+  for (; operators[0] != RIGHT_BRACKET;) {
+    values[stack_index].clear();
+    CHP(compile_real_value(line, counter, values[stack_index]));
+    CHP(read_operation(line, counter, operators + stack_index));
+    if (precedence(operators[stack_index]) >
+        precedence(operators[stack_index - 1]))
+      stack_index++;
+    else {                      /* precedence of latest operator is <= previous precedence */
+
+      for (; precedence(operators[stack_index]) <=
+           precedence(operators[stack_index - 1]);) {
+        CHP(compile_binary(values[stack_index - 1],
+                           operators[stack_index - 1],
+                           values[stack_index]));
+        operators[stack_index - 1] = operators[stack_index];
+        if ((stack_index > 1) &&
+            (precedence(operators[stack_index - 1]) <=
+             precedence(operators[stack_index - 2])))
+          stack_index--;
+        else
+          break;
+      }
+    }
+  }
+  code.insert(code.end(), values[0].begin(), values[0].end());
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! compile_binary
+
+Returned Value: int
+   INTERP_OK
+
+Side effects:
+   left is made the program computing the operation on the values left
+   and right compute.
+
+Called by: compile_real_expression
+
+*/
+
+int Interp::compile_binary(expr_code &left,        //!< program for the left operand
+                           int operation,          //!< integer code for the operation
+                           const expr_code &right) //!< program for the right operand
+{
+  if (is_number(left, 0) && is_number(right, 0) &&
+      can_fold_binary(left[0].number, operation, right[0].number)) {
+    double value = left[0].number;
+    double operand = right[0].number;
+    if (execute_binary(&value, operation, &operand) == INTERP_OK &&
+        std::isfinite(value)) {
+      left[0].number = value;
+      left[0].check = false;
+      return INTERP_OK;
+    }
+  }
+  left.insert(left.end(), right.begin(), right.end());
+  left.push_back(make_op(EXPR_BINARY, operation));
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! compile_unary
+
+Returned Value: int
+   If a function reading part of the value returns an error code, this
+   returns that code.
+   If any of the following errors occur, this returns the error code
+   shown.  Otherwise, it returns INTERP_OK.
+   1. The operation name is not followed by a left bracket:
+      NCE_LEFT_BRACKET_MISSING_AFTER_UNARY_OPERATION_NAME
+   2. The first argument of atan is not followed by a slash:
+      NCE_SLASH_MISSING_AFTER_FIRST_ATAN_ARGUMENT
+   3. The slash is not followed by a left bracket:
+      NCE_LEFT_BRACKET_MISSING_AFTER_SLASH_WITH_ATAN
+
+Side effects:
+   The program computing the unary operation starting at counter is
+   appended to code.  The counter is reset to point to the first
+   character after it.
+
+Called by: compile_real_value
+
+*/
+
+int Interp::compile_unary(char *line,    //!< string: line of RS274/NGC code being processed
+                          int *counter,  //!< pointer to a counter for position on the line
+                          expr_code &code)       //!< program to append to
+{
+  int operation;
+  size_t start = code.size();
+  size_t second;
+
+  CHP(read_operation_unary(line, counter, &operation));
+  CHKS((line[*counter] != '['),
+      NCE_LEFT_BRACKET_MISSING_AFTER_UNARY_OPERATION_NAME);
+
+  if (operation == EXISTS)
+    return compile_bracketed_parameter(line, counter, code, true);
+
+  CHP(compile_real_expression(line, counter, code));
+
+  if (operation == ATAN) {
+    CHKS((line[*counter] != '/'), NCE_SLASH_MISSING_AFTER_FIRST_ATAN_ARGUMENT);
+    *counter = (*counter + 1);
+    CHKS((line[*counter] != '['),
+        NCE_LEFT_BRACKET_MISSING_AFTER_SLASH_WITH_ATAN);
+    second = code.size();
+    CHP(compile_real_expression(line, counter, code));
+    if (second == start + 1 && code[start].code == EXPR_NUMBER &&
+        std::isfinite(code[start].number) && is_number(code, second)) {
+      double value = atan2(code[start].number, code[second].number);
+      code[start].number = ((value * 180.0) / M_PIl);
+      code.pop_back();
+    } else
+      code.push_back(make_op(EXPR_ATAN));
+  } else {
+    if (is_number(code, start) &&
+        can_fold_unary(code[start].number, operation)) {
+      double value = code[start].number;
+      if (execute_unary(&value, operation) == INTERP_OK &&
+          std::isfinite(value)) {
+        code[start].number = value;
+        return INTERP_OK;
+      }
+    }
+    code.push_back(make_op(EXPR_UNARY, operation));
+  }
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! compile_parameter
+
+Returned Value: int
+   If a function reading part of the parameter returns an error code,
+   this returns that code.
+   Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The program reading the parameter (or whether it exists, if
+   check_exists) starting at counter is appended to code.  The counter
+   is reset to point to the first character after it.
+
+Called by:
+   compile_real_value
+   compile_bracketed_parameter
+
+A parameter numbered by a constant is read directly, without checking
+the number again.  Named parameters are looked up at run time by a
+name kept with strstore(), since which one a name means depends on the
+call level then.
+
+*/
+
+int Interp::compile_parameter(char *line,        //!< string: line of RS274/NGC code being processed
+                              int *counter,      //!< pointer to a counter for position on the line
+                              expr_code &code,   //!< program to append to
+                              bool check_exists) //!< test for existence, not value
+{
+  char paramNameBuf[LINELEN+1];
+  size_t start;
+  int index;
+
+  CHKS((line[*counter] != '#'), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+
+  *counter = (*counter + 1);
+
+  if(line[*counter] == '<')
+  {
+      CHP(read_name(line, counter, paramNameBuf));
+      code.push_back(make_op(check_exists ? EXPR_EXISTS_NAMED : EXPR_NAMED,
+                             0, 0.0, strstore(paramNameBuf)));
+      return INTERP_OK;
+  }
+
+  start = code.size();
+  CHP(compile_real_value(line, counter, code));
+  if (is_number(code, start) && integer_value(code[start].number, &index)) {
+      if (check_exists) {
+          code[start] = make_op(EXPR_NUMBER, 0,
+                                index >= 1 && index < RS274NGC_MAX_PARAMETERS);
+          return INTERP_OK;
+      }
+      if (index >= 1 && index < RS274NGC_MAX_PARAMETERS) {
+          code[start] = make_op(EXPR_PARAM, index);
+          return INTERP_OK;
+      }
+  }
+  code.push_back(make_op(check_exists ? EXPR_EXISTS_AT : EXPR_PARAM_AT));
+  return INTERP_OK;
+}
+
+int Interp::compile_bracketed_parameter(
+    char *line,   //!< string: line of RS274/NGC code being processed
+    int *counter, //!< pointer to a counter for position on the line
+    expr_code &code,      //!< program to append to
+    bool check_exists)    //!< test for existence, not value
+{
+  CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  *counter = (*counter + 1);
+  CHKS((line[*counter] != '#'), _("Expected # reading parameter"));
+  CHP(compile_parameter(line, counter, code, check_exists));
+  CHKS((line[*counter] != ']'), _("Expected ] reading bracketed parameter"));
+  *counter = (*counter + 1);
+  return INTERP_OK;
+}
@@ -0,0 +1,54 @@
+/********************************************************************
+* Description: interp_expr.hh
+*   Values read from a line, compiled for a small stack machine.
+*
+*   A value on a line (a number, a parameter, a unary function or a
+*   bracketed expression) is read by parsing its text and computing as
+*   it goes.  For lines kept in the block cache, each value is compiled
+*   the first time it is read: numbers are converted, constant parts
+*   are folded, parameter numbers and names are looked up in the text
+*   once.  Reading the line again runs the compiled program instead.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#ifndef INTERP_EXPR_HH
+#define INTERP_EXPR_HH
+
+#include <vector>
+
+enum expr_opcode {
+    EXPR_NUMBER,        // push number
+    EXPR_PARAM,         // push parameters[arg]
+    EXPR_PARAM_AT,      // replace top with the parameter it numbers
+    EXPR_EXISTS_AT,     // replace top with whether it numbers a parameter
+    EXPR_NAMED,         // push named parameter name
+    EXPR_EXISTS_NAMED,  // push whether named parameter name exists
+    EXPR_NEGATE,        // negate top
+    EXPR_UNARY,         // apply unary operation arg to top
+    EXPR_ATAN,          // pop two, push atan of their ratio in degrees
+    EXPR_BINARY,        // pop two, push the result of binary operation arg
+};
+
+struct expr_op {
+    unsigned char code;     // expr_opcode
+    bool check;             // a value read ends here and must be finite
+    int arg;                // operation or parameter number
+    double number;          // EXPR_NUMBER
+    const char *name;       // EXPR_NAMED, EXPR_EXISTS_NAMED, from strstore()
+};
+
+typedef std::vector<expr_op> expr_code;
+
+// Longer programs are not kept; nothing written by hand comes close.
+#define EXPRESSION_MAX_CODE 256
+#define EXPRESSION_MAX_DEPTH 32
+
+struct expression {
+    expr_code code;
+    int end;                // counter after the value
+};
+
+#endif // INTERP_EXPR_HH
@@ -0,0 +1,201 @@
+/********************************************************************
+* Description: interp_file.cc
+*   Memory-mapped NC program source for the interpreter.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "interp_file.hh"
+
+struct InterpFile::mapping {
+    const char *data = nullptr;
+    size_t size = 0;
+    stamp ident{};
+
+    mapping() = default;
+    mapping(const mapping &) = delete;
+    mapping &operator=(const mapping &) = delete;
+    ~mapping() {
+        if (data)
+            munmap(const_cast<char *>(data), size);
+    }
+};
+
+// Files opened before, by the name they were opened with.  The same
+// subroutine files are opened on every call and every return to their
+// caller, by every program, so they stay mapped; an entry is replaced
+// when the file's stamp changes.
+#define MAX_MAPPINGS 256
+static std::mutex mappings_lock;
+static std::unordered_map<std::string,
+                          std::shared_ptr<const InterpFile::mapping>> mappings;
+
+static InterpFile::stamp make_stamp(const struct stat &st)
+{
+    InterpFile::stamp id;
+    id.dev = st.st_dev;
+    id.ino = st.st_ino;
+    id.mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    id.size = st.st_size;
+    return id;
+}
+
+static void keep_mapping(const char *filename,
+                         const std::shared_ptr<const InterpFile::mapping> &m)
+{
+    std::lock_guard<std::mutex> guard(mappings_lock);
+    if (mappings.size() >= MAX_MAPPINGS) {
+        // drop the ones nobody has open
+        for (auto it = mappings.begin(); it != mappings.end(); ) {
+            if (it->second.use_count() == 1)
+                it = mappings.erase(it);
+            else
+                ++it;
+        }
+    }
+    mappings[filename] = m;
+}
+
+InterpFile *InterpFile::open(const char *filename)
+{
+    struct stat st;
+    if (stat(filename, &st) == 0 && S_ISREG(st.st_mode)) {
+        stamp id = make_stamp(st);
+        std::lock_guard<std::mutex> guard(mappings_lock);
+        auto it = mappings.find(filename);
+        if (it != mappings.end() && it->second->ident == id) {
+            InterpFile *f = new InterpFile;
+            f->map = it->second;
+            f->data = f->map->data;
+            f->size = f->map->size;
+            f->ident = id;
+            return f;
+        }
+    }
+
+    int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    InterpFile *f = new InterpFile;
+    if (S_ISREG(st.st_mode)) {
+        auto m = std::make_shared<mapping>();
+        // An empty file can't be mapped and has nothing to read anyway.
+        // Note that like any mapping this one is not protected against the
+        // file being truncated underneath it; editors that rewrite a
+        // program in place while it runs should save to a new file.
+        if (st.st_size > 0) {
+            void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                delete f;
+                errno = err;
+                return NULL;
+            }
+            m->data = static_cast<const char *>(p);
+            m->size = st.st_size;
+        }
+        m->ident = make_stamp(st);
+        keep_mapping(filename, m);
+        f->map = m;
+        f->data = m->data;
+        f->size = m->size;
+        f->ident = m->ident;
+    } else {
+        char *buf = NULL;
+        size_t alloc = 0;
+        for (;;) {
+            if (f->size == alloc) {
+                alloc = alloc ? 2 * alloc : 65536;
+                char *nbuf = static_cast<char *>(realloc(buf, alloc));
+                if (!nbuf) {
+                    free(buf);
+                    ::close(fd);
+                    delete f;
+                    errno = ENOMEM;
+                    return NULL;
+                }
+                buf = nbuf;
+            }
+            ssize_t r = ::read(fd, buf + f->size, alloc - f->size);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r < 0) {
+                int err = errno;
+                free(buf);
+                ::close(fd);
+                delete f;
+                errno = err;
+                return NULL;
+            }
+            if (r == 0)
+                break;
+            f->size += r;
+        }
+        f->data = buf;
+    }
+    // the mapping stays valid without the descriptor
+    ::close(fd);
+    return f;
+}
+
+InterpFile::~InterpFile()
+{
+    if (!map)
+        free(const_cast<char *>(data));
+}
+
+char *InterpFile::read_line(char *buf, int bufsize)
+{
+    if (pos >= size || bufsize <= 0)
+        return NULL;
+    size_t avail = size - pos;
+    size_t max = bufsize - 1;
+    if (avail < max)
+        max = avail;
+    const char *start = data + pos;
+    const char *nl = static_cast<const char *>(memchr(start, '\n', max));
+    size_t len = nl ? (size_t)(nl - start) + 1 : max;
+    memcpy(buf, start, len);
+    buf[len] = 0;
+    pos += len;
+    return buf;
+}
+
+void InterpFile::skip_line()
+{
+    if (pos >= size)
+        return;
+    const char *start = data + pos;
+    const char *nl = static_cast<const char *>(memchr(start, '\n', size - pos));
+    pos = nl ? (size_t)(nl - data) + 1 : size;
+}
+
+void InterpFile::seek(long offset)
+{
+    if (offset < 0)
+        return;
+    pos = (size_t)offset > size ? size : offset;
+}
@@ -0,0 +1,76 @@
+/********************************************************************
+* Description: interp_file.hh
+*   Memory-mapped NC program source for the interpreter.
+*
+*   The interpreter used to read programs through stdio, which costs a
+*   buffer refill on every fseek() done for an O-word call or return.
+*   An InterpFile maps the whole program instead, so reading a line is
+*   a single copy out of the page cache and seeking only moves an
+*   offset.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#ifndef INTERP_FILE_HH
+#define INTERP_FILE_HH
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <memory>
+
+class InterpFile {
+public:
+    // Returns NULL with errno set if the file can't be opened.  Regular
+    // files are mapped; anything else (a pipe, say) is read into memory.
+    // Mappings are shared and kept after the file is closed, so reopening
+    // an unchanged file on a subroutine call or return costs one stat().
+    static InterpFile *open(const char *filename);
+    ~InterpFile();
+
+    // Like fgets(): copy the next line including its newline, at most
+    // size-1 characters, and NUL terminate.  NULL at end of file.
+    char *read_line(char *buf, int size);
+    // Like the fgetc() loop used after an overlong line: move past the
+    // next newline.
+    void skip_line();
+
+    long tell() const { return pos; }
+    // as fseek(SEEK_SET): a negative offset is ignored, one past the end
+    // leaves the file at end of file
+    void seek(long offset);
+    bool eof() const { return pos >= size; }
+
+    // Identifies the file contents for caches keyed by file and offset.
+    // A program that is edited gets a new mtime or size and so a new
+    // stamp.  ino is 0 for files that were not mapped, which have no
+    // stable identity.
+    struct stamp {
+        dev_t dev;
+        ino_t ino;
+        long long mtime_ns;
+        off_t size;
+        bool operator==(const stamp &o) const {
+            return dev == o.dev && ino == o.ino &&
+                mtime_ns == o.mtime_ns && size == o.size;
+        }
+        bool operator!=(const stamp &o) const { return !(*this == o); }
+    };
+    const stamp &id() const { return ident; }
+
+    struct mapping;
+
+private:
+    InterpFile() = default;
+    InterpFile(const InterpFile &) = delete;
+    InterpFile &operator=(const InterpFile &) = delete;
+
+    const char *data = nullptr;
+    size_t size = 0;
+    size_t pos = 0;
+    std::shared_ptr<const mapping> map;   // NULL if read into memory
+    stamp ident{};
+};
+
+#endif // INTERP_FILE_HH
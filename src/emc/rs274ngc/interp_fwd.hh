@@ -15,6 +15,9 @@
 #define INTERP_FWD_HH
 
 class Interp;
+class InterpFile;
+class BlockCache;
+struct block_cache_entry;
 
 struct block_struct;
 typedef struct block_struct *block_pointer;
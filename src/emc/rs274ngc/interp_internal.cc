@@ -23,6 +23,7 @@
 #include "rs274ngc_return.hh"
 #include "interp_internal.hh"	// interpreter private definitions
 #include "rs274ngc_interp.hh"
+#include "interp_blockcache.hh"
 #include <string.h>
 
 /****************************************************************************/
@@ -334,6 +335,10 @@ Side effects:
    One RS274 line is read into a block and the block is checked for
    errors. System parameters may be reset.
 
+If read_text took the line from the block cache and the words it held
+were kept there, they are copied into the block instead of being read
+again.
+
 Called by:  Interp::read
 
 */
@@ -342,8 +347,20 @@ int Interp::parse_line(char *line,       //!< array holding a line of RS274 code
                       block_pointer block,      //!< pointer to a block to be filled
                       setup_pointer settings)   //!< pointer to machine settings
 {
+  block_cache_entry *cached = settings->cached_block;
+
   CHP(init_block(block));
-  CHP(read_items(block, line, settings->parameters));
+  if (cached && cached->words && (settings->skipping_o == NULL) &&
+      (!cached->words->x_flag ||
+       (cached->diameter_mode == settings->lathe_diameter_mode))) {
+    BlockCache::copy_words(block, cached->words.get());
+    settings->block_cache->parsed++;
+  } else {
+    CHP(read_items(block, line, settings->parameters));
+    if (cached && (settings->skipping_o == NULL))
+      settings->block_cache->set_words(cached, block,
+                                       settings->lathe_diameter_mode);
+  }
 
   if(settings->skipping_o == NULL)
   {
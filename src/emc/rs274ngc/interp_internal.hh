@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <set>
 #include <map>
+#include <string>
 #include <bitset>
 #include "nml_intf/canon.hh"
 #include <emcpos.h>
@@ -29,6 +30,7 @@
 #include <rtapi_string.h>	// rtapi_strlcpy()
 #include "interp_parameter_def.hh"
 #include "interp_fwd.hh"
+#include "interp_parammap.hh"
 #include "interp_base.hh"
 #include "tooldata/tooldata.hh"
 
@@ -563,14 +565,16 @@ enum call_types {
 
 enum retopts { RET_NONE, RET_DOUBLE, RET_INT, RET_YIELD, RET_STOPITERATION, RET_ERRORMSG };
 
-// parameters will go to a std::map<const char *,parameter_value_pointer>
-struct parameter_value_struct {
-    double value;
-    unsigned attr;
+
+// a '_hal[name]' parameter resolved to the pin, signal or param it reads,
+// valid while hal_generation() returns generation
+struct hal_ref_struct {
+    int type;           // hal_type_t
+    void *ref;          // hal_refs_u
+    unsigned generation;
 };
 
-typedef std::map<const char *, parameter_value, nocase_cmp> parameter_map;
-typedef parameter_map::iterator parameter_map_iterator;
+typedef std::map<std::string, hal_ref_struct, std::less<>> hal_ref_map;
 
 #define PA_READONLY	1
 #define PA_GLOBAL	2
@@ -722,7 +726,9 @@ struct setup
   bool feed_override;         // whether feed override is enabled
   double feed_rate;             // feed rate in current units/min
   char filename[PATH_MAX];      // name of currently open NC code file
-  FILE *file_pointer;           // file pointer for open NC code file
+  InterpFile *file_pointer;     // open NC code file
+  BlockCache *block_cache;      // lines read again by loops and calls
+  block_cache_entry *cached_block; // cache entry of line last read, or NULL
   bool flood;                 // whether flood coolant is on
   CANON_UNITS length_units;     // millimeters or inches
   double center_arc_radius_tolerance_inch; // modify with INI setting
@@ -790,6 +796,7 @@ struct setup
   context sub_context[INTERP_SUB_ROUTINE_LEVELS];
   int call_state;                  //  enum call_states - indicate Py handler reexecution
   offset_map_type offset_map;      // store label x name, file, line
+  hal_ref_map hal_refs;            // _hal[] parameters read so far
 
   bool adaptive_feed;              // adaptive feed is enabled
   bool feed_hold;                  // feed hold is enabled
@@ -48,6 +48,7 @@ namespace bp = boost::python;
 #include "rs274ngc_return.hh"
 #include "interp_internal.hh"
 #include "rs274ngc_interp.hh"
+#include "interp_blockcache.hh"
 #include <inifile.hh>
 
 // for HAL pin variables
@@ -113,6 +114,9 @@ enum predefined_named_parameters {
     NP_SELECTED_TOOL,
     NP_VALUE_RETURNED,
     NP_TASK,
+    NP_BLOCK_CACHE_HITS,
+    NP_BLOCK_CACHE_MISSES,
+    NP_BLOCK_CACHE_PARSED,
 };
 
 /****************************************************************************/
@@ -240,9 +244,29 @@ int Interp::fetch_ini_param( const char *nameBuf, int *status, double *value)
     return INTERP_OK;
 }
 
+// Read a HAL value through a reference from hal_getref_[ps]() or
+// hal_get_[ps](), as hal_get_[ps]() itself does.
+static bool read_hal_ref(int type, void *ref, double *value)
+{
+    hal_refs_u u;
+    u.s = (hal_sint_t)ref;
+    switch (type) {
+    case HAL_BOOL: *value = (double)hal_get_bool(u.b); break;
+    case HAL_U32:  *value = (double)hal_get_ui32(u.u); break;
+    case HAL_S32:  *value = (double)hal_get_si32(u.s); break;
+    case HAL_UINT: *value = (double)hal_get_uint(u.u); break;
+    case HAL_SINT: *value = (double)hal_get_sint(u.s); break;
+    case HAL_REAL: *value = (double)hal_get_real(u.r); break;
+    default: return false;
+    }
+    return true;
+}
+
 // if the variable is of the form '_hal[hal_name]', then treat it as
 // a HAL pin, signal or param. Lookup value, convert to float, and export as global and read-only.
-// do not cache.
+// The value is not cached, but the object the name resolves to is: later
+// reads go straight to it, without the HAL mutex, until hal_generation()
+// says pins, signals or params were added, removed or (un)linked.
 // the shortest possible HAL variable is '_hal[x]' or 7 chars long .
 int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
 {
@@ -271,8 +295,6 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
     retval = hal_is_init();
     CHKS(retval == 0, "fetch_hal_param: HAL is not initialized (hal_is_init() returned zero)");
 
-    hal_type_t type = HAL_TYPE_UNINITIALIZED;
-    hal_query_value_u qval;
     std::string hal_name = nameBuf + 5;  // skip the '_hal[' part
     size_t i = hal_name.find(']');
     if(std::string::npos == i) {
@@ -286,35 +308,50 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
     }
     hal_name.erase(i); // Remove everything from ']'and after
 
-    // Retrieve the active value from the pin/signal/param (in that order)
+    unsigned generation = hal_generation();
+    hal_ref_map::iterator ri = _setup.hal_refs.find(nameBuf);
+    if(ri != _setup.hal_refs.end() && ri->second.generation == generation) {
+        // Taken as read if nothing was deleted or relinked while reading
+        if(read_hal_ref(ri->second.type, ri->second.ref, value) &&
+           hal_generation() == generation) {
+            *status = 1;
+            return INTERP_OK;
+        }
+        generation = hal_generation();
+    }
+
+    hal_type_t type = HAL_TYPE_UNINITIALIZED;
+    hal_refs_u ref;
+
+    // Retrieve the active reference of the pin/signal/param (in that order)
     hal_query_t q = {};
     q.name = hal_name.c_str();
     q.qtype = HAL_QTYPE_PIN;
-    if(0 == hal_get_p(&q, NULL, NULL)) {
+    if(0 == hal_getref_p(&q)) {
         // FIXME: It is not always logical to complain on an pin that is
         // not attached to a signal. HAL_OUT pins should always give a real
         // result. HAL_IO pins could be fine, but that depends on whether
         // there has been written proper data on it yet.
         if(!q.pp.signal)
             logOword("%s: no signal connected", hal_name.c_str());
-        qval = q.pp.value;
+        ref = q.pp.ref;
         type = q.pp.type;
         goto assign;
     }
     q = {};
     q.name = hal_name.c_str();
-    if(0 == hal_get_s(&q, NULL, NULL)) {
+    if(0 == hal_getref_s(&q)) {
         if(q.sig.writers <= 0)
             logOword("%s: signal has no writer", hal_name.c_str());
-        qval = q.sig.value;
+        ref = q.sig.ref;
         type = q.sig.type;
         goto assign;
     }
     q = {};
     q.name = hal_name.c_str();
     q.qtype = HAL_QTYPE_PARAM;
-    if(0 == hal_get_p(&q, NULL, NULL)) {
-        qval = q.pp.value;
+    if(0 == hal_getref_p(&q)) {
+        ref = q.pp.ref;
         type = q.pp.type;
         goto assign;
     }
@@ -324,15 +361,9 @@ int Interp::fetch_hal_param( const char *nameBuf, int *status, double *value)
     return INTERP_OK;
 
     assign:
-    switch (type) {
-    case HAL_BOOL: *value = (double)qval.b; break;
-    case HAL_U32:  *value = (double)qval.u; break;
-    case HAL_S32:  *value = (double)qval.s; break;
-    case HAL_UINT: *value = (double)qval.u; break;
-    case HAL_SINT: *value = (double)qval.s; break;
-    case HAL_REAL: *value = (double)qval.r; break;
-    default: return -1;
-    }
+    if(!read_hal_ref(type, (void *)ref.s, value))
+        return -1;
+    _setup.hal_refs[nameBuf] = {type, (void *)ref.s, generation};
     logOword("%s: value=%f", hal_name.c_str(), *value);
     *status = 1;
     return INTERP_OK; 
@@ -831,6 +862,18 @@ int Interp::lookup_named_param(const char *nameBuf,
 	*value = _task;
 	break;
 
+    case NP_BLOCK_CACHE_HITS:
+	*value = _setup.block_cache->hits;
+	break;
+
+    case NP_BLOCK_CACHE_MISSES:
+	*value = _setup.block_cache->misses;
+	break;
+
+    case NP_BLOCK_CACHE_PARSED:
+	*value = _setup.block_cache->parsed;
+	break;
+
     default:
 	ERS(_("BUG: lookup_named_param(%s): unhandled index=%fn"),
 	      nameBuf,index);
@@ -1005,6 +1048,11 @@ int Interp::init_named_parameters()
   init_readonly_param("_call_level", NP_CALL_LEVEL, PA_USE_LOOKUP);
   init_readonly_param("_remap_level", NP_REMAP_LEVEL, PA_USE_LOOKUP);
 
+  // block cache counters, see interp_blockcache.hh
+  init_readonly_param("_block_cache_hits", NP_BLOCK_CACHE_HITS, PA_USE_LOOKUP);
+  init_readonly_param("_block_cache_misses", NP_BLOCK_CACHE_MISSES, PA_USE_LOOKUP);
+  init_readonly_param("_block_cache_parsed", NP_BLOCK_CACHE_PARSED, PA_USE_LOOKUP);
+
   return INTERP_OK;
 }
 
@@ -32,6 +32,8 @@
 #include "nml_intf/interp_return.hh"
 #include "interp_internal.hh"
 #include "rs274ngc_interp.hh"
+#include "interp_file.hh"
+#include "interp_subcache.hh"
 #include "pythonplugin/python_plugin.hh"
 #include "interp_python.hh"
 #include <rtapi_string.h>	// rtapi_strlcpy()
@@ -120,6 +122,12 @@ int Interp::control_save_offset(block_pointer block,        /* pointer to a bloc
     // the proper value
     new_offset.sequence_number = settings->sequence_number - 1;
     settings->offset_map[block->o_name] = new_offset;
+
+    // a sub that was searched for is remembered beyond this program
+    if (settings->skipping_to_sub && settings->file_pointer)
+	SubroutineCache::instance().store_sub(settings->filename,
+					      settings->file_pointer->id(),
+					      block->o_name, new_offset);
     return INTERP_OK;
 }
 
@@ -229,7 +237,7 @@ int Interp::execute_call(setup_pointer settings,
 	    // reopen it on return.
 	    previous_frame->position = -1;
 	else
-	    previous_frame->position = ftell(settings->file_pointer);
+	    previous_frame->position = settings->file_pointer->tell();
 	previous_frame->filename = strstore(settings->filename);
 	previous_frame->sequence_number = settings->sequence_number;
 	logOword("saving return location[cl=%d]: %s:%d offset=%ld", 
@@ -454,7 +462,7 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 
 	    // file at this level was marked as closed, so dont reopen.
 	    if (previous_frame->position == -1) {
-		if (settings->file_pointer) fclose(settings->file_pointer);
+		delete settings->file_pointer;
 		settings->file_pointer = NULL;
 		rtapi_strxcpy(settings->filename, "");
 	    } else {
@@ -463,8 +471,8 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 		}
 		//!!!KL must open the new file, if changed
 		if (0 != strcmp(settings->filename, previous_frame->filename))  {
-		    fclose(settings->file_pointer);
-		    settings->file_pointer = fopen(previous_frame->filename, "r");
+		    delete settings->file_pointer;
+		    settings->file_pointer = InterpFile::open(previous_frame->filename);
 		    if (settings->file_pointer == NULL)  {
 			ERS(NCE_CANNOT_REOPEN_FILE, 
 			    previous_frame->filename,
@@ -472,7 +480,7 @@ int Interp::execute_return(setup_pointer settings, context_pointer current_frame
 		    }
 		    rtapi_strxcpy(settings->filename, previous_frame->filename);
 		}
-		fseek(settings->file_pointer, previous_frame->position, SEEK_SET);
+		settings->file_pointer->seek(previous_frame->position);
 		settings->sequence_number = previous_frame->sequence_number;
 		logOword("endsub/return: %s:%d pos=%ld", 
 			 settings->filename,previous_frame->sequence_number,
@@ -524,7 +532,7 @@ void Interp::loop_to_beginning(setup_pointer settings)
 
     // scroll back to beginning of file/first block
     if (settings->file_pointer != NULL)
-        fseek(settings->file_pointer, 0, SEEK_SET);
+        settings->file_pointer->seek(0);
     settings->sequence_number = 0;
 }
 
@@ -544,7 +552,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 {
     static char name[] = "control_back_to";
     char newFileName[PATH_MAX];
-    FILE *newFP;
+    InterpFile *newFP;
     offset_map_iterator it;
     offset_pointer op;
     logOword("Entered:%s %s", name,basename(block->o_name));
@@ -560,11 +568,13 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	if (0 != strcmp(settings->filename,
 			op->filename)) {
 	    // open the new file...
-	    newFP = fopen(op->filename, "r");
+	    newFP = InterpFile::open(op->filename);
 	    // set the line number
 	    settings->sequence_number = 0;
             if (strlen(op->filename) >= sizeof(settings->filename)) {
-                fclose(settings->file_pointer);
+                delete settings->file_pointer;
+                settings->file_pointer = NULL;
+                delete newFP;
                 logOword("filename too long: %s", op->filename);
                 ERS(NCE_UNABLE_TO_OPEN_FILE, op->filename);
             }
@@ -572,8 +582,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 
 	    if (newFP) {
 		// close the old file...
-		if (settings->file_pointer) // only close if it was open
-		    fclose(settings->file_pointer);
+		delete settings->file_pointer;
 		settings->file_pointer = newFP;
 	    } else {
 		logOword("Unable to open file: %s", settings->filename);
@@ -581,8 +590,7 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	    }
 	}
 	if (settings->file_pointer) { // only seek if it was open
-	    fseek(settings->file_pointer,
-		  op->offset, SEEK_SET);
+	    settings->file_pointer->seek(op->offset);
 	}
 	settings->sequence_number = op->sequence_number;
 	return INTERP_OK;
@@ -596,14 +604,27 @@ int Interp::control_back_to( block_pointer block, // pointer to block
 	settings->sequence_number = 0;
 
 	// close the old file...
-	if (settings->file_pointer)
-	    fclose(settings->file_pointer);
+	delete settings->file_pointer;
 	settings->file_pointer = newFP;
         if (strlen(newFileName) >= sizeof(settings->filename)) {
             logOword("new filename '%s' is too long (max len %zu)\n", newFileName, sizeof(settings->filename)-1);
             ERS(NCE_UNABLE_TO_OPEN_FILE, newFileName);
         }
         strncpy(settings->filename, newFileName, sizeof(settings->filename));
+
+	// found in this file before: define it and go there, as in #1
+	offset new_offset;
+	if (SubroutineCache::instance().find_sub(newFileName, newFP->id(),
+						 basename(block->o_name),
+						 &new_offset)) {
+	    logOword("cached sub: |%s| at %ld", newFileName, new_offset.offset);
+	    new_offset.filename = strstore(newFileName);
+	    new_offset.repeat_count = -1;
+	    settings->offset_map[strstore(basename(block->o_name))] = new_offset;
+	    settings->file_pointer->seek(new_offset.offset);
+	    settings->sequence_number = new_offset.sequence_number;
+	    return INTERP_OK;
+	}
     } else {
 	// No file found for this sub name.
 	// Block forward-seek if the current file is not the main program.
@@ -0,0 +1,128 @@
+/********************************************************************
+* Description: interp_parammap.cc
+*   Named parameters of a call frame.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+
+#include "interp_parammap.hh"
+
+bool parameter_map::key_compare::operator()(const char *s1,
+                                            const char *s2) const
+{
+    return strcasecmp(s1, s2) < 0;
+}
+
+parameter_map::parameter_map(const parameter_map &other)
+{
+    *this = other;
+}
+
+parameter_map &parameter_map::operator=(const parameter_map &other)
+{
+    if (&other == this)
+        return *this;
+    clear();
+    for (size_t i = 0; i < other.count; i++)
+        (*this)[other.entry(i).first] = other.entry(i).second;
+    return *this;
+}
+
+// FNV-1a over the name folded to lower case
+unsigned parameter_map::hash(const char *name)
+{
+    unsigned h = 2166136261u;
+    for (; *name; name++) {
+        h ^= (unsigned char) tolower((unsigned char) *name);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t parameter_map::probe(const char *name, unsigned h)
+{
+    size_t mask = slots.size() - 1;
+    for (size_t s = h & mask;; s = (s + 1) & mask) {
+        unsigned e = slots[s];
+        if (e == 0)
+            return s;
+        const char *key = entry(e - 1).first;
+        if (hashes[e - 1] == h && (key == name || strcasecmp(key, name) == 0))
+            return s;
+    }
+}
+
+void parameter_map::rehash(size_t nslots)
+{
+    slots.assign(nslots, 0);
+    size_t mask = nslots - 1;
+    for (size_t i = 0; i < count; i++) {
+        size_t s = hashes[i] & mask;
+        while (slots[s])
+            s = (s + 1) & mask;
+        slots[s] = i + 1;
+    }
+}
+
+parameter_map::iterator parameter_map::find(const char *name)
+{
+    if (count == 0)
+        return end();
+    unsigned e = slots[probe(name, hash(name))];
+    return e ? iterator(this, e - 1) : end();
+}
+
+parameter_value &parameter_map::operator[](const char *name)
+{
+    unsigned h = hash(name);
+    size_t s;
+
+    if (count) {
+        s = probe(name, h);
+        if (slots[s])
+            return entry(slots[s] - 1).second;
+    }
+    // keep the table at most half full
+    if ((count + 1) * 2 > slots.size())
+        rehash(std::max<size_t>(2 * slots.size(), 2 * CHUNK_ENTRIES));
+    s = probe(name, h);
+
+    if (count == chunks.size() * CHUNK_ENTRIES)
+        chunks.emplace_back(new value_type[CHUNK_ENTRIES]);
+    value_type &e = entry(count);
+    e.first = name;
+    e.second = parameter_value();
+    hashes.push_back(h);
+    slots[s] = ++count;
+    return e.second;
+}
+
+parameter_map::size_type parameter_map::erase(const char *name)
+{
+    iterator it = find(name);
+    if (it == end())
+        return 0;
+    // rare: move the later entries down, then index them again
+    for (size_t i = it.index; i + 1 < count; i++)
+        entry(i) = entry(i + 1);
+    hashes.erase(hashes.begin() + it.index);
+    count--;
+    rehash(slots.size());
+    return 1;
+}
+
+void parameter_map::clear()
+{
+    if (count == 0)
+        return;
+    count = 0;
+    hashes.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+}
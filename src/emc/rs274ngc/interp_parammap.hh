@@ -0,0 +1,114 @@
+/********************************************************************
+* Description: interp_parammap.hh
+*   Named parameters of a call frame.
+*
+*   Every #<name> read looks its name up in the frame of the current
+*   call level or in the global frame, and every subroutine call fills
+*   a frame and clears it again on return.  parameter_map is an open
+*   addressing hash table over entries kept in chunks that belong to
+*   the frame: clearing it keeps the chunks and the table, so a call
+*   that sets no more parameters than an earlier one at the same level
+*   allocates nothing.  Entries stay where they are as others are
+*   added, and are visited in the order they were added.
+*
+*   Names are compared without regard to case.  The map keeps the
+*   pointer it is given as key, normally one from strstore().
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#ifndef INTERP_PARAMMAP_HH
+#define INTERP_PARAMMAP_HH
+
+#include <stddef.h>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "interp_fwd.hh"
+
+struct parameter_value_struct {
+    double value;
+    unsigned attr;
+};
+
+class parameter_map {
+public:
+    typedef const char *key_type;
+    typedef parameter_value mapped_type;
+    typedef std::pair<const char *, parameter_value> value_type;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    struct key_compare {
+        bool operator()(const char *s1, const char *s2) const;
+    };
+
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef parameter_map::value_type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef value_type *pointer;
+        typedef value_type &reference;
+
+        iterator() : map(NULL), index(0) {}
+        reference operator*() const { return map->entry(index); }
+        pointer operator->() const { return &map->entry(index); }
+        iterator &operator++() { index++; return *this; }
+        iterator operator++(int) { iterator i = *this; index++; return i; }
+        bool operator==(const iterator &other) const { return index == other.index; }
+        bool operator!=(const iterator &other) const { return index != other.index; }
+
+    private:
+        friend class parameter_map;
+        iterator(parameter_map *m, size_t i) : map(m), index(i) {}
+        parameter_map *map;
+        size_t index;
+    };
+
+    parameter_map() = default;
+    parameter_map(const parameter_map &other);
+    parameter_map &operator=(const parameter_map &other);
+    parameter_map(parameter_map &&) = default;
+    parameter_map &operator=(parameter_map &&) = default;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    size_type size() const { return count; }
+    bool empty() const { return count == 0; }
+    key_compare key_comp() const { return key_compare(); }
+
+    iterator find(const char *name);
+    // The value of name, added as zero if it isn't there.
+    parameter_value &operator[](const char *name);
+    size_type erase(const char *name);
+    // Forget all entries.  The storage is kept for the next call.
+    void clear();
+
+private:
+    enum { CHUNK_ENTRIES = 16 };
+
+    value_type &entry(size_t i) {
+        return chunks[i / CHUNK_ENTRIES][i % CHUNK_ENTRIES];
+    }
+    const value_type &entry(size_t i) const {
+        return chunks[i / CHUNK_ENTRIES][i % CHUNK_ENTRIES];
+    }
+    static unsigned hash(const char *name);
+    // The slot holding name, or the free slot it would go in.
+    size_t probe(const char *name, unsigned h);
+    void rehash(size_t nslots);
+
+    std::vector<std::unique_ptr<value_type[]>> chunks;
+    std::vector<unsigned> hashes;   // hash of each entry's name
+    std::vector<unsigned> slots;    // entry index + 1, or 0 if free
+    size_t count = 0;
+};
+
+typedef parameter_map::iterator parameter_map_iterator;
+
+#endif // INTERP_PARAMMAP_HH
@@ -27,6 +27,8 @@
 #include "rs274ngc_return.hh"
 #include "interp_internal.hh"
 #include "rs274ngc_interp.hh"
+#include "interp_file.hh"
+#include "interp_blockcache.hh"
 #include <rtapi_math.h>
 #include <cmath>
 #include <rtapi_string.h>	// rtapi_strlcpy()
@@ -2670,6 +2672,9 @@ int Interp::read_real_expression(char *line,     //!< string: line of RS274/NGC
   int operators[MAX_STACK];
   int stack_index;
 
+  if (_setup.cached_block && line == _setup.blocktext)
+    return read_compiled_value(line, counter, value, parameters, true);
+
   CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
   *counter = (*counter + 1);
   CHP(read_real_value(line, counter, values, parameters));
@@ -2809,6 +2814,10 @@ index given by the counter. The value may be a number, a parameter
 value, a unary function, or an expression. It calls one of four
 other readers, depending upon the first character.
 
+On a line from the block cache, the value is compiled the first time
+it is read and the compiled program run after that; see
+read_compiled_value.
+
 */
 
 int Interp::read_real_value(char *line,  //!< string: line of RS274/NGC code being processed
@@ -2818,6 +2827,9 @@ int Interp::read_real_value(char *line,  //!< string: line of RS274/NGC code bei
 {
   char c, c1;
 
+  if (_setup.cached_block && line == _setup.blocktext)
+    return read_compiled_value(line, counter, double_ptr, parameters, false);
+
   c = line[*counter];
   CHKS((c == 0), NCE_NO_CHARACTERS_FOUND_IN_READING_REAL_VALUE);
 
@@ -3126,19 +3138,38 @@ what is read here.
 The value of the length argument is set to the number of characters on
 the reduced line.
 
+Lines read from a file a second time, by a loop or a subroutine call,
+are kept in the block cache and taken from there when read again. The
+cache entry is left in _setup.cached_block for parse_line.
+
 */
 
 int Interp::read_text(
     const char *command,       //!< a string which may have input text, or null
-    FILE * inport,     //!< a file pointer for an input file, or null
+    InterpFile * inport, //!< an open input file, or null
     char *raw_line,    //!< array to write raw input line into
     char *line,        //!< array for input line to be processed in
     int *length)       //!< a pointer to an integer to be set
 {
   int index;
 
+  long offset = 0;
+  block_cache_entry *cached = NULL;
+
   if (command == NULL) {
-    if (fgets(raw_line, LINELEN, inport) == NULL) {
+    // a line read before by a loop or call comes from the block cache
+    offset = inport->tell();
+    cached = _setup.block_cache->find(inport, offset);
+  }
+  _setup.cached_block = cached;
+
+  if (cached) {
+    _setup.sequence_number++;
+    rtapi_strlcpy(raw_line, cached->raw.c_str(), LINELEN);
+    rtapi_strlcpy(line, cached->text.c_str(), LINELEN);
+    inport->seek(cached->next);
+  } else if (command == NULL) {
+    if (inport->read_line(raw_line, LINELEN) == NULL) {
       if(_setup.skipping_to_sub)
       {
         ERS(_("EOF in file:%s seeking o-word: o<%s> from line: %d"),
@@ -3157,8 +3188,7 @@ int Interp::read_text(
     }
     _setup.sequence_number++;   /* moved from version1, was outside if */
     if (strlen(raw_line) == (LINELEN - 1)) { // line is too long. need to finish reading the line to recover
-      for (; fgetc(inport) != '\n' && !feof(inport) ;) {
-      }
+      inport->skip_line();
       ERS(NCE_COMMAND_TOO_LONG);
     }
     for (index = (strlen(raw_line) - 1);        // index set on last char
@@ -3172,6 +3202,8 @@ int Interp::read_text(
         FINISH();
         return INTERP_ENDFILE;
     }
+    _setup.cached_block = _setup.block_cache->insert(inport, offset,
+        inport->tell(), raw_line, line);
   } else {
     CHKS((strlen(command) >= LINELEN), NCE_COMMAND_TOO_LONG);
     rtapi_strlcpy(raw_line, command, LINELEN);
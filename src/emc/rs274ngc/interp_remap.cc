@@ -29,6 +29,7 @@ namespace bp = boost::python;
 #include "rs274ngc.hh"
 #include "rs274ngc_interp.hh"
 #include "interp_internal.hh"
+#include "interp_file.hh"
 #include <rtapi_string.h>
 
 #include <string>
@@ -499,10 +500,10 @@ int Interp::parse_remap(const char *inistring, int lineno)
 		errored = true;
 		continue;
 	    }
-	    FILE *fp = find_ngc_file(&_setup,arg);
+	    InterpFile *fp = find_ngc_file(&_setup,arg);
 	    if (fp) {
 		r.remap_ngc = strstore(arg);
-		fclose(fp);
+		delete fp;
 	    } else {
 		Error("INTERP_REMAP: NGC file not found: ngc=%s\nREMAP INI Line:%d = %s\n",
 		      arg, lineno, inistring);
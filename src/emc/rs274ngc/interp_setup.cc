@@ -22,6 +22,7 @@
 #endif
 #include <string.h>
 #include "rs274ngc_interp.hh"
+#include "interp_blockcache.hh"
 #include <boost/python/object.hpp>
 
 setup::setup() :
@@ -91,6 +92,8 @@ setup::setup() :
     feed_rate (0.0),
     filename{},
     file_pointer(NULL),
+    block_cache(new BlockCache),
+    cached_block(NULL),
     flood(0),
     length_units(CANON_UNITS_INCHES),
     center_arc_radius_tolerance_inch(CENTER_ARC_RADIUS_TOLERANCE_INCH),
@@ -205,4 +208,5 @@ setup::setup() :
 setup::~setup() {
     assert(!pythis || Py_IsInitialized());
     if(pythis) delete pythis;
+    delete block_cache;
 }
@@ -0,0 +1,102 @@
+/********************************************************************
+* Description: interp_subcache.cc
+*   Process-wide cache of subroutine file lookups.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <ctype.h>
+#include <sys/stat.h>
+
+#include "interp_internal.hh"
+#include "interp_subcache.hh"
+
+// A directory's stamp changes when a file is added to it, removed or
+// renamed, which is what can change the result of a search.  One that
+// doesn't exist has a zero stamp until it is created.
+static InterpFile::stamp dir_id(const std::string &dir)
+{
+    InterpFile::stamp id{};
+    struct stat st;
+    if (stat(dir.c_str(), &st) == 0) {
+        id.dev = st.st_dev;
+        id.ino = st.st_ino;
+        id.mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    }
+    return id;
+}
+
+static std::string sub_key(const char *path, const char *name)
+{
+    std::string key(path);
+    key += '\0';
+    for (; *name; name++)
+        key += tolower((unsigned char)*name);
+    return key;
+}
+
+SubroutineCache &SubroutineCache::instance()
+{
+    static SubroutineCache cache;
+    return cache;
+}
+
+bool SubroutineCache::find_path(const std::string &key, std::string &path)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = paths.find(key);
+    if (it == paths.end())
+        return false;
+    for (const dir_stamp &d : it->second.dirs) {
+        if (dir_id(d.dir) != d.id) {
+            paths.erase(it);
+            return false;
+        }
+    }
+    path = it->second.path;
+    return true;
+}
+
+void SubroutineCache::store_path(const std::string &key,
+                                 const std::vector<std::string> &dirs,
+                                 const std::string &path)
+{
+    resolution r;
+    for (const std::string &dir : dirs) {
+        dir_stamp d;
+        d.dir = dir;
+        d.id = dir_id(dir);
+        r.dirs.push_back(d);
+    }
+    r.path = path;
+    std::lock_guard<std::mutex> guard(lock);
+    paths[key] = r;
+}
+
+bool SubroutineCache::find_sub(const char *path, const InterpFile::stamp &id,
+                               const char *name, offset_pointer op)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = subs.find(sub_key(path, name));
+    if (it == subs.end() || it->second.id != id)
+        return false;
+    op->type = it->second.type;
+    op->offset = it->second.offset;
+    op->sequence_number = it->second.sequence_number;
+    return true;
+}
+
+void SubroutineCache::store_sub(const char *path, const InterpFile::stamp &id,
+                                const char *name, const offset &op)
+{
+    if (id.ino == 0)
+        return;
+    std::lock_guard<std::mutex> guard(lock);
+    sub_offset &s = subs[sub_key(path, name)];
+    s.id = id;
+    s.type = op.type;
+    s.offset = op.offset;
+    s.sequence_number = op.sequence_number;
+}
@@ -0,0 +1,74 @@
+/********************************************************************
+* Description: interp_subcache.hh
+*   Process-wide cache of subroutine file lookups.
+*
+*   Calling a subroutine that lives in its own file means searching
+*   the program prefix and each SUBROUTINE_PATH directory for it, then
+*   reading the file up to its 'sub' line.  offset_map forgets all of
+*   that when the program ends.  This cache keeps where each name was
+*   found and where in the file its definition starts, for as long as
+*   the directories searched and the file itself don't change.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#ifndef INTERP_SUBCACHE_HH
+#define INTERP_SUBCACHE_HH
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "interp_fwd.hh"
+#include "interp_file.hh"
+
+class SubroutineCache {
+public:
+    static SubroutineCache &instance();
+
+    // The file a search described by key found before, "" if it found
+    // none.  False if the search must be done again because one of the
+    // directories it looked in has changed since.
+    bool find_path(const std::string &key, std::string &path);
+    // Record the result of a search that looked in dirs, in order.
+    void store_path(const std::string &key,
+                    const std::vector<std::string> &dirs,
+                    const std::string &path);
+
+    // Where the definition of sub name starts in the file at path, if
+    // the file is still the one it was found in.  Fills in the type,
+    // offset and sequence number of op.
+    bool find_sub(const char *path, const InterpFile::stamp &id,
+                  const char *name, offset_pointer op);
+    void store_sub(const char *path, const InterpFile::stamp &id,
+                   const char *name, const offset &op);
+
+private:
+    SubroutineCache() = default;
+    SubroutineCache(const SubroutineCache &) = delete;
+    SubroutineCache &operator=(const SubroutineCache &) = delete;
+
+    struct dir_stamp {
+        std::string dir;
+        InterpFile::stamp id;
+    };
+    struct resolution {
+        std::vector<dir_stamp> dirs;
+        std::string path;
+    };
+    struct sub_offset {
+        InterpFile::stamp id;
+        int type;
+        long offset;
+        int sequence_number;
+    };
+
+    std::mutex lock;
+    std::unordered_map<std::string, resolution> paths;
+    std::unordered_map<std::string, sub_offset> subs;   // by path and name
+};
+
+#endif // INTERP_SUBCACHE_HH
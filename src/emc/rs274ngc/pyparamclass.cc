@@ -22,7 +22,9 @@
 #define BOOST_PYTHON_MAX_ARITY 4
 #include <boost/python/extract.hpp>
 #include <boost/python/suite/indexing/map_indexing_suite.hpp>
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace bp = boost::python;
 extern int _task;  // zero in gcodemodule, 1 in milltask
@@ -97,10 +99,15 @@ double ParamClass::setitem(bp::object sub, double dvalue)
 
 bp::list ParamClass::namelist(context &c) const {
     bp::list result;
+    std::vector<const char *> names;
     for(parameter_map::iterator it = c.named_params.begin();
 	it != c.named_params.end(); ++it) {
-	result.append( it->first);
+	names.push_back(it->first);
     }
+    // sorted, as they always were
+    std::sort(names.begin(), names.end(), parameter_map::key_compare());
+    for (const char *name : names)
+	result.append(name);
     return result;
 }
 
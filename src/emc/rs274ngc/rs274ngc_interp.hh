@@ -19,6 +19,7 @@
 #include <stdio.h>		// FILE
 #include "rs274ngc.hh"
 #include "interp_internal.hh"
+#include "interp_expr.hh"
 #include "nml_intf/interp_return.hh"
 
 class Interp : public InterpBase {
@@ -224,6 +225,14 @@ public:
  int check_m_codes(block_pointer block);
  int check_other_codes(block_pointer block);
  int close_and_downcase(char *line);
+ int compile_binary(expr_code &left, int operation, const expr_code &right);
+ int compile_bracketed_parameter(char *line, int *counter, expr_code &code,
+                                 bool check_exists);
+ int compile_parameter(char *line, int *counter, expr_code &code,
+                       bool check_exists);
+ int compile_real_expression(char *line, int *counter, expr_code &code);
+ int compile_real_value(char *line, int *counter, expr_code &code);
+ int compile_unary(char *line, int *counter, expr_code &code);
  void nurbs_reset_global_variables(void);
  int convert_nurbs(int move, block_pointer block, setup_pointer settings);
  int convert_spline(int move, block_pointer block, setup_pointer settings);
@@ -367,6 +376,8 @@ public:
  int execute_binary(double *left, int operation, double *right);
  int execute_binary1(double *left, int operation, double *right);
  int execute_binary2(double *left, int operation, double *right);
+ int execute_expression(const expression *e, double *value,
+                        double *parameters);
     int execute_block(block_pointer block, setup_pointer settings);
  int execute_unary(double *double_ptr, int operation);
  double find_arc_length(double x1, double y1, double z1,
@@ -504,11 +515,13 @@ int read_dollar(char *line, int *counter, block_pointer block,
  int read_real_number(char *line, int *counter, double *double_ptr);
  int read_real_value(char *line, int *counter, double *double_ptr,
                            double *parameters);
+ int read_compiled_value(char *line, int *counter, double *double_ptr,
+                         double *parameters, bool expression);
  int read_s(char *line, int *counter, block_pointer block,
                   double *parameters);
  int read_t(char *line, int *counter, block_pointer block,
                   double *parameters);
- int read_text(const char *command, FILE * inport, char *raw_line,
+ int read_text(const char *command, InterpFile * inport, char *raw_line,
                      char *line, int *length);
  int read_unary(char *line, int *counter, double *double_ptr,
                       double *parameters);
@@ -646,7 +659,7 @@ int read_inputs(setup_pointer settings);
 	       int calltype);
     int py_execute(const char *cmd, bool as_file = false); // for (py, ....) comments
     int py_reload();
-    FILE *find_ngc_file(setup_pointer settings,const char *basename, char *foundhere = NULL);
+    InterpFile *find_ngc_file(setup_pointer settings,const char *basename, char *foundhere = NULL);
 
     const char *getSavedError();
     // set error message text without going through printf format interpretation
@@ -98,6 +98,9 @@ include an option for suppressing superfluous commands.
 #include "interp_internal.hh"	// interpreter private definitions
 #include "interp_queue.hh"
 #include "rs274ngc_interp.hh"
+#include "interp_file.hh"
+#include "interp_blockcache.hh"
+#include "interp_subcache.hh"
 #include <wordexp.h>
 #include "units.h"
 
@@ -253,10 +256,13 @@ int Interp::close()
     }
 
   if (_setup.file_pointer != NULL) {
-    fclose(_setup.file_pointer);
+    delete _setup.file_pointer;
     _setup.file_pointer = NULL;
     _setup.percent_flag = false;
   }
+  logDebug("block cache: %lu hits (%lu parsed), %lu misses",
+	   _setup.block_cache->hits, _setup.block_cache->parsed,
+	   _setup.block_cache->misses);
   reset();
 
   return INTERP_OK;
@@ -1079,9 +1085,16 @@ int Interp::init()
           // INI file m98/m99 subprogram default setting
           _setup.disable_fanuc_style_sub = inifile.findBoolV("DISABLE_FANUC_STYLE_SUB", "RS274NGC", false);
           logDebug("init:  DISABLE_FANUC_STYLE_SUB = %d", _setup.disable_fanuc_style_sub);
+
+          _setup.block_cache->max_entries =
+              inifile.findIntV("BLOCK_CACHE_SIZE", "RS274NGC", BLOCK_CACHE_SIZE_DEFAULT, 0);
       }
   }
 
+  // remaps read above change how a line reads
+  _setup.block_cache->clear();
+  _setup.cached_block = NULL;
+
   USE_LENGTH_UNITS(_setup.length_units);
   GET_EXTERNAL_PARAMETER_FILE_NAME(filename, LINELEN);
   if (filename[0] == 0)
@@ -1405,18 +1418,19 @@ int Interp::open(const char *filename) //!< string: the name of the input NC-pro
     }
   CHKS((_setup.file_pointer != NULL), NCE_A_FILE_IS_ALREADY_OPEN);
   CHKS((strlen(filename) > (LINELEN - 1)), NCE_FILE_NAME_TOO_LONG);
-  _setup.file_pointer = fopen(filename, "r");
+  _setup.file_pointer = InterpFile::open(filename);
   CHKS((_setup.file_pointer == NULL), NCE_UNABLE_TO_OPEN_FILE, filename);
+  _setup.block_cache->rewind();
 
 	Interp::nurbs_reset_global_variables();	// jf 
 
   line = _setup.linetext;
   for (index = -1; index == -1;) {      /* skip blank lines */
-    CHKS((fgets(line, LINELEN, _setup.file_pointer) ==
+    CHKS((_setup.file_pointer->read_line(line, LINELEN) ==
          NULL), NCE_FILE_ENDED_WITH_NO_PERCENT_SIGN);
     length = strlen(line);
     if (length == (LINELEN - 1)) {   // line is too long. need to finish reading the line to recover
-      for (; fgetc(_setup.file_pointer) != '\n' && !feof(_setup.file_pointer););
+      _setup.file_pointer->skip_line();
       ERS(NCE_COMMAND_TOO_LONG);
     }
     for (index = (length - 1);  // index set on last char
@@ -1429,12 +1443,12 @@ int Interp::open(const char *filename) //!< string: the name of the input NC-pro
       _setup.sequence_number = 1;       // We have already read the first line
       // and we are not going back to it.
     } else {
-      fseek(_setup.file_pointer, 0, SEEK_SET);
+      _setup.file_pointer->seek(0);
       _setup.percent_flag = false;
       _setup.sequence_number = 0;       // Going back to line 0
     }
   } else {
-    fseek(_setup.file_pointer, 0, SEEK_SET);
+    _setup.file_pointer->seek(0);
     _setup.percent_flag = false;
     _setup.sequence_number = 0; // Going back to line 0
   }
@@ -1635,7 +1649,7 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
 
   if(_setup.file_pointer)
   {
-      EXECUTING_BLOCK(_setup).offset = ftell(_setup.file_pointer);
+      EXECUTING_BLOCK(_setup).offset = _setup.file_pointer->tell();
   }
 
   read_status =
@@ -1720,13 +1734,14 @@ int Interp::unwind_call(int status, const char *file, int line, const char *func
 	// needed to make sure this works in rs274 -n 0 (continue on error) mode
 	if (sub->filename && sub->filename[0]) {
 	    if(0 != strcmp(_setup.filename, sub->filename)) {
-		fclose(_setup.file_pointer);
-		_setup.file_pointer = fopen(sub->filename, "r");
+		delete _setup.file_pointer;
+		_setup.file_pointer = InterpFile::open(sub->filename);
 		logDebug("unwind_call: reopening '%s' at %ld",
 			 sub->filename, sub->position);
 		rtapi_strxcpy(_setup.filename, sub->filename);
 	    }
-	    fseek(_setup.file_pointer, sub->position, SEEK_SET);
+	    if (_setup.file_pointer)
+		_setup.file_pointer->seek(sub->position);
 	}
 	_setup.sequence_number = sub->sequence_number;
 	logDebug("unwind_call: setting sequence number=%d from frame %d",
@@ -2699,14 +2714,44 @@ int Interp::on_abort(int reason, const char *message)
 // 2) tries adding the INI defined program prefix to path
 // 3) tries adding the INI defined subroutine prefix to path
 // 4) tries adding the INI defined whizard prefix to path
-FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *foundhere )
+// The result is kept in the subroutine cache until a directory searched
+// on the way to it changes.
+InterpFile *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *foundhere )
 {
-    FILE *newFP = NULL;
+    InterpFile *newFP = NULL;
     char tmpFileName[PATH_MAX+1];
     char newFileName[PATH_MAX+1];
     char foundPlace[PATH_MAX+1];
     int  dct;
     wordexp_t exp_result;
+    SubroutineCache &cache = SubroutineCache::instance();
+    std::vector<std::string> dirs;    // searched so far, in order
+    bool cacheable = true;
+
+    // the search depends on the name and the search path
+    std::string key(basename);
+    key += '\0';
+    key += settings->program_prefix;
+    for (dct = 0; dct < MAX_SUB_DIRS; dct++) {
+        key += '\0';
+        if (settings->subroutines[dct])
+            key += settings->subroutines[dct];
+    }
+    key += '\0';
+    key += settings->wizard_root;
+
+    std::string cached;
+    if (cache.find_path(key, cached)) {
+        if (cached.empty())
+            return NULL;
+        newFP = InterpFile::open(cached.c_str());
+        if (newFP) {
+            if (foundhere)
+                strcpy(foundhere, cached.c_str());
+            return newFP;
+        }
+        // gone without its directory changing; search again
+    }
 
     // #1 check if this is the full path already
 
@@ -2720,7 +2765,12 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
 
     // found a file we can open?
     if (chk < sizeof(newFileName)){
-        newFP = fopen(newFileName, "r");
+        const char *slash = strrchr(newFileName, '/');
+        if (!slash)
+            dirs.push_back(".");
+        else
+            dirs.push_back(std::string(newFileName, slash == newFileName ? 1 : slash - newFileName));
+        newFP = InterpFile::open(newFileName);
     }
 
     // #2 then look in the program_prefix place
@@ -2732,7 +2782,8 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
 
          // found a file we can open?
         if (chk < sizeof(newFileName)){
-            newFP = fopen(newFileName, "r");
+            dirs.push_back(exp_result.we_wordc ? exp_result.we_wordv[0] : "");
+            newFP = InterpFile::open(newFileName);
         }
     }
     
@@ -2748,7 +2799,8 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
 
             // found a file we can open?
             if (chk <  sizeof(newFileName)){
-                newFP = fopen(newFileName, "r");
+                dirs.push_back(exp_result.we_wordc ? exp_result.we_wordv[0] : "");
+                newFP = InterpFile::open(newFileName);
                 if (newFP) {
                 // logOword("fopen: |%s|", newFileName);
                 break; // use first occurrence in dir search
@@ -2762,6 +2814,10 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
     if (!newFP) {
         int ret;
 
+        // a whole tree can't be watched for changes
+        if (settings->wizard_root[0])
+            cacheable = false;
+
         // walks the directory hierarchy ? 
         ret = findFile(settings->wizard_root, tmpFileName, foundPlace);
 
@@ -2772,11 +2828,14 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
 
             // found a file we can open?
             if (chk < sizeof(newFileName)){
-            newFP = fopen(newFileName, "r");
+            newFP = InterpFile::open(newFileName);
             }
         }
     }
 
+    if (cacheable)
+        cache.store_path(key, dirs, newFP ? newFileName : "");
+
     // pass what we found
     if (foundhere && (newFP != NULL)) 
         strcpy(foundhere, newFileName);
@@ -2810,5 +2869,9 @@ context_struct::context_struct()
 
 void context_struct::clear()
 {
+    // the frame's parameter storage is reused by the next call
+    parameter_map params(std::move(named_params));
     new (this) context_struct();
+    named_params = std::move(params);
+    named_params.clear();
 }
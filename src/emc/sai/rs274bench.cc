@@ -0,0 +1,306 @@
+/********************************************************************
+* Description: rs274bench.cc
+*   Measures interpreter throughput without task or motion.
+*
+*   Runs programs through the interpreter with the same canon stubs
+*   as rs274, but with their printing turned off, and reports how many
+*   lines and canon calls the interpreter handles per second, how many
+*   heap allocations it makes per line and how much memory it needs.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include "rs274ngc/rs274ngc.hh"
+#include "rs274ngc/rs274ngc_interp.hh"
+#include "rs274ngc/rs274ngc_return.hh"
+#include <inifile.hh>
+#include "nml_intf/canon.hh"		// _parameter_file_name
+#include "config.h"		// LINELEN
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <new>
+
+#include "saicanon.hh"
+#include "tooldata/tooldata.hh"
+
+using namespace linuxcnc;
+
+InterpBase *pinterp;
+int _task = 0; // control preview behaviour when remapping
+
+/*
+Every allocation made with new, which is nearly all the interpreter
+makes, is counted here.  The sizes are taken from malloc so that the
+heap in use and its high water mark can be followed too.  They are
+kept out of line, so that g++ doesn't see free() called on memory from
+a new expression and warn about the mismatch.
+*/
+
+static struct {
+    unsigned long count;
+    size_t in_use;
+    size_t peak;
+} heap;
+
+__attribute__((__noinline__)) void *operator new(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    heap.count++;
+    heap.in_use += malloc_usable_size(p);
+    if (heap.in_use > heap.peak)
+        heap.peak = heap.in_use;
+    return p;
+}
+
+__attribute__((__noinline__)) void operator delete(void *p) noexcept
+{
+    if (!p)
+        return;
+    heap.in_use -= malloc_usable_size(p);
+    free(p);
+}
+
+__attribute__((__noinline__)) void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+struct bench_result {
+    long lines;         // blocks read, each pass of a loop counted again
+    long calls;         // canon calls
+    unsigned long allocs;
+    size_t peak;        // heap high water mark above the heap at start
+    double seconds;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report_error(int status)
+{
+    char text[LINELEN];
+
+    pinterp->error_text(status, text, LINELEN);
+    fprintf(stderr, "%s\n", text[0] ? text : "Unknown error, bad error code");
+    pinterp->line_text(text, LINELEN);
+    fprintf(stderr, "%s\n", text);
+}
+
+/* run_program
+
+Returned Value: int
+  0 if the program ran to its end, 1 after an error, which is reported
+  on stderr.
+
+Runs filename through the interpreter passes times, as task would in
+auto mode but without waiting for anything, and adds what it measured
+to result.  The interpreter must be initialized.
+*/
+
+static int run_program(const char *filename, int passes, bench_result *result)
+{
+    int status;
+
+    for (int pass = 0; pass < passes; pass++) {
+        long calls = _sai._line_number;
+        unsigned long allocs = heap.count;
+        size_t base = heap.in_use;
+        double start;
+
+        heap.peak = heap.in_use;
+        start = now();
+        status = pinterp->open(filename);
+        if (status != INTERP_OK) {
+            report_error(status);
+            return 1;
+        }
+        for (;;) {
+            status = pinterp->read();
+            if (status == INTERP_ENDFILE)
+                break;
+            if (status != INTERP_OK && status != INTERP_EXECUTE_FINISH) {
+                report_error(status);
+                pinterp->close();
+                return 1;
+            }
+            result->lines++;
+            status = pinterp->execute();
+            if (status == INTERP_EXIT)
+                break;
+            if (status != INTERP_OK && status != INTERP_EXECUTE_FINISH) {
+                report_error(status);
+                pinterp->close();
+                return 1;
+            }
+        }
+        pinterp->close();
+        result->seconds += now() - start;
+        result->calls += _sai._line_number - calls;
+        result->allocs += heap.count - allocs;
+        if (heap.peak - base > result->peak)
+            result->peak = heap.peak - base;
+    }
+    return 0;
+}
+
+static void print_header(void)
+{
+    printf("%-32s %9s %9s %9s %11s %11s %11s %9s\n",
+           "program", "lines", "calls", "seconds", "lines/s", "calls/s",
+           "allocs/line", "heap kB");
+}
+
+static void print_result(const char *name, const bench_result *r)
+{
+    const char *base = strrchr(name, '/');
+    double seconds = r->seconds > 0 ? r->seconds : 1e-9;
+
+    printf("%-32.32s %9ld %9ld %9.3f %11.0f %11.0f %11.2f %9.0f\n",
+           base ? base + 1 : name, r->lines, r->calls, r->seconds,
+           r->lines / seconds, r->calls / seconds,
+           r->lines ? (double) r->allocs / r->lines : 0.0,
+           r->peak / 1024.0);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-i ini] [-t tool.tbl] [-v var-file.var] [-n passes]\n"
+            "          [-T] file...\n"
+            "\n"
+            "    -i: specify the INI file (default: no INI file)\n"
+            "    -t: specify the .tbl (tool table) file to use\n"
+            "    -v: specify the .var (parameter) file to use\n"
+            "    -n: run each file this many times (default: 1)\n"
+            "    -T: remap as task does, not as a preview\n"
+            , name);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    char default_name[] = "/etc/emc2/sample-configs/sim/sim.var";
+    const char *tool_file = EMC2_DEFAULT_TOOLTABLE;
+    char *inifile = NULL;
+    int passes = 1;
+    int failed = 0;
+    bench_result total = bench_result();
+    struct rusage usage_self;
+
+    SET_PARAMETER_FILE_NAME(default_name);
+
+#ifdef TOOL_NML //{
+    tool_nml_register((CANON_TOOL_TABLE*)& _sai._tools);
+#else //}{
+    // as rs274 does, use a private tool mmap rather than the live one
+    char sai_mmap_fname[LINELEN];
+    const char *tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !*tmpdir) tmpdir = "/tmp";
+    snprintf(sai_mmap_fname, sizeof(sai_mmap_fname),
+             "%s/rs274bench.tool.mmap.XXXXXX", tmpdir);
+    int sai_fd = mkstemp(sai_mmap_fname);
+    if (sai_fd < 0) {
+        perror("rs274bench: mkstemp for the tool mmap failed");
+        exit(EXIT_FAILURE);
+    }
+    close(sai_fd);
+    tool_mmap_set_fname(sai_mmap_fname);
+    tool_mmap_creator((EMC_TOOL_STAT*)NULL, 0);
+    atexit(tool_mmap_close);  // tool_mmap_close() unlinks the file
+#endif //}
+
+    for (;;) {
+        int c = getopt(argc, argv, "i:t:v:n:T");
+        if (c == -1) break;
+
+        switch (c) {
+        case 'i': inifile = optarg; break;
+        case 't': tool_file = optarg; break;
+        case 'v': SET_PARAMETER_FILE_NAME(optarg); break;
+        case 'n': passes = atoi(optarg); break;
+        case 'T': _task = 1; break;
+        case '?': default: usage(argv[0]);
+        }
+    }
+    if (optind == argc || passes < 1)
+        usage(argv[0]);
+
+    if (tooldata_load(tool_file) != 0)
+        exit(1);
+
+    _sai._external_length_units = 0.03937007874016;
+    if (inifile != NULL) {
+        IniFile ini(inifile);
+        if (!ini) {
+            fprintf(stderr, "could not open supplied INI file %s\n", inifile);
+            exit(1);
+        }
+        if (auto inistring = ini.findString("LINEAR_UNITS", "TRAJ")) {
+            if (*inistring == "mm")
+                _sai._external_length_units = 1.0;
+        }
+        setenv("INI_FILE_NAME", inifile, 1);
+    } else
+        unsetenv("INI_FILE_NAME");
+
+    // count the canon calls only
+    _outfile = NULL;
+    pinterp = new Interp;
+
+    print_header();
+    for (int i = optind; i < argc; i++) {
+        bench_result result = bench_result();
+        int status;
+
+        // each program starts from a freshly initialized interpreter
+        if ((status = pinterp->init()) != INTERP_OK) {
+            report_error(status);
+            exit(1);
+        }
+        if (run_program(argv[i], passes, &result) != 0) {
+            fprintf(stderr, "%s: failed\n", argv[i]);
+            failed = 1;
+            continue;
+        }
+        print_result(argv[i], &result);
+        total.lines += result.lines;
+        total.calls += result.calls;
+        total.allocs += result.allocs;
+        total.seconds += result.seconds;
+        if (result.peak > total.peak)
+            total.peak = result.peak;
+    }
+    if (argc - optind > 1)
+        print_result("total", &total);
+    getrusage(RUSAGE_SELF, &usage_self);
+    printf("peak resident set: %ld kB\n", usage_self.ru_maxrss);
+
+    pinterp->exit();
+    return failed;
+}
+
+/***********************************************************************/
+
+int emcOperatorError(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    return 0;
+}
@@ -48,7 +48,7 @@ StandaloneInterpInternals _sai = StandaloneInterpInternals();
 
 char               _parameter_file_name[PARAMETER_FILE_NAME_LENGTH];
 
-/* where to print */
+/* where to print; NULL only counts the calls, see rs274bench */
 FILE * _outfile = stdout;      /* where to print, set in main */
 static bool fo_enable=true, so_enable=true;
 
@@ -101,6 +101,10 @@ void print_nc_line_number()
 
 #define PRINT(control, ...) do \
 { \
+    if (!_outfile) { \
+        _sai._line_number++; \
+        break; \
+    } \
     fprintf(_outfile,  "%5d ", _sai._line_number++); \
     print_nc_line_number(); \
     fprintf(_outfile, control, ##__VA_ARGS__); \
@@ -325,8 +329,10 @@ void NURBS_G5_FEED(int /*lineno*/, const std::vector<NURBS_CONTROL_POINT>& nurbs
 /* Machining Functions G_6_2 */
 void NURBS_G6_FEED(int /*lineno*/, const std::vector<NURBS_G6_CONTROL_POINT>& nurbs_control_points, unsigned int /*k*/, double /*feedrate*/, int /*l*/, CANON_PLANE /*plane*/) {
   //fprintf(_outfile, "%5d ", _line_number++);
-  print_nc_line_number();
-  fprintf(_outfile, "saicanon NURBS_G6_FEED_(%lu, ...)\n", (unsigned long)nurbs_control_points.size());
+  if (_outfile) {
+    print_nc_line_number();
+    fprintf(_outfile, "saicanon NURBS_G6_FEED_(%lu, ...)\n", (unsigned long)nurbs_control_points.size());
+  }
 
   _sai._program_position_x = nurbs_control_points[nurbs_control_points.size()-1].NURBS_X;
   _sai._program_position_y = nurbs_control_points[nurbs_control_points.size()-1].NURBS_Y;
@@ -155,7 +155,7 @@ static void flush_segments(void);
  * Note that the append function takes the message by reference, so this also
  * needs to have the message passed in by reference or it barfs.
  */
-static inline void tag_and_send(std::unique_ptr<EMC_TRAJ_CMD_MSG> &&msg, StateTag const &tag) {
+static inline void tag_and_send(NML_INTERP_PTR<EMC_TRAJ_CMD_MSG> &&msg, StateTag const &tag) {
     msg->tag = tag;
     interp_list.append(std::move(msg));
 }
@@ -1089,7 +1089,7 @@ static void flush_segments(void) {
     }
 
 
-    auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+    auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
     linearMoveMsg->feed_mode = canon.feed_mode;
 
     // now x, y, z, and b are in absolute mm or degree units
@@ -1214,7 +1214,7 @@ void generate_fast_move(double x, double y, double z,
                               double a, double b, double c,
                               double u, double v, double w)
 {
-	auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+	auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
 	linearMoveMsg->feed_mode = canon.feed_mode;;
 
     flush_segments();
@@ -1250,7 +1250,7 @@ void generate_move(double vel,double x, double y, double z,
                               double a, double b, double c,
                               double u, double v, double w)
 {
-	auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+	auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
 	 linearMoveMsg->feed_mode = canon.feed_mode;
 	flush_segments();
 
@@ -1290,7 +1290,7 @@ void STRAIGHT_TRAVERSE(int line_number,
 
     flush_segments();
 
-    auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+    auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
 
     linearMoveMsg->feed_mode = 0;
     if (canon.rotary_unlock_for_traverse != -1)
@@ -2581,8 +2581,8 @@ void ARC_FEED(int line_number,
 				double u, double v, double w)
 {
 
-	auto circularMoveMsg = std::make_unique<EMC_TRAJ_CIRCULAR_MOVE>();
-	auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+	auto circularMoveMsg = interp_list.make<EMC_TRAJ_CIRCULAR_MOVE>();
+	auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
 
 	canon_debug("line = %d\n", line_number);
 	canon_debug("first_end = %f, second_end = %f\n", first_end,second_end);
@@ -3180,7 +3180,7 @@ void CHANGE_TOOL()
         vel = veldata.vel;
         acc = accdata.acc;
 
-        auto linearMoveMsg = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+        auto linearMoveMsg = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
         linearMoveMsg->feed_mode = canon.feed_mode;
 
         linearMoveMsg->end = to_ext_pose(x, y, z, a, b, c, u, v, w);
@@ -4338,7 +4338,7 @@ int WAIT(int index, /* index of the motion exported input */
 
 int UNLOCK_ROTARY(int line_number, int joint_num)
 {
-    auto m = std::make_unique<EMC_TRAJ_LINEAR_MOVE>();
+    auto m = interp_list.make<EMC_TRAJ_LINEAR_MOVE>();
 
     // first, set up a zero length move to interrupt blending and get to final position
     m->type = EMC_MOTION_TYPE_TRAVERSE;
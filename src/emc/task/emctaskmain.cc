@@ -131,7 +131,7 @@ static double taskExecDelayTimeout = 0.0;
 static int emcTaskIssueCommand(NMLmsg * cmd);
 
 // pending command to be sent out by emcTaskExecute()
-std::unique_ptr<NMLmsg> emcTaskCommand;
+NML_INTERP_PTR<NMLmsg> emcTaskCommand;
 
 // signal handling code to stop main loop
 volatile int done;
@@ -1619,7 +1619,7 @@ static EMC_TASK_EXEC emcTaskCheckPreconditions(NMLmsg * cmd)
 }
 
 // puts command on interp list
-int emcTaskQueueCommand(std::unique_ptr<NMLmsg> &&cmd)
+int emcTaskQueueCommand(NML_INTERP_PTR<NMLmsg> &&cmd)
 {
     if (nullptr == cmd) {
 	return 0;
@@ -3523,6 +3523,14 @@ int main(int argc, char *argv[])
             }
         }
 
+	if (!emcTaskEager) {
+	    // moves are sent to motion in batches; with nothing more to
+	    // do this cycle, send what there is
+	    if (0 != emcTrajFlushMoves()) {
+		emcStatus->task.execState = EMC_TASK_EXEC::ERROR;
+	    }
+	}
+
 	if ((emcTaskNoDelay) || (emcTaskEager)) {
 	    emcTaskEager = 0;
 	} else {
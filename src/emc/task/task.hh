@@ -17,12 +17,13 @@
 #define EMC_TASK_HH
 #include "taskclass.hh"
 #include "nml_intf/emc_nml.hh"
+#include "nml_intf/interpl.hh"
 #include <memory>
 
-extern std::unique_ptr<NMLmsg> emcTaskCommand;
+extern NML_INTERP_PTR<NMLmsg> emcTaskCommand;
 extern int stepping;
 extern int steppingWait;
-extern int emcTaskQueueCommand(std::unique_ptr<NMLmsg> &&cmd);
+extern int emcTaskQueueCommand(NML_INTERP_PTR<NMLmsg> &&cmd);
 extern int emcTaskOnce(const char *inifile, EMC_IO_STAT &emcioStatus);
 
 // Returns 0 if all joints are homed, 1 if any joints are un-homed.
@@ -1536,20 +1536,21 @@ int emcTrajLinearMove(const EmcPose& end, int type, double vel, double ini_maxve
     }
 #endif
 
-    emcmotCommand.command = EMCMOT_SET_LINE;
+    emcmot_segment_t seg;
 
-    emcmotCommand.pos = end;
+    seg.circle = 0;
+    seg.pos = end;
 
-    emcmotCommand.id = TrajConfig.MotionId;
-    emcmotCommand.tag = localEmcTrajTag;
-    emcmotCommand.motion_type = type;
-    emcmotCommand.vel = vel;
-    emcmotCommand.ini_maxvel = ini_maxvel;
-    emcmotCommand.acc = acc;
-    emcmotCommand.ini_maxjerk = ini_maxjerk;
-    emcmotCommand.turn = indexer_jnum;
+    seg.id = TrajConfig.MotionId;
+    seg.spindle = emcmotCommand.spindle;
+    seg.motion_type = type;
+    seg.vel = vel;
+    seg.ini_maxvel = ini_maxvel;
+    seg.acc = acc;
+    seg.ini_maxjerk = ini_maxjerk;
+    seg.turn = indexer_jnum;
 
-    return usrmotWriteEmcmotCommand(&emcmotCommand);
+    return usrmotQueueEmcmotMove(&seg, &localEmcTrajTag);
 }
 
 int emcTrajCircularMove(const EmcPose& end, const PM_CARTESIAN& center,
@@ -1566,29 +1567,35 @@ int emcTrajCircularMove(const EmcPose& end, const PM_CARTESIAN& center,
     }
 #endif
 
-    emcmotCommand.command = EMCMOT_SET_CIRCLE;
+    emcmot_segment_t seg;
 
-    emcmotCommand.pos = end;
-    emcmotCommand.motion_type = type;
+    seg.circle = 1;
+    seg.pos = end;
+    seg.motion_type = type;
 
-    emcmotCommand.center.x = center.x;
-    emcmotCommand.center.y = center.y;
-    emcmotCommand.center.z = center.z;
+    seg.center.x = center.x;
+    seg.center.y = center.y;
+    seg.center.z = center.z;
 
-    emcmotCommand.normal.x = normal.x;
-    emcmotCommand.normal.y = normal.y;
-    emcmotCommand.normal.z = normal.z;
+    seg.normal.x = normal.x;
+    seg.normal.y = normal.y;
+    seg.normal.z = normal.z;
 
-    emcmotCommand.turn = turn;
-    emcmotCommand.id = TrajConfig.MotionId;
-    emcmotCommand.tag = localEmcTrajTag;
+    seg.turn = turn;
+    seg.id = TrajConfig.MotionId;
+    seg.spindle = emcmotCommand.spindle;
 
-    emcmotCommand.vel = vel;
-    emcmotCommand.ini_maxvel = ini_maxvel;
-    emcmotCommand.acc = acc;
-    emcmotCommand.ini_maxjerk = ini_maxjerk;
+    seg.vel = vel;
+    seg.ini_maxvel = ini_maxvel;
+    seg.acc = acc;
+    seg.ini_maxjerk = ini_maxjerk;
 
-    return usrmotWriteEmcmotCommand(&emcmotCommand);
+    return usrmotQueueEmcmotMove(&seg, &localEmcTrajTag);
+}
+
+int emcTrajFlushMoves()
+{
+    return usrmotFlushEmcmotMoves();
 }
 
 int emcTrajClearProbeTrippedFlag()
@@ -1654,6 +1661,7 @@ static double last_id_time;
 int emcTrajUpdate(EMC_TRAJ_STAT * stat)
 {
     int joint, enables;
+    int pending;
 
     stat->joints = TrajConfig.Joints;
     stat->spindles = TrajConfig.Spindles;
@@ -1684,9 +1692,14 @@ int emcTrajUpdate(EMC_TRAJ_STAT * stat)
     }
 
     stat->inpos = emcmotStatus.motionFlag & EMCMOT_MOTION_INPOS_BIT;
-    stat->queue = emcmotStatus.depth;
+    // moves task has queued that motion hasn't taken yet count too, and
+    // each may take two places in the motion queue once it adds a blend
+    // arc before it
+    pending = usrmotPendingEmcmotMoves(&emcmotStatus);
+    stat->queue = emcmotStatus.depth + pending;
     stat->activeQueue = emcmotStatus.activeDepth;
-    stat->queueFull = emcmotStatus.queueFull;
+    stat->queueFull = emcmotStatus.queueFull ||
+	2 * pending >= emcmotStatus.queueSpace;
     stat->id = emcmotStatus.id;
     StateTag newtag(emcmotStatus.tag);
     //TODO assignment operator
@@ -1721,6 +1734,10 @@ int emcTrajUpdate(EMC_TRAJ_STAT * stat)
 
     if (emcmotStatus.motionFlag & EMCMOT_MOTION_ERROR_BIT) {
 	stat->status = RCS_STATUS::ERROR;
+    } else if (stat->queue == 0 && usrmotQueuedMoveFailed(&emcmotStatus)) {
+	// a failed move with none queued after it to report it, e.g. the
+	// last one of a program, must not look like the program finished
+	stat->status = RCS_STATUS::ERROR;
     } else if (stat->inpos && (stat->queue == 0)) {
 	stat->status = RCS_STATUS::DONE;
     } else {
@@ -63,7 +63,6 @@ int tcqCreate(TC_QUEUE_STRUCT * const tcq, int _size, TC_STRUCT * const tcSpace)
  * This function creates deletes a queue. It doesn't free the space
  * only throws the pointer away.
  * It gets called by tpDelete()
- * \todo FIXME, it seems tpDelete() is gone, and this function isn't used.
  *
  * @param    tcq       pointer to the TC_QUEUE_STRUCT
  *
@@ -330,6 +329,38 @@ int tcqFull(TC_QUEUE_STRUCT const * const tcq)
     return 0;
 }
 
+/*! tcqSpace() function
+ *
+ * \brief get how many more TC elements fit before the queue is full
+ * Function returns the number of elements that can still be put in the
+ * queue before tcqFull() reports it full
+ *
+ * Function called by update_status() in control.c
+ *
+ * @param    tcq       pointer to the TC_QUEUE_STRUCT
+ *
+ * @return	 int       returns number of elements, 0 if full
+ */
+int tcqSpace(TC_QUEUE_STRUCT const * const tcq)
+{
+    int limit;
+
+    if (tcqCheck(tcq) || tcq->allFull) {
+	   return 0;
+    }
+
+    /* same limit as tcqFull() */
+    limit = tcq->size;
+    if (tcq->size > TC_QUEUE_MARGIN) {
+	    limit -= TC_QUEUE_MARGIN;
+    }
+
+    if (tcq->_len >= limit) {
+	    return 0;
+    }
+    return limit - tcq->_len;
+}
+
 /*! tcqLast() function
  *
  * \brief gets the last TC element in the queue, without removing it
@@ -72,4 +72,7 @@ extern TC_STRUCT * tcqLast(TC_QUEUE_STRUCT const * const tcq);
 /* get full status */
 extern int tcqFull(TC_QUEUE_STRUCT const * const tcq);
 
+/* get how many more items fit before full */
+extern int tcqSpace(TC_QUEUE_STRUCT const * const tcq);
+
 #endif
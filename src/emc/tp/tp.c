@@ -12,6 +12,7 @@
 ********************************************************************/
 #include <rtapi.h>              /* rtapi_print_msg */
 #include <rtapi_math.h>
+#include <rtapi_slab.h>
 #include <posemath.h>           /* Geometry types & functions */
 #include <emcpose.h>
 #include <motion_types.h>
@@ -362,9 +363,9 @@ STATIC inline double tpGetSignedSpindlePosition(spindle_status_t *status) {
  * @section tpaccess tp class-like API
  */
 
-/* space for trajectory planner queues, plus 10 more for safety */
-/*! \todo FIXME-- default is used; dynamic is not honored */
-	TC_STRUCT queueTcSpace[DEFAULT_TC_QUEUE_SIZE + 10];
+/* space for trajectory planner queues, plus 10 more for safety. Allocated
+ * once by tpCreate() so the queue size can be chosen at load time. */
+static TC_STRUCT *queueTcSpace = 0;
 
 /**
  * Create the trajectory planner structure with an empty queue.
@@ -382,10 +383,22 @@ int tpCreate(TP_STRUCT * const tp, int _queueSize,int id)
     } else {
         tp->queueSize = _queueSize;
     }
-    TC_STRUCT * const tcSpace = queueTcSpace;
+
+    if (queueTcSpace) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "tpCreate: queue already allocated\n");
+        return TP_ERR_FAIL;
+    }
+    /* a big queue is more than kmalloc can give in a kernel module */
+    queueTcSpace = rtapi_vzalloc((tp->queueSize + 10) * sizeof(TC_STRUCT));
+    if (!queueTcSpace) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "tpCreate: failed to allocate queue of %d segments\n",
+                tp->queueSize);
+        return TP_ERR_FAIL;
+    }
 
     /* create the queue */
-    if (-1 == tcqCreate(&tp->queue, tp->queueSize, tcSpace)) {
+    if (-1 == tcqCreate(&tp->queue, tp->queueSize, queueTcSpace)) {
+        tpDelete(tp);
         return TP_ERR_FAIL;
     }
 
@@ -393,6 +406,24 @@ int tpCreate(TP_STRUCT * const tp, int _queueSize,int id)
     return tpInit(tp);
 }
 
+/**
+ * Release the queue space allocated by tpCreate().
+ * Must only be called once the thread running tpRunCycle() has stopped.
+ */
+int tpDelete(TP_STRUCT * const tp)
+{
+    if (0 == tp) {
+        return TP_ERR_FAIL;
+    }
+
+    tcqDelete(&tp->queue);
+    if (queueTcSpace) {
+        rtapi_vfree(queueTcSpace);
+        queueTcSpace = 0;
+    }
+    return TP_ERR_OK;
+}
+
 /**
  * Clears any potential DIO toggles and anychanged.
  * If any DIOs need to be changed: dios[i] = 1, DIO needs to get turned on, -1
@@ -1785,9 +1816,15 @@ STATIC int tpComputeOptimalVelocity(TP_STRUCT const * const tp, TC_STRUCT * cons
  * Do "rising tide" optimization to find allowable final velocities for each queued segment.
  * Walk along the queue from the back to the front. Based on the "current"
  * segment's final velocity, calculate the previous segment's maximum allowable
- * final velocity. The depth we walk along the queue is controlled by the
- * TP_LOOKAHEAD_DEPTH constant for now. The process safely aborts early due to
- * a short queue or other conflicts.
+ * final velocity. The depth we walk along the queue is controlled by
+ * [TRAJ]ARC_BLEND_OPTIMIZATION_DEPTH, and is bounded by the queue length. The
+ * process safely aborts early due to a short queue or other conflicts.
+ *
+ * The pass is incremental: the final velocity of a segment depends only on
+ * the final velocity of the segment after it, so once a re-computed final
+ * velocity comes out unchanged, every segment before it is already optimal
+ * and the walk stops there. This keeps the cost of adding a segment bounded
+ * even with a lookahead depth of thousands of segments.
  */
 STATIC int tpRunOptimization(TP_STRUCT * const tp) {
     // Pointers to the "current", previous, and 2nd previous trajectory
@@ -1799,7 +1836,6 @@ STATIC int tpRunOptimization(TP_STRUCT * const tp) {
 
     int ind, x;
     int len = tcqLen(&tp->queue);
-    //TODO make lookahead depth configurable from the INI file
 
     int hit_peaks = 0;
     // Flag that says we've hit at least 1 non-tangent segment
@@ -1880,7 +1916,18 @@ STATIC int tpRunOptimization(TP_STRUCT * const tp) {
             }
             tc->finalvel = 0.0;
         } else {
+            double prev_finalvel = prev1_tc->finalvel;
             tpComputeOptimalVelocity(tp, tc, prev1_tc);
+
+            // The last two segments change whenever a new one is queued
+            // (finalizing, blend arcs), beyond that an unchanged final
+            // velocity means the rest of the queue is already optimal.
+            if (x > 2 && fabs(prev1_tc->finalvel - prev_finalvel) < TP_VEL_EPSILON) {
+                tc->active_depth = x - 2 - hit_peaks;
+                tp_debug_print("Final velocity of segment %d unchanged, stopping optimization at step %d\n",
+                        prev1_tc->id, x);
+                return TP_ERR_OK;
+            }
         }
 
         tc->active_depth = x - 2 - hit_peaks;
@@ -4346,6 +4393,7 @@ int tpIsMoving(TP_STRUCT const * const tp)
     return false;
 }
 
+#ifdef RTAPI
 // api: functions called by motion:
 EXPORT_SYMBOL(tpMotFunctions);
 EXPORT_SYMBOL(tpMotData);
@@ -4357,6 +4405,7 @@ EXPORT_SYMBOL(tpAddLine);
 EXPORT_SYMBOL(tpAddRigidTap);
 EXPORT_SYMBOL(tpClear);
 EXPORT_SYMBOL(tpCreate);
+EXPORT_SYMBOL(tpDelete);
 EXPORT_SYMBOL(tpGetExecId);
 EXPORT_SYMBOL(tpGetExecTag);
 EXPORT_SYMBOL(tpGetMotionType);
@@ -4379,3 +4428,6 @@ EXPORT_SYMBOL(tpSetVlimit);
 EXPORT_SYMBOL(tpSetVmax);
 
 EXPORT_SYMBOL(tcqFull);
+EXPORT_SYMBOL(tcqLen);
+EXPORT_SYMBOL(tcqSpace);
+#endif
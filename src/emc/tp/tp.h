@@ -31,6 +31,7 @@ int tpInit(TP_STRUCT * const tp);
 
 // functions used by motmod:
 int tpCreate(TP_STRUCT * const tp, int _queueSize,int id);
+int tpDelete(TP_STRUCT * const tp);
 int tpClear(TP_STRUCT * const tp);
 int tpClearDIOs(TP_STRUCT * const tp);
 int tpSetCycleTime(TP_STRUCT * tp, double secs);
@@ -0,0 +1,535 @@
+//
+// tpbench: measure trajectory planner throughput without a machine
+//
+// Feeds a stream of line and arc segments through tpAddLine() and
+// tpAddCircle() into a TP_STRUCT and steps tpRunCycle() at a fixed
+// period, the same way motmod does, but as fast as the host allows.
+// Reports how fast segments can be queued (including the lookahead
+// optimization done on every add), how long each cycle takes, and how
+// the achieved average feed compares to the programmed feed.
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <rtapi.h>
+#include <posemath.h>
+#include <emcpose.h>
+#include <motion_types.h>
+#include "motion/motion.h"
+#include "nml_intf/emcmotcfg.h"
+#include "tp.h"
+#include "tcq.h"
+
+typedef struct {
+    int type;                   // EMC_MOTION_TYPE_*
+    EmcPose end;
+    PmCartesian center;         // arcs only
+    int turn;                   // arcs only, as in EMC_TRAJ_CIRCULAR_MOVE
+    double vel;                 // programmed speed, units/s
+    double length;
+} bench_seg_t;
+
+typedef struct {
+    bench_seg_t *seg;
+    int count;
+    int alloc;
+} bench_prog_t;
+
+typedef struct {
+    long *ns;
+    long count;
+    long alloc;
+} bench_times_t;
+
+static struct {
+    double period;              // seconds
+    double vmax;
+    double amax;
+    double jerk;
+    double feed;                // units/s
+    double seglen;
+    double tolerance;
+    int planner;
+    int queue;
+    int depth;
+    int per_cycle;
+    int count;
+    const char *pattern;
+} opt = {
+    .period = 0.001,
+    .vmax = 100.0,
+    .amax = 1000.0,
+    .jerk = 10000.0,
+    .feed = 50.0,
+    .seglen = 0.5,
+    .tolerance = 0.0,
+    .planner = 0,
+    .queue = DEFAULT_TC_QUEUE_SIZE,
+    .depth = 50,
+    .per_cycle = 1,
+    .count = 10000,
+    .pattern = "sine",
+};
+
+static emcmot_status_t status;
+static emcmot_config_t config;
+static TP_STRUCT tp;
+
+/* motmod hooks; there is no I/O and every axis has the TRAJ limits */
+static void bench_dio_write(int index, char value) { (void)index; (void)value; }
+static void bench_aio_write(int index, double value) { (void)index; (void)value; }
+static void bench_set_rotary_unlock(int axis, int unlock) { (void)axis; (void)unlock; }
+static int bench_get_rotary_unlocked(int axis) { (void)axis; return 1; }
+static double bench_axis_vel_limit(int axis) { (void)axis; return opt.vmax; }
+static double bench_axis_acc_limit(int axis) { (void)axis; return opt.amax; }
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void times_add(bench_times_t *t, long ns)
+{
+    if (t->count == t->alloc) {
+        t->alloc = t->alloc ? 2 * t->alloc : 65536;
+        t->ns = realloc(t->ns, t->alloc * sizeof(*t->ns));
+        if (!t->ns) {
+            perror("tpbench");
+            exit(EXIT_FAILURE);
+        }
+    }
+    t->ns[t->count++] = ns;
+}
+
+static int cmp_long(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static void times_report(const char *what, bench_times_t *t)
+{
+    static const double pct[] = {50, 90, 99, 99.9};
+    double sum = 0;
+    long i;
+
+    if (!t->count) {
+        printf("%s: no samples\n", what);
+        return;
+    }
+    qsort(t->ns, t->count, sizeof(*t->ns), cmp_long);
+    for (i = 0; i < t->count; i++) {
+        sum += t->ns[i];
+    }
+    printf("%s (us): mean %.2f", what, sum / t->count / 1000.0);
+    for (i = 0; i < (long)(sizeof(pct) / sizeof(pct[0])); i++) {
+        long k = (long)ceil(pct[i] / 100.0 * t->count) - 1;
+        if (k < 0) k = 0;
+        printf("  p%g %.2f", pct[i], t->ns[k] / 1000.0);
+    }
+    printf("  max %.2f\n", t->ns[t->count - 1] / 1000.0);
+}
+
+static bench_seg_t *prog_new(bench_prog_t *p)
+{
+    if (p->count == p->alloc) {
+        p->alloc = p->alloc ? 2 * p->alloc : 1024;
+        p->seg = realloc(p->seg, p->alloc * sizeof(*p->seg));
+        if (!p->seg) {
+            perror("tpbench");
+            exit(EXIT_FAILURE);
+        }
+    }
+    bench_seg_t *s = &p->seg[p->count++];
+    memset(s, 0, sizeof(*s));
+    return s;
+}
+
+static const PmCartesian normal_xy = {0.0, 0.0, 1.0};
+
+static void prog_line(bench_prog_t *p, EmcPose *pos, PmCartesian end, int type, double vel)
+{
+    bench_seg_t *s = prog_new(p);
+    s->type = type;
+    s->end = *pos;
+    s->end.tran = end;
+    s->vel = vel;
+    pmCartCartDisp(&pos->tran, &end, &s->length);
+    *pos = s->end;
+}
+
+/* turn follows emccanon: 0 is one counterclockwise (G3) pass, -1 one
+   clockwise (G2) pass */
+static void prog_arc(bench_prog_t *p, EmcPose *pos, PmCartesian end, PmCartesian center,
+        int turn, double vel)
+{
+    bench_seg_t *s = prog_new(p);
+    PmCircle circle;
+    s->type = EMC_MOTION_TYPE_ARC;
+    s->end = *pos;
+    s->end.tran = end;
+    s->center = center;
+    s->turn = turn;
+    s->vel = vel;
+    if (pmCircleInit(&circle, &pos->tran, &end, &center, &normal_xy, turn) == 0) {
+        double planar = circle.angle * circle.radius;
+        double helix;
+        pmCartMag(&circle.rHelix, &helix);
+        s->length = sqrt(planar * planar + helix * helix);
+    }
+    *pos = s->end;
+}
+
+static void make_pattern(bench_prog_t *p, const char *pattern)
+{
+    EmcPose pos;
+    int i;
+
+    ZERO_EMC_POSE(pos);
+    if (!strcmp(pattern, "sine")) {
+        // CAM-style polyline through a wave: small, steadily changing
+        // corner angles that exercise blending and the lookahead
+        for (i = 1; i <= opt.count; i++) {
+            double x = i * opt.seglen;
+            PmCartesian end = {x, 5.0 * sin(x * 2 * M_PI / 50.0), 0.0};
+            prog_line(p, &pos, end, EMC_MOTION_TYPE_FEED, opt.feed);
+        }
+    } else if (!strcmp(pattern, "circle")) {
+        // tessellated circle of radius 20
+        double r = 20.0;
+        double step = 2.0 * asin(fmin(1.0, opt.seglen / (2.0 * r)));
+        PmCartesian start = {r, 0.0, 0.0};
+        prog_line(p, &pos, start, EMC_MOTION_TYPE_TRAVERSE, opt.vmax);
+        for (i = 1; i <= opt.count; i++) {
+            PmCartesian end = {r * cos(i * step), r * sin(i * step), 0.0};
+            prog_line(p, &pos, end, EMC_MOTION_TYPE_FEED, opt.feed);
+        }
+    } else if (!strcmp(pattern, "arcs")) {
+        // tangent half circles of alternating direction
+        double r = opt.seglen / M_PI;
+        for (i = 0; i < opt.count; i++) {
+            PmCartesian center = pos.tran;
+            PmCartesian end = pos.tran;
+            center.x += r;
+            end.x += 2.0 * r;
+            prog_arc(p, &pos, end, center, (i & 1) ? 0 : -1, opt.feed);
+        }
+    } else {
+        fprintf(stderr, "tpbench: unknown pattern '%s'\n", pattern);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Read the motion words of a CAM-style G-code file: G0 G1 G2 G3 with
+   X Y Z I J R F in the XY plane, absolute or incremental, in whatever
+   length units the file uses.  Everything else is ignored; this is a
+   segment source, not an interpreter. */
+static void read_gcode(bench_prog_t *p, const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    char line[1024];
+    int motion = 0, incremental = 0, lineno = 0;
+    double feed = opt.feed;
+    EmcPose pos;
+
+    if (!f) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+    ZERO_EMC_POSE(pos);
+    while (fgets(line, sizeof(line), f)) {
+        PmCartesian end = pos.tran;
+        double ci = 0.0, cj = 0.0, radius = 0.0;
+        int have_xyz = 0;
+        char *c = line;
+
+        lineno++;
+        while (*c) {
+            char word = toupper((unsigned char)*c);
+            char *next;
+            double v;
+
+            if (word == '(') {
+                while (*c && *c != ')') c++;
+                if (*c) c++;
+                continue;
+            }
+            if (word == ';' || word == '%') {
+                break;
+            }
+            if (!isalpha((unsigned char)word)) {
+                c++;
+                continue;
+            }
+            v = strtod(c + 1, &next);
+            if (next == c + 1) {
+                fprintf(stderr, "%s:%d: ignoring '%c' without a value\n", filename, lineno, word);
+                c++;
+                continue;
+            }
+            c = next;
+            switch (word) {
+            case 'G':
+                if (v == 0 || v == 1 || v == 2 || v == 3) motion = (int)v;
+                else if (v == 90) incremental = 0;
+                else if (v == 91) incremental = 1;
+                break;
+            case 'X': end.x = incremental ? end.x + v : v; have_xyz = 1; break;
+            case 'Y': end.y = incremental ? end.y + v : v; have_xyz = 1; break;
+            case 'Z': end.z = incremental ? end.z + v : v; have_xyz = 1; break;
+            case 'I': ci = v; break;
+            case 'J': cj = v; break;
+            case 'R': radius = v; break;
+            case 'F': feed = v / 60.0; break;
+            }
+        }
+        if (!have_xyz) {
+            continue;
+        }
+        if (motion == 0) {
+            prog_line(p, &pos, end, EMC_MOTION_TYPE_TRAVERSE, opt.vmax);
+        } else if (motion == 1) {
+            prog_line(p, &pos, end, EMC_MOTION_TYPE_FEED, feed);
+        } else {
+            PmCartesian center = {pos.tran.x + ci, pos.tran.y + cj, pos.tran.z};
+            if (radius != 0.0) {
+                // center on the chord's bisector; a positive radius picks
+                // the short way round, to the left of the chord for G3
+                double dx = end.x - pos.tran.x, dy = end.y - pos.tran.y;
+                double chord = hypot(dx, dy);
+                double side = (motion == 3) == (radius > 0) ? 1.0 : -1.0;
+                double h = sqrt(fmax(0.0, radius * radius - chord * chord / 4.0));
+                if (chord == 0.0) {
+                    fprintf(stderr, "%s:%d: ignoring R arc without an end point\n", filename, lineno);
+                    continue;
+                }
+                center.x = pos.tran.x + dx / 2 - side * h * dy / chord;
+                center.y = pos.tran.y + dy / 2 + side * h * dx / chord;
+            }
+            prog_arc(p, &pos, end, center, motion == 3 ? 0 : -1, feed);
+        }
+    }
+    fclose(f);
+}
+
+static int add_segment(bench_seg_t *s)
+{
+    struct state_tag_t tag;
+    memset(&tag, 0, sizeof(tag));
+
+    if (s->type == EMC_MOTION_TYPE_ARC) {
+        return tpAddCircle(&tp, s->end, s->center, normal_xy, s->turn, s->type,
+                s->vel, opt.vmax, opt.amax, opt.jerk, FS_ENABLED, 0, tag);
+    }
+    return tpAddLine(&tp, s->end, s->type, s->vel, opt.vmax, opt.amax, opt.jerk,
+            FS_ENABLED, 0, -1, tag);
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+"usage: tpbench [options] [FILE.ngc]\n"
+"  -p, --period NS        cycle period in ns (1000000)\n"
+"  -P, --pattern NAME     synthetic segments when no FILE: sine, circle, arcs (sine)\n"
+"  -n, --count N          number of synthetic segments (10000)\n"
+"  -l, --length L         synthetic segment length (0.5)\n"
+"  -F, --feed F           feed in units/min (3000)\n"
+"  -v, --vmax V           max velocity in units/s (100)\n"
+"  -a, --amax A           max acceleration in units/s^2 (1000)\n"
+"  -j, --jerk J           max jerk in units/s^3 (10000)\n"
+"  -s, --planner N        planner type, 0 trapezoidal or 1 S-curve (0)\n"
+"  -t, --tolerance T      blend tolerance as in G64 P, 0 for none (0)\n"
+"  -q, --queue N          TC queue size (%d)\n"
+"  -d, --depth N          lookahead depth, ARC_BLEND_OPTIMIZATION_DEPTH (50)\n"
+"  -A, --adds-per-cycle N segments queued per cycle, 0 to keep the queue full (1)\n",
+        DEFAULT_TC_QUEUE_SIZE);
+    exit(EXIT_FAILURE);
+}
+
+static double parse_real(const char *arg)
+{
+    char *end;
+    double v = strtod(arg, &end);
+    if (end == arg || *end || !(v >= 0)) {
+        fprintf(stderr, "tpbench: invalid number '%s'\n", arg);
+        exit(EXIT_FAILURE);
+    }
+    return v;
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct option long_options[] = {
+        {"period", required_argument, 0, 'p'},
+        {"pattern", required_argument, 0, 'P'},
+        {"count", required_argument, 0, 'n'},
+        {"length", required_argument, 0, 'l'},
+        {"feed", required_argument, 0, 'F'},
+        {"vmax", required_argument, 0, 'v'},
+        {"amax", required_argument, 0, 'a'},
+        {"jerk", required_argument, 0, 'j'},
+        {"planner", required_argument, 0, 's'},
+        {"tolerance", required_argument, 0, 't'},
+        {"queue", required_argument, 0, 'q'},
+        {"depth", required_argument, 0, 'd'},
+        {"adds-per-cycle", required_argument, 0, 'A'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0},
+    };
+    bench_prog_t prog = {0};
+    bench_times_t add_times = {0}, cycle_times = {0};
+    long period_ns = 1000000;
+    int c, i;
+
+    while ((c = getopt_long(argc, argv, "p:P:n:l:F:v:a:j:s:t:q:d:A:h", long_options, NULL)) != -1) {
+        switch (c) {
+        case 'p': period_ns = (long)parse_real(optarg); break;
+        case 'P': opt.pattern = optarg; break;
+        case 'n': opt.count = (int)parse_real(optarg); break;
+        case 'l': opt.seglen = parse_real(optarg); break;
+        case 'F': opt.feed = parse_real(optarg) / 60.0; break;
+        case 'v': opt.vmax = parse_real(optarg); break;
+        case 'a': opt.amax = parse_real(optarg); break;
+        case 'j': opt.jerk = parse_real(optarg); break;
+        case 's': opt.planner = (int)parse_real(optarg); break;
+        case 't': opt.tolerance = parse_real(optarg); break;
+        case 'q': opt.queue = (int)parse_real(optarg); break;
+        case 'd': opt.depth = (int)parse_real(optarg); break;
+        case 'A': opt.per_cycle = (int)parse_real(optarg); break;
+        default: usage();
+        }
+    }
+    if (optind < argc - 1 || period_ns <= 0 || opt.seglen <= 0 || opt.feed <= 0
+            || opt.vmax <= 0 || opt.amax <= 0 || opt.planner > 1
+            || opt.queue < MIN_TC_QUEUE_SIZE) {
+        usage();
+    }
+    opt.period = period_ns * 1e-9;
+
+    if (optind < argc) {
+        read_gcode(&prog, argv[optind]);
+    } else {
+        make_pattern(&prog, opt.pattern);
+    }
+
+    // what motmod and the [TRAJ] defaults would set up
+    status.net_feed_scale = 1.0;
+    status.planner_type = opt.planner;
+    status.jerk = opt.jerk;
+    status.vel = opt.vmax;
+    status.acc = opt.amax;
+    config.trajCycleTime = opt.period;
+    config.maxFeedScale = 1.0;
+    config.arcBlendEnable = 1;
+    config.arcBlendFallbackEnable = 0;
+    config.arcBlendOptDepth = opt.depth;
+    config.arcBlendGapCycles = 4;
+    config.arcBlendRampFreq = 100.0;
+    config.arcBlendTangentKinkRatio = 0.1;
+
+    tpMotFunctions(bench_dio_write, bench_aio_write, bench_set_rotary_unlock,
+            bench_get_rotary_unlocked, bench_axis_vel_limit, bench_axis_acc_limit);
+    tpMotData(&status, &config);
+    if (tpCreate(&tp, opt.queue, 0) != 0) {
+        fprintf(stderr, "tpbench: tpCreate failed\n");
+        exit(EXIT_FAILURE);
+    }
+    tpSetCycleTime(&tp, opt.period);
+    tpSetVmax(&tp, opt.vmax, opt.vmax);
+    tpSetVlimit(&tp, opt.vmax);
+    tpSetAmax(&tp, opt.amax);
+    tpSetTermCond(&tp, TC_TERM_COND_PARABOLIC, opt.tolerance);
+
+    double path = 0.0, programmed = 0.0;
+    int next = 0, rejected = 0;
+    long cycles = 0, starved = 0, moving_cycles = 0;
+    long max_cycles = -1;
+
+    // Motmod handles one command per servo cycle, which is what the
+    // default of one add per cycle models.  The cycle cap only stops a
+    // planner that never finishes.
+    while (next < prog.count || !tpIsDone(&tp)) {
+        int added = 0;
+        while (next < prog.count && !tcqFull(&tp.queue)
+                && (opt.per_cycle == 0 || added < opt.per_cycle)) {
+            bench_seg_t *s = &prog.seg[next++];
+            long t0 = now_ns();
+            int r = add_segment(s);
+            times_add(&add_times, now_ns() - t0);
+            if (r != 0) {
+                rejected++;
+                continue;
+            }
+            added++;
+            path += s->length;
+            programmed += s->length / s->vel;
+            if (max_cycles < 0) max_cycles = 0;
+            max_cycles += 100 + (long)(100 * s->length / s->vel / opt.period);
+        }
+        if (next < prog.count && tcqLen(&tp.queue) < 2) {
+            // nothing queued behind the active segment, so the planner
+            // has to plan for a stop at its end
+            starved++;
+        }
+        long t0 = now_ns();
+        tpRunCycle(&tp, period_ns);
+        times_add(&cycle_times, now_ns() - t0);
+        cycles++;
+        if (!tpIsDone(&tp)) {
+            moving_cycles++;
+        }
+        if (max_cycles >= 0 && cycles > max_cycles) {
+            fprintf(stderr, "tpbench: planner did not finish after %ld cycles\n", cycles);
+            break;
+        }
+    }
+
+    double add_total = 0;
+    for (i = 0; i < add_times.count; i++) {
+        add_total += add_times.ns[i];
+    }
+    double motion_time = moving_cycles * opt.period;
+
+    printf("segments: %d queued, %d rejected\n", prog.count - rejected, rejected);
+    printf("cycles: %ld (%.3f s simulated), %ld starved\n", cycles, cycles * opt.period, starved);
+    printf("add rate: %.0f segments/s\n", add_times.count ? add_times.count / (add_total * 1e-9) : 0.0);
+    times_report("add time", &add_times);
+    times_report("cycle time", &cycle_times);
+    printf("cycle budget used: %.2f%% at p99.9\n",
+            cycle_times.count ? 100.0 * cycle_times.ns[(long)ceil(0.999 * cycle_times.count) - 1] / period_ns : 0.0);
+    printf("path length: %.3f\n", path);
+    if (motion_time > 0 && programmed > 0) {
+        printf("programmed feed: %.3f units/min\n", 60.0 * path / programmed);
+        printf("achieved feed: %.3f units/min (%.1f%%)\n",
+                60.0 * path / motion_time, 100.0 * programmed / motion_time);
+    }
+
+    tpDelete(&tp);
+    free(prog.seg);
+    free(add_times.ns);
+    free(cycle_times.ns);
+    return 0;
+}
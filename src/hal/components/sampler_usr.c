@@ -20,7 +20,7 @@
 
     Invoking:
 
-    halsampler [-c chan_num] [-n num_samples] [-t]
+    halsampler [-c chan_num] [-n num_samples] [-t] [-b] [-m] [filename]
 
     'chan_num', if present, specifies the sampler channel to use.
     The default is channel zero.
@@ -32,6 +32,12 @@
     '-t' tells sampler to print the sample number at the start
     of each line.
 
+    '-b' writes a binary file instead of text: a header describing
+    the pin types, followed by packed rows of 8-byte values.
+
+    '-m' writes the output file through a memory mapping instead of
+    write() calls.  It requires a filename.
+
 */
 
 /** This program is free software; you can redistribute it and/or
@@ -69,6 +75,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
 
 #include <rtapi.h>		/* RTAPI realtime OS API */
 #include <hal.h>                /* HAL public API decls */
@@ -78,6 +86,10 @@
 *                  LOCAL FUNCTION DECLARATIONS                         *
 ************************************************************************/
 
+static char *out_reserve(size_t len);
+static void out_commit(size_t len);
+static int out_close(void);
+
 /***********************************************************************
 *                         GLOBAL VARIABLES                             *
 ************************************************************************/
@@ -88,6 +100,34 @@ int exitval = 1;	/* program return code - 1 means error */
 int ignore_sig = 0;	/* used to flag critical regions */
 char comp_name[HAL_NAME_LEN+1];	/* name for this instance of sampler */
 
+/* Output goes through a single sink: either a block buffer that is
+   handed to write() when full, or a shared mapping of the output file
+   that is grown in MAP_CHUNK steps.  Both paths hand out space with
+   out_reserve() and account for it with out_commit(). */
+#define BLOCK_SIZE	(256*1024)
+#define MAP_CHUNK	(16*1024*1024)
+
+static int out_fd = 1;
+static int out_mmap;		/* 1 if writing through a mapping */
+static int out_error;		/* errno of the first failed write */
+static char *out_buf;		/* block buffer or mapping */
+static size_t out_len;		/* bytes used in out_buf */
+static size_t out_size;		/* size of out_buf */
+static off_t out_base;		/* file offset of out_buf (mmap mode) */
+
+/* binary file layout, in host byte order:
+     header:  char magic[8] = "HALSAMPL"
+	      rtapi_u32 version, header_size, num_pins, flags
+	      char types[num_pins], one of "FBUSLK", zero padded so
+	      that header_size is a multiple of 8
+     rows:    rtapi_u64 sample number, only if flags & BIN_TAGGED
+	      num_pins 8-byte values: float as double, bit/u32/u64 as
+	      rtapi_u64, s32/s64 as rtapi_s64
+*/
+#define BIN_MAGIC	"HALSAMPL"
+#define BIN_VERSION	1
+#define BIN_TAGGED	1
+
 /***********************************************************************
 *                            MAIN PROGRAM                              *
 ************************************************************************/
@@ -103,20 +143,247 @@ static void quit(int sig)
     stop = 1;
 }
 
-#define BUF_SIZE 4000
+static int out_flush(void)
+{
+    size_t done = 0;
+    while ( done < out_len ) {
+	ssize_t r = write(out_fd, out_buf + done, out_len - done);
+	if ( r < 0 ) {
+	    if ( errno == EINTR ) {
+		continue;
+	    }
+	    out_error = errno;
+	    return -1;
+	}
+	done += r;
+    }
+    out_len = 0;
+    return 0;
+}
+
+static int out_map(size_t need)
+{
+    /* slide the window forward to the page holding out_len and make
+       sure at least 'need' bytes are mapped past that point */
+    long page = sysconf(_SC_PAGESIZE);
+    off_t pos = out_base + out_len;
+    off_t base = pos - pos % page;
+    size_t size = MAP_CHUNK;
+    while ( size < (size_t)(pos - base) + need ) {
+	size += MAP_CHUNK;
+    }
+    if ( out_buf ) {
+	munmap(out_buf, out_size);
+	out_buf = NULL;
+    }
+    if ( ftruncate(out_fd, base + size) < 0 ) {
+	out_error = errno;
+	return -1;
+    }
+    out_buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, base);
+    if ( out_buf == MAP_FAILED ) {
+	out_buf = NULL;
+	out_error = errno;
+	return -1;
+    }
+    out_len = pos - base;
+    out_base = base;
+    out_size = size;
+    return 0;
+}
+
+static char *out_reserve(size_t len)
+{
+    if ( out_len + len <= out_size ) {
+	return out_buf + out_len;
+    }
+    if ( out_mmap ? out_map(len) : out_flush() ) {
+	return NULL;
+    }
+    return out_buf + out_len;
+}
+
+static void out_commit(size_t len)
+{
+    out_len += len;
+}
+
+static int out_close(void)
+{
+    int res = 0;
+    if ( out_mmap ) {
+	if ( out_buf ) {
+	    munmap(out_buf, out_size);
+	    out_buf = NULL;
+	}
+	/* cut the preallocated tail off the file */
+	if ( ftruncate(out_fd, out_base + out_len) < 0 && !out_error ) {
+	    out_error = errno;
+	}
+    } else if ( out_buf ) {
+	out_flush();
+    }
+    if ( out_error ) {
+	errno = out_error;
+	perror("halsampler: write");
+	res = -1;
+    }
+    return res;
+}
+
+static int write_header(hal_stream_t *stream, int num_pins, int tag)
+{
+    size_t size = (4 * sizeof(rtapi_u32) + 8 + num_pins + 7) & ~(size_t)7;
+    char *p = out_reserve(size);
+    rtapi_u32 word[4] = { BIN_VERSION, size, num_pins, tag ? BIN_TAGGED : 0 };
+    int n;
+
+    if ( !p ) {
+	return -1;
+    }
+    memset(p, 0, size);
+    memcpy(p, BIN_MAGIC, 8);
+    memcpy(p + 8, word, sizeof(word));
+    for ( n = 0 ; n < num_pins ; n++ ) {
+	char c;
+	switch ( hal_stream_element_type(stream, n) ) {
+	case HAL_FLOAT: c = 'F'; break;
+	case HAL_BIT:   c = 'B'; break;
+	case HAL_U32:   c = 'U'; break;
+	case HAL_S32:   c = 'S'; break;
+	case HAL_S64:   c = 'L'; break;
+	case HAL_U64:   c = 'K'; break;
+	default:
+	    return -1;
+	}
+	p[8 + sizeof(word) + n] = c;
+    }
+    out_commit(size);
+    return 0;
+}
+
+static int write_binary(const hal_type_t *type, int num_pins,
+    union hal_stream_data *buf, unsigned this_sample, int tag)
+{
+    size_t size = (num_pins + (tag ? 1 : 0)) * 8;
+    char *p = out_reserve(size);
+    int n;
+
+    if ( !p ) {
+	return -1;
+    }
+    if ( tag ) {
+	rtapi_u64 t = this_sample - 1;
+	memcpy(p, &t, 8);
+	p += 8;
+    }
+    for ( n = 0 ; n < num_pins ; n++, p += 8 ) {
+	rtapi_u64 u;
+	rtapi_s64 s;
+	double f;
+	switch ( type[n] ) {
+	case HAL_FLOAT: f = buf[n].f; memcpy(p, &f, 8); break;
+	case HAL_BIT:   u = buf[n].b ? 1 : 0; memcpy(p, &u, 8); break;
+	case HAL_U32:   u = buf[n].u; memcpy(p, &u, 8); break;
+	case HAL_S32:   s = buf[n].s; memcpy(p, &s, 8); break;
+	case HAL_U64:   u = buf[n].k; memcpy(p, &u, 8); break;
+	case HAL_S64:   s = buf[n].l; memcpy(p, &s, 8); break;
+	default:
+	    return -1;
+	}
+    }
+    out_commit(size);
+    return 0;
+}
+
+/* longest text for one value, including the separator: "%f" of
+   -DBL_MAX is 316 characters */
+#define TEXT_FIELD	320
+
+static int write_text(const hal_type_t *type, int num_pins,
+    union hal_stream_data *buf, unsigned this_sample, int tag)
+{
+    size_t room = (num_pins + 1) * TEXT_FIELD + 1;
+    char *start = out_reserve(room);
+    char *p = start;
+    int n;
+
+    if ( !p ) {
+	return -1;
+    }
+    if ( tag ) {
+	p += snprintf(p, TEXT_FIELD, "%u ", this_sample-1 );
+    }
+    for ( n = 0 ; n < num_pins; n++ ) {
+	switch ( type[n] ) {
+	case HAL_REAL:
+	    p += snprintf(p, TEXT_FIELD, "%f ", buf[n].f);
+	    break;
+	case HAL_BOOL:
+	    *p++ = buf[n].b ? '1' : '0';
+	    *p++ = ' ';
+	    break;
+	case HAL_U32:
+	    p += snprintf(p, TEXT_FIELD, "%lu ", (unsigned long)buf[n].u);
+	    break;
+	case HAL_S32:
+	    p += snprintf(p, TEXT_FIELD, "%ld ", (long)buf[n].s);
+	    break;
+	case HAL_UINT:
+	    p += snprintf(p, TEXT_FIELD, "%llu ", (unsigned long long)buf[n].k);
+	    break;
+	case HAL_SINT:
+	    p += snprintf(p, TEXT_FIELD, "%lld ", (long long)buf[n].l);
+	    break;
+	default:
+	    /* better not happen */
+	    return -1;
+	}
+    }
+    *p++ = '\n';
+    out_commit(p - start);
+    return 0;
+}
+
+static int write_overrun(int binary)
+{
+    static const char msg[] = "overrun\n";
+    char *p;
+
+    if ( binary ) {
+	/* with -t the gap shows in the sample numbers, and the file
+	   format has no room for markers */
+	fprintf(stderr, "halsampler: overrun\n");
+	return 0;
+    }
+    p = out_reserve(sizeof(msg) - 1);
+    if ( !p ) {
+	return -1;
+    }
+    memcpy(p, msg, sizeof(msg) - 1);
+    out_commit(sizeof(msg) - 1);
+    return 0;
+}
+
+/* rows fetched from the FIFO per hal_stream_read_many() call */
+#define READ_BATCH 256
 
 int main(int argc, char **argv)
 {
-    int n, channel, tag;
+    int n, channel, tag, binary, use_mmap;
     long int samples;
-    unsigned this_sample, last_sample=0;
+    unsigned this_sample[READ_BATCH], last_sample=0;
     char *cp, *cp2;
     hal_stream_t stream;
+    hal_type_t type[HAL_STREAM_MAX_PINS];
+    union hal_stream_data *buf = NULL;
 
     /* set return code to "fail", clear it later if all goes well */
     exitval = 1;
     channel = 0;
     tag = 0;
+    binary = 0;
+    use_mmap = 0;
     samples = -1;  /* -1 means run forever */
     /* FIXME - if I wasn't so lazy I'd learn how to use getopt() here */
     for ( n = 1 ; n < argc ; n++ ) {
@@ -148,6 +415,12 @@ int main(int argc, char **argv)
 	case 't':
 	    tag = 1;
 	    break;
+	case 'b':
+	    binary = 1;
+	    break;
+	case 'm':
+	    use_mmap = 1;
+	    break;
 	default:
 	    fprintf(stderr,"ERROR: unknown option '%s'\n", cp );
 	    exit(1);
@@ -160,10 +433,32 @@ int main(int argc, char **argv)
 	    fprintf(stderr, "ERROR: At most one filename may be specified\n");
 	    exit(1);
 	}
-	// make stdout be the named file
-	fd = open(argv[n], O_WRONLY | O_CREAT | O_TRUNC, 0666);
-	close(1);
-	dup2(fd, 1);
+	if ( use_mmap ) {
+	    /* a shared mapping needs read access to the file too */
+	    fd = open(argv[n], O_RDWR | O_CREAT | O_TRUNC, 0666);
+	    if ( fd < 0 ) {
+		perror(argv[n]);
+		exit(1);
+	    }
+	    out_fd = fd;
+	    out_mmap = 1;
+	} else {
+	    // make stdout be the named file
+	    fd = open(argv[n], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	    close(1);
+	    dup2(fd, 1);
+	}
+    } else if ( use_mmap ) {
+	fprintf(stderr, "ERROR: -m requires a filename\n");
+	exit(1);
+    }
+    if ( !out_mmap ) {
+	out_buf = malloc(BLOCK_SIZE);
+	if ( !out_buf ) {
+	    fprintf(stderr, "ERROR: out of memory\n");
+	    exit(1);
+	}
+	out_size = BLOCK_SIZE;
     }
     /* register signal handlers - if the process is killed
        we need to call hal_exit() to free the shared memory */
@@ -190,56 +485,57 @@ int main(int argc, char **argv)
 	goto out;
     }
     int num_pins = hal_stream_element_count(&stream);
+    for ( n = 0 ; n < num_pins; n++ ) {
+	type[n] = hal_stream_element_type(&stream, n);
+    }
+    if ( binary && write_header(&stream, num_pins, tag) < 0 ) {
+	goto out;
+    }
+    buf = malloc(sizeof(*buf) * num_pins * READ_BATCH);
+    if ( !buf ) {
+	fprintf(stderr, "ERROR: out of memory\n");
+	goto out;
+    }
     while ( samples != 0 ) {
-	union hal_stream_data buf[num_pins];
-	hal_stream_wait_readable(&stream, &stop);
-	if(stop) break;
-	int res = hal_stream_read(&stream, buf, &this_sample);
-	if (res < 0) {
-	    errno = -res;
-	    perror("hal_stream_read");
-	    goto out;
+	if ( !hal_stream_readable(&stream) ) {
+	    /* FIFO drained - get what we have to the reader before
+	       sleeping */
+	    if ( !out_mmap && out_flush() < 0 ) {
+		goto out;
+	    }
+	    hal_stream_wait_readable(&stream, &stop);
 	}
-	++last_sample;
-	if ( this_sample != last_sample ) {
-	    printf ( "overrun\n");
-	    last_sample = this_sample;
+	if(stop) break;
+	int max = READ_BATCH;
+	if ( samples > 0 && samples < max ) {
+	    max = samples;
 	}
-	if ( tag ) {
-	    printf ( "%u ", this_sample-1 );
+	int got = hal_stream_read_many(&stream, buf, this_sample, max);
+	if (got < 0) {
+	    errno = -got;
+	    perror("hal_stream_read_many");
+	    goto out;
 	}
-	for ( n = 0 ; n < num_pins; n++ ) {
-	    switch ( hal_stream_element_type(&stream, n) ) {
-	    case HAL_REAL:
-		printf ( "%f ", buf[n].f);
-		break;
-	    case HAL_BOOL:
-		if ( buf[n].b ) {
-		    printf ( "1 " );
-		} else {
-		    printf ( "0 " );
+	for ( int i = 0 ; i < got ; i++ ) {
+	    union hal_stream_data *row = buf + i * num_pins;
+	    ++last_sample;
+	    if ( this_sample[i] != last_sample ) {
+		if ( write_overrun(binary) < 0 ) {
+		    goto out;
 		}
-		break;
-	    case HAL_U32:
-		printf ( "%lu ", (unsigned long)buf[n].u);
-		break;
-	    case HAL_S32:
-		printf ( "%ld ", (long)buf[n].s);
-		break;
-	    case HAL_UINT:
-		printf ( "%llu ", (unsigned long long)buf[n].k);
-		break;
-	    case HAL_SINT:
-		printf ( "%lld ", (long long)buf[n].l);
-		break;
-	    default:
-		/* better not happen */
+		last_sample = this_sample[i];
+	    }
+	    if ( binary ) {
+		res = write_binary(type, num_pins, row, this_sample[i], tag);
+	    } else {
+		res = write_text(type, num_pins, row, this_sample[i], tag);
+	    }
+	    if ( res < 0 ) {
 		goto out;
 	    }
-	}
-	printf ( "\n" );
-	if ( samples > 0 ) {
-	    samples--;
+	    if ( samples > 0 ) {
+		samples--;
+	    }
 	}
     }
     /* run was successful */
@@ -247,6 +543,10 @@ int main(int argc, char **argv)
 
 out:
     ignore_sig = 1;
+    free(buf);
+    if ( out_close() < 0 ) {
+	exitval = 1;
+    }
     hal_stream_detach(&stream);
     if ( comp_id >= 0 ) {
 	hal_exit(comp_id);
@@ -16,7 +16,8 @@
     It will mostly be used for testing - when EMC is run normally,
     the motion module creates all the necessary threads.
     
-    The module has three pairs of parameters, "name1, period1", etc.
+    The module has three sets of parameters, "name1, period1, cpu1,
+    workers1", etc.
 */
 
 /** Copyright (C) 2003 John Kasunich
@@ -63,18 +64,30 @@ static int fp1 = 1;		/* deprecated: fp is always enabled, kept for API compat */
 RTAPI_MP_INT(fp1, "thread1 uses floating point (deprecated, ignored)");
 static long period1 = 1000000;	/* thread period - default = 1ms thread */
 RTAPI_MP_LONG(period1,  "thread1 period (nsecs)");
+static int cpu1 = -1;		/* CPU to bind the thread to, -1 = default */
+RTAPI_MP_INT(cpu1, "thread1 CPU (-1 = default)");
+static int workers1[HAL_THREAD_WORKERS] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+RTAPI_MP_ARRAY_INT(workers1, HAL_THREAD_WORKERS, "CPUs of the workers of thread1");
 static char *name2 = NULL;	/* name of thread */
 RTAPI_MP_STRING(name2, "name of thread 2");
 static int fp2 = 1;		/* deprecated: fp is always enabled, kept for API compat */
 RTAPI_MP_INT(fp2, "thread2 uses floating point (deprecated, ignored)");
 static long period2 = 0;	/* thread period - default = no thread */
 RTAPI_MP_LONG(period2, "thread2 period (nsecs)");
+static int cpu2 = -1;		/* CPU to bind the thread to, -1 = default */
+RTAPI_MP_INT(cpu2, "thread2 CPU (-1 = default)");
+static int workers2[HAL_THREAD_WORKERS] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+RTAPI_MP_ARRAY_INT(workers2, HAL_THREAD_WORKERS, "CPUs of the workers of thread2");
 static char *name3 = NULL;	/* name of thread */
 RTAPI_MP_STRING(name3, "name of thread 3");
 static int fp3 = 1;		/* deprecated: fp is always enabled, kept for API compat */
 RTAPI_MP_INT(fp3, "thread3 uses floating point (deprecated, ignored)");
 static long period3 = 0;	/* thread period - default = no thread */
 RTAPI_MP_LONG(period3, "thread3 period (nsecs)");
+static int cpu3 = -1;		/* CPU to bind the thread to, -1 = default */
+RTAPI_MP_INT(cpu3, "thread3 CPU (-1 = default)");
+static int workers3[HAL_THREAD_WORKERS] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+RTAPI_MP_ARRAY_INT(workers3, HAL_THREAD_WORKERS, "CPUs of the workers of thread3");
 
 /***********************************************************************
 *                STRUCTURES AND GLOBAL VARIABLES                       *
@@ -90,6 +103,7 @@ static int thread3_id;
 *                  LOCAL FUNCTION DECLARATIONS                         *
 ************************************************************************/
 
+static int add_workers(const char *name, const int *cpus);
 
 /***********************************************************************
 *                       INIT AND EXIT CODE                             *
@@ -107,7 +121,7 @@ int rtapi_app_main(void)
     /* was 'period' specified in the insmod command? */
     if ((period1 > 0) && (name1 != NULL) && (*name1 != '\0')) {
 	/* create a thread */
-	thread1_id = hal_create_thread(name1, period1, 1);
+	thread1_id = hal_create_thread_cpu(name1, period1, 1, cpu1);
 	if (thread1_id < 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
 		"THREADS: ERROR: could not create thread '%s'\n", name1);
@@ -116,10 +130,15 @@ int rtapi_app_main(void)
 	} else {
 	    rtapi_print_msg(RTAPI_MSG_INFO, "THREADS: created %ld uS thread\n", period1 / 1000);
 	}
+	if (add_workers(name1, workers1) < 0) {
+	    hal_exit(thread1_id);
+	    hal_exit(comp_id);
+	    return -1;
+	}
     }
     if ((period2 > 0) && (name2 != NULL) && (*name2 != '\0')) {
 	/* create a thread */
-	thread2_id = hal_create_thread(name2, period2, 1);
+	thread2_id = hal_create_thread_cpu(name2, period2, 1, cpu2);
 	if (thread2_id < 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
 		"THREADS: ERROR: could not create thread '%s'\n", name2);
@@ -129,10 +148,16 @@ int rtapi_app_main(void)
 	} else {
 	    rtapi_print_msg(RTAPI_MSG_INFO, "THREADS: created %ld uS thread\n", period2 / 1000);
 	}
+	if (add_workers(name2, workers2) < 0) {
+	    hal_exit(thread1_id);
+	    hal_exit(thread2_id);
+	    hal_exit(comp_id);
+	    return -1;
+	}
     }
     if ((period3 > 0) && (name3 != NULL) && (*name3 != '\0')) {
 	/* create a thread */
-	thread3_id = hal_create_thread(name3, period3, 1);
+	thread3_id = hal_create_thread_cpu(name3, period3, 1, cpu3);
 	if (thread3_id < 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
 		"THREADS: ERROR: could not create thread '%s'\n", name3);
@@ -143,11 +168,35 @@ int rtapi_app_main(void)
 	} else {
 	    rtapi_print_msg(RTAPI_MSG_INFO, "THREADS: created %ld uS thread\n", period3 / 1000);
 	}
+	if (add_workers(name3, workers3) < 0) {
+	    hal_exit(thread1_id);
+	    hal_exit(thread2_id);
+	    hal_exit(thread3_id);
+	    hal_exit(comp_id);
+	    return -1;
+	}
     }
     hal_ready(comp_id);
     return 0;
 }
 
+/* give thread 'name' a worker for each CPU in 'cpus' */
+static int add_workers(const char *name, const int *cpus)
+{
+    int n, retval;
+
+    for (n = 0; n < HAL_THREAD_WORKERS && cpus[n] >= 0; n++) {
+	retval = hal_thread_add_worker(name, cpus[n]);
+	if (retval < 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"THREADS: ERROR: could not add worker on CPU %d to thread '%s'\n",
+		cpus[n], name);
+	    return retval;
+	}
+    }
+    return 0;
+}
+
 void rtapi_app_exit(void)
 {
     rtapi_print_msg(RTAPI_MSG_INFO, "THREADS: hal_exit %i %i %i", thread1_id, thread2_id, thread3_id);
@@ -411,6 +411,15 @@ int hm2_encoder_parse_md(hostmot2_t *hm2, int md_index) {
         goto fail0;
     }
 
+    hm2->encoder.rawcounts_64 = (rtapi_s64 *)hal_malloc(hm2->encoder.num_instances * sizeof(rtapi_s64));
+    hm2->encoder.prev_rawcounts_64 = (rtapi_s64 *)hal_malloc(hm2->encoder.num_instances * sizeof(rtapi_s64));
+    hm2->encoder.reg_timestamp = (rtapi_u16 *)hal_malloc(hm2->encoder.num_instances * sizeof(rtapi_u16));
+    if ((hm2->encoder.rawcounts_64 == NULL) || (hm2->encoder.prev_rawcounts_64 == NULL) || (hm2->encoder.reg_timestamp == NULL)) {
+        HM2_ERR("out of memory!\n");
+        r = -ENOMEM;
+        goto fail0;
+    }
+
     hm2->encoder.stride = md->register_stride;
     hm2->encoder.clock_frequency = md->clock_freq;
     hm2->encoder.version = md->version;
@@ -751,7 +760,8 @@ void hm2_encoder_tram_init(hostmot2_t *hm2) {
 
         *hm2->encoder.instance[i].hal.pin.rawcounts = count;
         *hm2->encoder.instance[i].hal.pin.rawlatch = count;
-        hm2->encoder.instance[i].rawcounts_64 = count;
+        hm2->encoder.rawcounts_64[i] = count;
+        hm2->encoder.prev_rawcounts_64[i] = count;
         hm2->encoder.instance[i].rawlatch_64 = count;
 
         *hm2->encoder.instance[i].hal.pin.count = 0;
@@ -766,8 +776,6 @@ void hm2_encoder_tram_init(hostmot2_t *hm2) {
  
         hm2->encoder.instance[i].zero_offset = count;
 
-        hm2->encoder.instance[i].prev_reg_count = count;
-
         hm2->encoder.instance[i].zero_offset_64 = count;
 
 
@@ -783,16 +791,47 @@ void hm2_encoder_tram_init(hostmot2_t *hm2) {
 
 
 /**
- * @brief Updates the encoder's rawcounts accumulator, and checks for index pulse if appropriate.
+ * @brief Extends the count registers of n instances into their 64-bit
+ *     rawcounts, and splits off the timestamps.
+ *
+ * Sets these variables, for all instances:
+ *
+ *     .prev_rawcounts_64
+ *     .rawcounts_64
+ *     .reg_timestamp
+ *
+ * This function expects the TRAM read to have just finished, so that
+ * counter_reg[] is up-to-date.  It is a single pass over contiguous
+ * arrays with no branches, which the compiler can vectorize, and it
+ * leaves the instances nothing to do with the count register but
+ * compare rawcounts_64 with prev_rawcounts_64.
+ */
+
+static void hm2_encoder_update_rawcounts(int n, const rtapi_u32 *restrict reg,
+        rtapi_s64 *restrict rawcounts, rtapi_s64 *restrict prev_rawcounts,
+        rtapi_u16 *restrict timestamp) {
+    int i;
+
+    for (i = 0; i < n; i ++) {
+        prev_rawcounts[i] = rawcounts[i];
+        rawcounts[i] = hal_extend_counter(rawcounts[i], reg[i] & 0x0000ffff, 16);
+        timestamp[i] = (reg[i] >> 16) & 0x0000ffff;
+    }
+}
+
+
+
+
+/**
+ * @brief Updates the encoder's rawcounts pin, and checks for index pulse if appropriate.
  *
  * Sets these variables:
  *
  *     hal.pin.rawcounts
- *     .prev_reg_count
  *     (maybe) .index_enabled and .zero_offset
  *
- * This function expects the TRAM read to have just finished, so that
- * counter_reg[i] is up-to-date.
+ * This function expects hm2_encoder_update_rawcounts() to have just
+ * run, so that rawcounts_64[i] and prev_rawcounts_64[i] are up-to-date.
  *
  * May read the Latch register (if searching for the Index pulse).
  *
@@ -802,23 +841,14 @@ void hm2_encoder_tram_init(hostmot2_t *hm2) {
  */
 
 static void hm2_encoder_instance_update_rawcounts_and_handle_index(hostmot2_t *hm2, int instance) {
-    rtapi_u16 reg_count;
     rtapi_s64 prev_rawcounts_64;
 
     hm2_encoder_instance_t *e;
 
     e = &hm2->encoder.instance[instance];
-    prev_rawcounts_64 = e->rawcounts_64;
+    prev_rawcounts_64 = hm2->encoder.prev_rawcounts_64[instance];
 
-
-    //
-    // figure out current rawcounts accumulated by the driver
-    //
-
-    reg_count = hm2_encoder_get_reg_count(hm2, instance);
-
-    e->rawcounts_64 = hal_extend_counter(e->rawcounts_64, reg_count, 16);
-    *e->hal.pin.rawcounts = (rtapi_s32)e->rawcounts_64;
+    *e->hal.pin.rawcounts = (rtapi_s32)hm2->encoder.rawcounts_64[instance];
 
 
     //
@@ -872,8 +902,6 @@ static void hm2_encoder_instance_update_rawcounts_and_handle_index(hostmot2_t *h
             }
         }
     }
-
-    e->prev_reg_count = reg_count;
 }
 
 
@@ -886,7 +914,6 @@ static void hm2_encoder_instance_update_rawcounts_and_handle_index(hostmot2_t *h
  *
  *     hal.pin.count
  *     hal.pin.position
- *     .prev_reg_count
  *     .zero_offset (if hal.pin.reset is True)
  *
  * This function expects the TRAM read and (if appropriate) the
@@ -915,7 +942,7 @@ static void hm2_encoder_instance_update_position(hostmot2_t *hm2, int instance)
 
     if (*e->hal.pin.reset) {
         e->zero_offset = *e->hal.pin.rawcounts;
-        e->zero_offset_64 = e->rawcounts_64;
+        e->zero_offset_64 = hm2->encoder.rawcounts_64[instance];
         *e->hal.pin.rawlatch = e->zero_offset;
         e->rawlatch_64 = e->zero_offset_64;
         *e->hal.pin.position_interpolated = *e->hal.pin.position;
@@ -931,7 +958,7 @@ static void hm2_encoder_instance_update_position(hostmot2_t *hm2, int instance)
     //
 
     *e->hal.pin.count = *e->hal.pin.rawcounts - e->zero_offset;
-    e->count_64 = e->rawcounts_64 - e->zero_offset_64;
+    e->count_64 = hm2->encoder.rawcounts_64[instance] - e->zero_offset_64;
     *e->hal.pin.count_latch = *e->hal.pin.rawlatch - e->zero_offset;
     e->count_latch_64 = e->rawlatch_64 - e->zero_offset_64;
 
@@ -969,11 +996,8 @@ static void hm2_encoder_instance_process_tram_read(hostmot2_t *hm2, int instance
     switch (e->state) {
 
         case HM2_ENCODER_STOPPED: {
-            rtapi_u16 reg_count;  // the count currently in the register
-
-            // get current count from the FPGA (already read)
-            reg_count = hm2_encoder_get_reg_count(hm2, instance);
-            if (reg_count == e->prev_reg_count
+            // the count from the FPGA is already in rawcounts_64
+            if (hm2->encoder.rawcounts_64[instance] == hm2->encoder.prev_rawcounts_64[instance]
 			&& !(e->prev_control & (HM2_ENCODER_LATCH_ON_INDEX | HM2_ENCODER_LATCH_ON_PROBE))) {
                 // still not moving, but .reset can change the position
                 hm2_encoder_instance_update_position(hm2, instance);
@@ -986,7 +1010,7 @@ static void hm2_encoder_instance_process_tram_read(hostmot2_t *hm2, int instance
             hm2_encoder_instance_update_position(hm2, instance);
 
             e->prev_event_rawcounts = *e->hal.pin.rawcounts;
-            e->prev_event_reg_timestamp = hm2_encoder_get_reg_timestamp(hm2, instance);
+            e->prev_event_reg_timestamp = hm2->encoder.reg_timestamp[instance];
             e->prev_dS_counts = 0;
 
             e->tsc_num_rollovers = 0;
@@ -1000,7 +1024,6 @@ static void hm2_encoder_instance_process_tram_read(hostmot2_t *hm2, int instance
 
 
         case HM2_ENCODER_MOVING: {
-            rtapi_u16 reg_count;  // the count currently in the register
             rtapi_u16 time_of_interest;  // terrible variable name, sorry
 
             rtapi_s32 dT_clocks;
@@ -1009,9 +1032,8 @@ static void hm2_encoder_instance_process_tram_read(hostmot2_t *hm2, int instance
             rtapi_s32 dS_counts;
             double dS_pos_units;
 
-            // get current count from the FPGA (already read)
-            reg_count = hm2_encoder_get_reg_count(hm2, instance);
-            if (reg_count == e->prev_reg_count) {
+            // the count from the FPGA is already in rawcounts_64
+            if (hm2->encoder.rawcounts_64[instance] == hm2->encoder.prev_rawcounts_64[instance]) {
                 double vel;
 
                 //
@@ -1077,7 +1099,7 @@ static void hm2_encoder_instance_process_tram_read(hostmot2_t *hm2, int instance
                 hm2_encoder_instance_update_rawcounts_and_handle_index(hm2, instance);
                 hm2_encoder_instance_update_position(hm2, instance);
                 *e->hal.pin.position_interpolated = *e->hal.pin.position;
-                time_of_interest = hm2_encoder_get_reg_timestamp(hm2, instance);
+                time_of_interest = hm2->encoder.reg_timestamp[instance];
                 if (time_of_interest < e->prev_time_of_interest) {
                     // tsc rollover!
                     e->tsc_num_rollovers ++;
@@ -1143,6 +1165,8 @@ void hm2_encoder_process_tram_read(hostmot2_t *hm2, long l_period_ns) {
 
     if (hm2->encoder.num_instances <= 0) return;
     hm2_encoder_read_control_register(hm2);
+    hm2_encoder_update_rawcounts(hm2->encoder.num_instances, hm2->encoder.counter_reg,
+            hm2->encoder.rawcounts_64, hm2->encoder.prev_rawcounts_64, hm2->encoder.reg_timestamp);
 
     // process each encoder instance independently
     for (i = 0; i < hm2->encoder.num_instances; i ++) {
@@ -910,6 +910,8 @@ static int hm2_eth_read(hm2_lowlevel_io_t *this, rtapi_u32 addr, void *buffer, i
     return 1;  // success
 }
 
+static int hm2_eth_send_write_packet(hm2_eth_t *board);
+
 static void hm2_eth_reset_queued_reads(hm2_eth_t *board){
     board->read_packet_ptr = board->read_packet;
     board->queue_reads_count = 0;
@@ -962,6 +964,26 @@ static int hm2_eth_send_queued_reads(hm2_lowlevel_io_t *this) {
     board->queue_reads_count++;
     board->queue_buff_size += sizeof(board->confirm_rw_cnt);
 
+    if (board->write_pending) {
+        // the last cycle's writes go in front of the reads, in one packet
+        // if they fit
+        size_t write_packet_size = board->write_packet_ptr - board->write_packet;
+        size_t read_packet_size = board->read_packet_ptr - board->read_packet;
+        board->write_pending = 0;
+        if (write_packet_size + read_packet_size <= sizeof(board->write_packet)) {
+            memcpy(board->write_packet_ptr, board->read_packet, read_packet_size);
+            send = eth_socket_send(board, (void*) &board->write_packet, write_packet_size + read_packet_size);
+            board->write_packet_ptr = board->write_packet;
+            if(send < 0) {
+                LL_PRINT("ERROR: sending packet: %s\n", strerror(errno));
+                return 0;
+            }
+            return 1;
+        }
+        if (!hm2_eth_send_write_packet(board))
+            return 0;
+    }
+
     send = eth_socket_send(board, (void*) &board->read_packet, board->read_packet_ptr - board->read_packet);
     if(send < 0) {
         LL_PRINT("ERROR: sending packet: %s\n", strerror(errno));
@@ -1126,9 +1148,22 @@ static int hm2_eth_write(hm2_lowlevel_io_t *this, rtapi_u32 addr, const void *bu
     return 1;  // success
 }
 
-static int hm2_eth_send_queued_writes(hm2_lowlevel_io_t *this) {
+static int hm2_eth_send_write_packet(hm2_eth_t *board) {
     int send;
     long long t0, t1;
+
+    t0 = rtapi_get_time();
+    send = eth_socket_send(board, (void*) &board->write_packet, board->write_packet_ptr - board->write_packet);
+    if(send < 0) {
+        LL_PRINT("ERROR: sending packet: %s\n", strerror(errno));
+    }
+    t1 = rtapi_get_time();
+    LL_PRINT_IF(debug, "enqueue_write(%d) : PACKET SEND [SIZE: %d | TIME: %llu]\n", board->write_cnt, send, t1 - t0);
+    board->write_packet_ptr = board->write_packet;
+    return send < 0 ? 0 : 1;
+}
+
+static int hm2_eth_send_queued_writes(hm2_lowlevel_io_t *this) {
     hm2_eth_t *board = this->private;
 
     //Check size we are going to write
@@ -1137,6 +1172,7 @@ static int hm2_eth_send_queued_writes(hm2_lowlevel_io_t *this) {
         LL_PRINT("ERROR: send_queued_writes: buffer full, dropping all data\n");
         //We need to drop the data to recover
         board->write_packet_ptr = board->write_packet;
+        board->write_pending = 0;
         return 0;
     }
 
@@ -1147,16 +1183,16 @@ static int hm2_eth_send_queued_writes(hm2_lowlevel_io_t *this) {
     memcpy(board->write_packet_ptr, &board->write_cnt, sizeof(board->write_cnt));
     board->write_packet_ptr += sizeof(board->write_cnt);
     board->has_written_cnt = 1;
-    
-    t0 = rtapi_get_time();
-    send = eth_socket_send(board, (void*) &board->write_packet, board->write_packet_ptr - board->write_packet);
-    if(send < 0) {
-        LL_PRINT("ERROR: sending packet: %s\n", strerror(errno));
+
+    // Hold the writes for the next read request, unless writes held from
+    // an earlier cycle never went out with one.
+    if (board->hal && board->hal->write_with_read && rtapi_task_self() >= 0
+            && !board->write_pending) {
+        board->write_pending = 1;
+        return 1;
     }
-    t1 = rtapi_get_time();
-    LL_PRINT_IF(debug, "enqueue_write(%d) : PACKET SEND [SIZE: %d | TIME: %llu]\n", board->write_cnt, send, t1 - t0);
-    board->write_packet_ptr = board->write_packet;
-    return send < 0 ? 0 : 1;
+    board->write_pending = 0;
+    return hm2_eth_send_write_packet(board);
 }
 
 static int hm2_eth_enqueue_write(hm2_lowlevel_io_t *this, rtapi_u32 addr, const void *buffer, int size) {
@@ -1650,6 +1686,14 @@ static int hm2_eth_items(hm2_eth_t *board) {
         return r;
     board->hal->packet_error_decrement = 1;
 
+    if((r = hal_param_bit_newf(HAL_RW,
+            &board->hal->write_with_read,
+            board->llio.comp_id,
+            "%s.packet-write-with-read",
+            board->llio.name)) < 0)
+        return r;
+    board->hal->write_with_read = 0;
+
     if((r = hal_pin_bit_newf(HAL_OUT,
             &board->hal->packet_error,
             board->llio.comp_id,
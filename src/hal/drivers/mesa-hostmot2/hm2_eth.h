@@ -77,6 +77,9 @@ struct hm2_eth_t {
     } confirm_rw_cnt;
     // Set when a queued write has set write_cnt in the board
     int has_written_cnt;
+    // Set while the queued writes wait to go out in front of the next
+    // read request, see packet-write-with-read
+    int write_pending;
 
     int comm_error_counter;
     uint16_t old_rxudpcount, rxudpcount;
@@ -87,6 +90,7 @@ struct hm2_eth_t {
         hal_s32_t packet_error_limit;
         hal_s32_t packet_error_increment;
         hal_s32_t packet_error_decrement;
+        hal_bit_t write_with_read;
         hal_bit_t *packet_error;
         hal_u32_t *packet_error_total;
         hal_s32_t *packet_error_level;
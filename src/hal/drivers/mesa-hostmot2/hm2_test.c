@@ -69,6 +69,61 @@ static void set32(hm2_test_t *me, uint16_t addr, uint32_t val) {
     me->test_pattern.tp32[addr/4] = val;
 }
 
+static void set_md(
+    hm2_test_t *me,
+    int index,
+    uint8_t gtag,
+    uint8_t version,
+    uint8_t clock_tag,
+    uint8_t instances,
+    uint16_t base_address,
+    uint8_t num_registers,
+    uint8_t instance_stride,
+    uint32_t multiple_registers
+) {
+    uint16_t addr = 0x440 + (index * 12);
+
+    set32(me, addr + 0, gtag | (version << 8) | (clock_tag << 16) | (instances << 24));
+    set32(me, addr + 4, base_address | (num_registers << 16) | (instance_stride << 28));
+    set32(me, addr + 8, multiple_registers);
+}
+
+static void set_pd(hm2_test_t *me, int pin, uint8_t sec_pin, uint8_t sec_tag, uint8_t sec_unit) {
+    set8(me, 0x600 + (pin * 4) + 0, sec_pin);
+    set8(me, 0x600 + (pin * 4) + 1, sec_tag);
+    set8(me, 0x600 + (pin * 4) + 2, sec_unit);
+    set8(me, 0x600 + (pin * 4) + 3, HM2_GTAG_IOPORT);
+}
+
+
+//
+// The full board of test pattern 15 keeps its encoders and stepgens
+// turning, so that the driver has new counts to process every cycle.
+// The encoders' timestamp counter is read once per read cycle, so that
+// is when everything moves on.
+//
+
+#define FULL_NUM_INSTANCES (8)
+#define FULL_STEPGEN_ADDR (0x2000)
+#define FULL_ENCODER_ADDR (0x3000)
+
+static void hm2_test_move(hm2_test_t *me) {
+    rtapi_u32 *tp32 = me->test_pattern.tp32;
+    rtapi_u32 timestamp;
+    int i;
+
+    timestamp = (tp32[(FULL_ENCODER_ADDR + 0x300) / 4] + 100) & 0xFFFF;
+    tp32[(FULL_ENCODER_ADDR + 0x300) / 4] = timestamp;
+
+    for (i = 0; i < FULL_NUM_INSTANCES; i ++) {
+        rtapi_u32 *counter = &tp32[(FULL_ENCODER_ADDR / 4) + i];
+        rtapi_u32 *accumulator = &tp32[((FULL_STEPGEN_ADDR + 0x100) / 4) + i];
+
+        *counter = (timestamp << 16) | ((*counter + i + 1) & 0xFFFF);
+        *accumulator += (i + 1) << 12;
+    }
+}
+
 
 // 
 // these are the "low-level I/O" functions exported up
@@ -77,6 +132,9 @@ static void set32(hm2_test_t *me, uint16_t addr, uint32_t val) {
 
 static int hm2_test_read(hm2_lowlevel_io_t *this, rtapi_u32 addr, void *buffer, int size) {
     hm2_test_t *me = this->private;
+    if (me->moving && addr == FULL_ENCODER_ADDR + 0x300) {
+        hm2_test_move(me);
+    }
     memcpy(buffer, &me->test_pattern.tp8[addr], size);
     return 1;  // success
 }
@@ -557,6 +615,117 @@ int rtapi_app_main(void) {
             break;
         }
 
+        //
+        // A complete, working board: a watchdog, 8 encoders, 8 stepgens,
+        // 8 pwmgens and a smart-serial port with two 7i64 and two 8i20
+        // remotes, on four 24-pin connectors, with the unused pins left
+        // as GPIOs.  The remotes are of the old kind that do not describe
+        // themselves, so the driver finds them by their names alone.
+        // Together with "enable_profile" in the config string this is a
+        // bench for the cost of each part of hm2_read() and hm2_write().
+        //
+
+        case 15: {
+            int i;
+
+            set32(me, HM2_ADDR_IOCOOKIE, HM2_IOCOOKIE);
+            set8(me, HM2_ADDR_CONFIGNAME+0, 'H');
+            set8(me, HM2_ADDR_CONFIGNAME+1, 'O');
+            set8(me, HM2_ADDR_CONFIGNAME+2, 'S');
+            set8(me, HM2_ADDR_CONFIGNAME+3, 'T');
+            set8(me, HM2_ADDR_CONFIGNAME+4, 'M');
+            set8(me, HM2_ADDR_CONFIGNAME+5, 'O');
+            set8(me, HM2_ADDR_CONFIGNAME+6, 'T');
+            set8(me, HM2_ADDR_CONFIGNAME+7, '2');
+            set32(me, HM2_ADDR_IDROM_OFFSET, 0x400); // put the IDROM at 0x400, where it usually lives
+            set32(me, 0x400, 2); // standard idrom type
+
+            // normal offset to Module Descriptors
+            set32(me, 0x404, 64);
+
+            // normal offset to PinDescriptors
+            set32(me, 0x408, 0x200);
+
+            // IOPorts
+            set32(me, 0x41c, 4);
+
+            // IOWidth
+            set32(me, 0x420, 4*24);
+
+            // PortWidth
+            set32(me, 0x424, 24);
+
+            // ClockLow = 100 MHz
+            set32(me, 0x428, 100e6);
+
+            // ClockHigh = 200 MHz
+            set32(me, 0x42c, 200e6);
+
+            // InstanceStride0 and 1
+            set32(me, 0x430, 4);
+            set32(me, 0x434, 0x40);
+
+            // RegisterStride0 and 1
+            set32(me, 0x438, 0x100);
+            set32(me, 0x43c, 0x100);
+
+            set_md(me, 0, HM2_GTAG_WATCHDOG,    0, 1, 1,                  0x0C00, 3,  0, 0x0000);
+            set_md(me, 1, HM2_GTAG_IOPORT,      0, 1, 4,                  0x1000, 5,  0, 0x001F);
+            set_md(me, 2, HM2_GTAG_STEPGEN,     2, 1, FULL_NUM_INSTANCES, FULL_STEPGEN_ADDR, 10, 0, 0x01FF);
+            set_md(me, 3, HM2_GTAG_ENCODER,     3, 1, FULL_NUM_INSTANCES, FULL_ENCODER_ADDR, 5, 0, 0x0003);
+            set_md(me, 4, HM2_GTAG_PWMGEN,      0, 2, FULL_NUM_INSTANCES, 0x4000, 5,  0, 0x0003);
+            set_md(me, 5, HM2_GTAG_SMARTSERIAL, 0, 1, 1,                  0x5B00, 6,  1, 0x003C);
+
+            // P1: encoders
+            for (i = 0; i < FULL_NUM_INSTANCES; i ++) {
+                set_pd(me, (i * 3) + 0, 0x01, HM2_GTAG_ENCODER, i);  // A
+                set_pd(me, (i * 3) + 1, 0x02, HM2_GTAG_ENCODER, i);  // B
+                set_pd(me, (i * 3) + 2, 0x03, HM2_GTAG_ENCODER, i);  // Index
+            }
+
+            // P2: stepgens, then GPIOs
+            for (i = 0; i < FULL_NUM_INSTANCES; i ++) {
+                set_pd(me, 24 + (i * 2) + 0, 0x81, HM2_GTAG_STEPGEN, i);  // Step
+                set_pd(me, 24 + (i * 2) + 1, 0x82, HM2_GTAG_STEPGEN, i);  // Direction
+            }
+            for (i = 24 + (FULL_NUM_INSTANCES * 2); i < 48; i ++) {
+                set_pd(me, i, 0, 0, 0);
+            }
+
+            // P3: pwmgens
+            for (i = 0; i < FULL_NUM_INSTANCES; i ++) {
+                set_pd(me, 48 + (i * 3) + 0, 0x81, HM2_GTAG_PWMGEN, i);  // Out0
+                set_pd(me, 48 + (i * 3) + 1, 0x82, HM2_GTAG_PWMGEN, i);  // Out1
+                set_pd(me, 48 + (i * 3) + 2, 0x83, HM2_GTAG_PWMGEN, i);  // Enable
+            }
+
+            // P4: four smart-serial channels, then GPIOs
+            for (i = 0; i < 4; i ++) {
+                set_pd(me, 72 + (i * 2) + 0, 0x01 + i, HM2_GTAG_SMARTSERIAL, 0);  // rx
+                set_pd(me, 72 + (i * 2) + 1, 0x81 + i, HM2_GTAG_SMARTSERIAL, 0);  // tx
+            }
+            for (i = 72 + 8; i < 96; i ++) {
+                set_pd(me, i, 0, 0, 0);
+            }
+
+            // the remotes' serial numbers and names, in the first two
+            // interface registers of their channels
+            for (i = 0; i < 4; i ++) {
+                set32(me, 0x5E00 + (i * 4), 0x1210 + i);
+                set32(me, 0x5F00 + (i * 4), (i < 2) ? HM2_SSERIAL_TYPE_7I64 : HM2_SSERIAL_TYPE_8I20);
+            }
+
+            me->llio.num_ioport_connectors = 4;
+            me->llio.ioport_connector_name[0] = "P1";
+            me->llio.ioport_connector_name[1] = "P2";
+            me->llio.ioport_connector_name[2] = "P3";
+            me->llio.ioport_connector_name[3] = "P4";
+
+            me->moving = 1;
+
+            break;
+        }
+
         default: {
             LL_ERR("unknown test pattern %d", test_pattern); 
             return -ENODEV;
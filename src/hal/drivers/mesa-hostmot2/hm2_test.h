@@ -28,6 +28,8 @@ typedef struct {
         rtapi_u32 tp32[16 * 1024];
     } test_pattern;
 
+    int moving;  // advance the encoder and stepgen counts on each read
+
     hm2_lowlevel_io_t llio;
 } hm2_test_t;
 
@@ -94,6 +94,7 @@ static void hm2_read_request(void *void_hm2, long period) {
 static void hm2_read(void *void_hm2, long period) {
     hostmot2_t *hm2 = void_hm2;
 
+    hm2_profile_start(hm2);
     if(!hm2->llio->read_requested) hm2_read_request(void_hm2, period);
     hm2->llio->read_requested = false;
 
@@ -102,24 +103,40 @@ static void hm2_read(void *void_hm2, long period) {
     // if there's a temporary read failure, don't sweat it
     if(hm2_finish_read(hm2) == -EAGAIN) return;
     if ((*hm2->llio->io_error) != 0) return;
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_TRAM);
 
     hm2_watchdog_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_WATCHDOG);
     hm2_ioport_gpio_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_IOPORT);
     hm2_encoder_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_ENCODER);
     hm2_inmux_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_INMUX);
     hm2_inm_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_INM);
     hm2_xy2mod_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_XY2MOD);
     hm2_resolver_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_RESOLVER);
     hm2_stepgen_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_STEPGEN);
     hm2_sserial_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_SSERIAL);
     hm2_bspi_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_BSPI);
     hm2_absenc_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_ABSENC);
     hm2_oneshot_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_ONESHOT);
     hm2_periodm_process_tram_read(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_PERIODM);
     //UARTS PktUARTS need to be explicitly handled by an external component
 
     hm2_tp_pwmgen_process_read(hm2); // check the status of the fault bit
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_TP_PWMGEN);
     hm2_dpll_process_tram_read(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_READ_DPLL);
 }
 
 
@@ -134,23 +151,40 @@ static void hm2_write(void *void_hm2, long period) {
         hm2->ddr_initialized = true;
     }
 
+    hm2_profile_start(hm2);
+
     hm2_watchdog_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_WATCHDOG);
     hm2_ioport_gpio_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_IOPORT);
     hm2_pwmgen_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_PWMGEN);
     hm2_oneshot_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_ONESHOT);
     hm2_periodm_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_PERIODM);
     hm2_rcpwmgen_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_RCPWMGEN);
     hm2_inmux_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_INMUX);
     hm2_inm_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_INM);
     hm2_tp_pwmgen_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_TP_PWMGEN);
     hm2_stepgen_prepare_tram_write(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_STEPGEN);
     hm2_sserial_prepare_tram_write(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_SSERIAL);
     hm2_bspi_prepare_tram_write(hm2, period);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_BSPI);
     hm2_ssr_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_SSR);
     hm2_outm_prepare_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_OUTM);
 
     //UARTS need to be explicitly handled by an external component
     hm2_tram_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_TRAM);
 
     // these usually do nothing
     // they only write to the FPGA if certain pins & params have changed
@@ -172,9 +206,11 @@ static void hm2_write(void *void_hm2, long period) {
     hm2_dpll_write(hm2, period); // Update the timer phases
     hm2_led_write(hm2);	      // Update on-board LEDs
     hm2_ssr_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_REGISTERS);
 
     hm2_raw_write(hm2);
     hm2_finish_write(hm2);
+    hm2_profile_mark(hm2, HM2_PROFILE_WRITE_FINISH);
 }
 
 
@@ -411,6 +447,7 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
     hm2->config.num_oneshots = -1;
     hm2->config.num_periodms = -1;
     hm2->config.enable_raw = 0;
+    hm2->config.enable_profile = 0;
     hm2->config.firmware = NULL;
 
     if (config_string == NULL) return 0;
@@ -549,6 +586,9 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
         } else if (strncmp(token, "enable_raw", 10) == 0) {
             hm2->config.enable_raw = 1;
 
+        } else if (strncmp(token, "enable_profile", 14) == 0) {
+            hm2->config.enable_profile = 1;
+
         } else if (strncmp(token, "firmware=", 9) == 0) {
             // FIXME: we leak this in hm2_register
             hm2->config.firmware = rtapi_kstrdup(token + 9, RTAPI_GFP_KERNEL);
@@ -589,6 +629,7 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
     HM2_DBG("    num_uarts=%d\n", hm2->config.num_uarts);
     HM2_DBG("    num_pktuarts=%d\n", hm2->config.num_pktuarts);
     HM2_DBG("    enable_raw=%d\n",   hm2->config.enable_raw);
+    HM2_DBG("    enable_profile=%d\n", hm2->config.enable_profile);
     HM2_DBG("    firmware=%s\n",   hm2->config.firmware ? hm2->config.firmware : "(NULL)");
 
     rtapi_argv_free(argv);
@@ -1568,6 +1609,11 @@ int hm2_register(hm2_lowlevel_io_t *llio, char *config_string) {
         goto fail1;
     }
 
+    r = hm2_tram_write_export_hal(hm2);
+    if (r < 0) {
+        goto fail1;
+    }
+
 
     //
     // At this point, all register buffers have been allocated.
@@ -1600,6 +1646,16 @@ int hm2_register(hm2_lowlevel_io_t *llio, char *config_string) {
     }
 
 
+    //
+    // optionally time each step of the read and write functions
+    //
+
+    r = hm2_profile_setup(hm2);
+    if (r != 0) {
+        goto fail1;
+    }
+
+
     //
     // At this point, all non-TRAM register buffers have been initialized
     // and all HAL objects have been allocated and exported to HAL.
@@ -1826,6 +1882,7 @@ void rtapi_app_exit(void) {
 void hm2_force_write(hostmot2_t *hm2) {
     if (hm2->llio->set_force_enqueue != NULL)
         hm2->llio->set_force_enqueue(hm2->llio, 1);
+    hm2_tram_write_invalidate(hm2);
     hm2_watchdog_force_write(hm2);
     hm2_ioport_force_write(hm2);
     hm2_encoder_force_write(hm2);
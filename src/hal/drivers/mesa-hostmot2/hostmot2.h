@@ -319,14 +319,12 @@ typedef struct {
     rtapi_s32 zero_offset;     // *hal.pin.counts == (*hal.pin.rawcounts - zero_offset)
     // 64-bit internals prevent float position wrap on high-count encoders.
     // Not exposed as HAL pins; s32 pins above are truncated views.
-    rtapi_s64 rawcounts_64;
+    // The raw count itself is in hm2_encoder_t.rawcounts_64[].
     rtapi_s64 rawlatch_64;
     rtapi_s64 count_64;
     rtapi_s64 count_latch_64;
     rtapi_s64 zero_offset_64;
 
-    rtapi_u16 prev_reg_count;  // from this and the current count in the register we compute a change-in-counts, which we add to rawcounts
-
     rtapi_s32 prev_dS_counts;  // last time the function ran, it saw this many counts from the time before *that*
 
     rtapi_u32 prev_control;
@@ -364,6 +362,12 @@ typedef struct {
 
     hm2_encoder_instance_t *instance;
 
+    // The counter state of all the instances, side by side so that each
+    // read can bring it up to date from counter_reg[] in one pass.
+    rtapi_s64 *rawcounts_64;       // the count register extended to 64 bits
+    rtapi_s64 *prev_rawcounts_64;  // rawcounts_64 before this read
+    rtapi_u16 *reg_timestamp;      // the timestamp of the latest count
+
     rtapi_u32 stride;
     rtapi_u32 clock_frequency;
     rtapi_u8 version;
@@ -1249,11 +1253,6 @@ typedef struct {
     // computing the feedforward velocity
     hal_float_t old_position_cmd;
 
-    rtapi_u32 prev_accumulator;
-
-    // this is a 48.16 signed fixed-point representation of the current
-    // stepgen position (16 bits of sub-step resolution)
-    rtapi_s64 subcounts;
     rtapi_s32 zero_offset;
 
     rtapi_u32 written_steplen;
@@ -1283,6 +1282,14 @@ typedef struct {
     int num_instances;
     hm2_stepgen_instance_t *instance;
 
+    // The feedback state of all the instances, side by side so that each
+    // read can do its arithmetic in passes over whole arrays.
+    rtapi_u32 *prev_accumulator;
+    // a 48.16 signed fixed-point representation of the current
+    // stepgen position (16 bits of sub-step resolution)
+    rtapi_s64 *subcounts;
+    rtapi_s64 *acc_delta;  // the accumulator change seen by this read
+
     rtapi_u32 clock_frequency;
     rtapi_u8 version;
     int firmware_supports_swap;
@@ -1611,6 +1618,62 @@ typedef struct {
 
 
 
+//
+// time spent in each step of hm2_read() and hm2_write()
+//
+
+typedef enum {
+    HM2_PROFILE_READ_TRAM,
+    HM2_PROFILE_READ_WATCHDOG,
+    HM2_PROFILE_READ_IOPORT,
+    HM2_PROFILE_READ_ENCODER,
+    HM2_PROFILE_READ_INMUX,
+    HM2_PROFILE_READ_INM,
+    HM2_PROFILE_READ_XY2MOD,
+    HM2_PROFILE_READ_RESOLVER,
+    HM2_PROFILE_READ_STEPGEN,
+    HM2_PROFILE_READ_SSERIAL,
+    HM2_PROFILE_READ_BSPI,
+    HM2_PROFILE_READ_ABSENC,
+    HM2_PROFILE_READ_ONESHOT,
+    HM2_PROFILE_READ_PERIODM,
+    HM2_PROFILE_READ_TP_PWMGEN,
+    HM2_PROFILE_READ_DPLL,
+
+    HM2_PROFILE_WRITE_WATCHDOG,
+    HM2_PROFILE_WRITE_IOPORT,
+    HM2_PROFILE_WRITE_PWMGEN,
+    HM2_PROFILE_WRITE_ONESHOT,
+    HM2_PROFILE_WRITE_PERIODM,
+    HM2_PROFILE_WRITE_RCPWMGEN,
+    HM2_PROFILE_WRITE_INMUX,
+    HM2_PROFILE_WRITE_INM,
+    HM2_PROFILE_WRITE_TP_PWMGEN,
+    HM2_PROFILE_WRITE_STEPGEN,
+    HM2_PROFILE_WRITE_SSERIAL,
+    HM2_PROFILE_WRITE_BSPI,
+    HM2_PROFILE_WRITE_SSR,
+    HM2_PROFILE_WRITE_OUTM,
+    HM2_PROFILE_WRITE_TRAM,
+    HM2_PROFILE_WRITE_REGISTERS,
+    HM2_PROFILE_WRITE_FINISH,
+
+    HM2_PROFILE_NUM_STEPS
+} hm2_profile_step_t;
+
+typedef struct {
+    hal_s32_t *time;
+    hal_s32_t tmax;
+} hm2_profile_hal_t;
+
+typedef struct {
+    hm2_profile_hal_t *hal;  // one per step
+    rtapi_s64 last;          // when the previous step ended
+} hm2_profile_t;
+
+
+
+
 // 
 // this struct hold an entry in our Translation RAM region list
 //
@@ -1619,9 +1682,45 @@ typedef struct {
     rtapi_u16 addr;
     rtapi_u16 size;
     rtapi_u32 **buffer;
+    int flags;
     struct rtapi_list_head list;
 } hm2_tram_entry_t;
 
+// the write itself does something in the FPGA (pets the watchdog, starts
+// a transfer, pushes into a FIFO), so it is written every cycle even if
+// its value did not change
+#define HM2_TRAM_WRITE_ALWAYS (1 << 0)
+
+
+//
+// Change tracking for the TRAM writes
+//
+// When enabled, hm2_tram_write() only queues the registers whose value
+// differs from what was last written, as runs of adjacent registers.
+// Every refresh_cycles cycles, and after the FPGA state was forced, all
+// registers are written again.
+//
+
+typedef struct {
+    struct {
+        hal_u32_t *bytes;               // register bytes queued last cycle
+        hal_u32_t *commands;            // write commands queued last cycle
+    } pin;
+
+    struct {
+        hal_bit_t suppress_unchanged;
+        hal_u32_t refresh_cycles;
+    } param;
+} hm2_tram_write_hal_t;
+
+typedef struct {
+    hm2_tram_write_hal_t *hal;
+    rtapi_u32 *shadow;          // what was last written, as tram_write_buffer
+    rtapi_u32 cycles;           // since all registers were last written
+    int full;                   // write all registers next cycle
+    int written_suppress_unchanged;
+} hm2_tram_write_t;
+
 
 
 
@@ -1657,6 +1756,7 @@ typedef struct {
         int num_periodms;
         char sserial_modes[4][8];
         int enable_raw;
+        int enable_profile;
         char *firmware;
     } config;
 
@@ -1682,6 +1782,7 @@ typedef struct {
     struct rtapi_list_head tram_write_entries;
     rtapi_u32 *tram_write_buffer;
     rtapi_u16 tram_write_size;
+    hm2_tram_write_t tram_write;
 
     // the hostmot2 "Functions"
     hm2_encoder_t encoder;
@@ -1708,6 +1809,7 @@ typedef struct {
     hm2_periodm_t periodm;
 
     hm2_raw_t *raw;
+    hm2_profile_t profile;
 
     bool ddr_initialized;
 
@@ -1759,7 +1861,10 @@ int hm2_get_pktuart(hostmot2_t **hm2, const char *name);
 
 int hm2_register_tram_read_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer);
 int hm2_register_tram_write_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer);
+int hm2_register_tram_write_region_always(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer);
 int hm2_allocate_tram_regions(hostmot2_t *hm2);
+int hm2_tram_write_export_hal(hostmot2_t *hm2);
+void hm2_tram_write_invalidate(hostmot2_t *hm2);
 int hm2_tram_read(hostmot2_t *hm2);
 int hm2_finish_read(hostmot2_t *hm2);
 int hm2_queue_read(hostmot2_t *hm2);
@@ -2100,6 +2205,15 @@ void hm2_raw_queue_read(hostmot2_t *hm2);
 void hm2_raw_write(hostmot2_t *hm2);
 
 
+//
+// profiling times the steps of the read and write functions
+//
+
+int hm2_profile_setup(hostmot2_t *hm2);
+void hm2_profile_start(hostmot2_t *hm2);
+void hm2_profile_mark(hostmot2_t *hm2, hm2_profile_step_t step);
+
+
 
 
 // write all settings out to the FPGA
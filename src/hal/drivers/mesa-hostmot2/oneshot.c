@@ -248,7 +248,7 @@ int hm2_oneshot_parse_md(hostmot2_t *hm2, int md_index) {
         goto fail0;
     }
 
-    r = hm2_register_tram_write_region(hm2, hm2->oneshot.control_addr, (hm2->oneshot.num_instances * sizeof(rtapi_u32)), &hm2->oneshot.control_reg);
+    r = hm2_register_tram_write_region_always(hm2, hm2->oneshot.control_addr, (hm2->oneshot.num_instances * sizeof(rtapi_u32)), &hm2->oneshot.control_reg);
     if (r < 0) {
         HM2_ERR("error registering tram write region for Control register (%d)\n", r);
         goto fail0;
@@ -0,0 +1,136 @@
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+
+//
+//  With "enable_profile" in the config string, the read and write
+//  functions note the time after each of their steps, and each step
+//  gets a .time pin and a .tmax parameter, in the same units and with
+//  the same meaning as those HAL makes for every function.  The time of
+//  a step is the time since the end of the previous step, so the steps
+//  of one function add up to nearly all of its own .time.
+//
+
+
+#include <rtapi.h>
+#include <rtapi_string.h>
+
+#include <hal.h>
+
+#include "hostmot2.h"
+
+
+static const char *hm2_profile_step_name[HM2_PROFILE_NUM_STEPS] = {
+    [HM2_PROFILE_READ_TRAM]        = "read.tram",
+    [HM2_PROFILE_READ_WATCHDOG]    = "read.watchdog",
+    [HM2_PROFILE_READ_IOPORT]      = "read.ioport",
+    [HM2_PROFILE_READ_ENCODER]     = "read.encoder",
+    [HM2_PROFILE_READ_INMUX]       = "read.inmux",
+    [HM2_PROFILE_READ_INM]         = "read.inm",
+    [HM2_PROFILE_READ_XY2MOD]      = "read.xy2mod",
+    [HM2_PROFILE_READ_RESOLVER]    = "read.resolver",
+    [HM2_PROFILE_READ_STEPGEN]     = "read.stepgen",
+    [HM2_PROFILE_READ_SSERIAL]     = "read.sserial",
+    [HM2_PROFILE_READ_BSPI]        = "read.bspi",
+    [HM2_PROFILE_READ_ABSENC]      = "read.absenc",
+    [HM2_PROFILE_READ_ONESHOT]     = "read.oneshot",
+    [HM2_PROFILE_READ_PERIODM]     = "read.periodm",
+    [HM2_PROFILE_READ_TP_PWMGEN]   = "read.tp-pwmgen",
+    [HM2_PROFILE_READ_DPLL]        = "read.dpll",
+
+    [HM2_PROFILE_WRITE_WATCHDOG]   = "write.watchdog",
+    [HM2_PROFILE_WRITE_IOPORT]     = "write.ioport",
+    [HM2_PROFILE_WRITE_PWMGEN]     = "write.pwmgen",
+    [HM2_PROFILE_WRITE_ONESHOT]    = "write.oneshot",
+    [HM2_PROFILE_WRITE_PERIODM]    = "write.periodm",
+    [HM2_PROFILE_WRITE_RCPWMGEN]   = "write.rcpwmgen",
+    [HM2_PROFILE_WRITE_INMUX]      = "write.inmux",
+    [HM2_PROFILE_WRITE_INM]        = "write.inm",
+    [HM2_PROFILE_WRITE_TP_PWMGEN]  = "write.tp-pwmgen",
+    [HM2_PROFILE_WRITE_STEPGEN]    = "write.stepgen",
+    [HM2_PROFILE_WRITE_SSERIAL]    = "write.sserial",
+    [HM2_PROFILE_WRITE_BSPI]       = "write.bspi",
+    [HM2_PROFILE_WRITE_SSR]        = "write.ssr",
+    [HM2_PROFILE_WRITE_OUTM]       = "write.outm",
+    [HM2_PROFILE_WRITE_TRAM]       = "write.tram",
+    [HM2_PROFILE_WRITE_REGISTERS]  = "write.registers",
+    [HM2_PROFILE_WRITE_FINISH]     = "write.finish",
+};
+
+
+int hm2_profile_setup(hostmot2_t *hm2) {
+    int i, r;
+
+    if (hm2->config.enable_profile == 0) {
+        return 0;
+    }
+
+    hm2->profile.hal = (hm2_profile_hal_t *)hal_malloc(HM2_PROFILE_NUM_STEPS * sizeof(hm2_profile_hal_t));
+    if (hm2->profile.hal == NULL) {
+        HM2_ERR("out of memory!\n");
+        hm2->config.enable_profile = 0;
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < HM2_PROFILE_NUM_STEPS; i ++) {
+        hm2_profile_hal_t *hal = &hm2->profile.hal[i];
+
+        r = hal_pin_s32_newf(HAL_OUT, &(hal->time), hm2->llio->comp_id,
+                "%s.profile.%s.time", hm2->llio->name, hm2_profile_step_name[i]);
+        if (r < 0) {
+            HM2_ERR("error adding pin '%s.profile.%s.time', aborting\n", hm2->llio->name, hm2_profile_step_name[i]);
+            return r;
+        }
+
+        r = hal_param_s32_newf(HAL_RW, &(hal->tmax), hm2->llio->comp_id,
+                "%s.profile.%s.tmax", hm2->llio->name, hm2_profile_step_name[i]);
+        if (r < 0) {
+            HM2_ERR("error adding param '%s.profile.%s.tmax', aborting\n", hm2->llio->name, hm2_profile_step_name[i]);
+            return r;
+        }
+
+        *hal->time = 0;
+        hal->tmax = 0;
+    }
+
+    return 0;
+}
+
+
+void hm2_profile_start(hostmot2_t *hm2) {
+    if (hm2->config.enable_profile == 0) return;
+
+    hm2->profile.last = rtapi_get_time();
+}
+
+
+void hm2_profile_mark(hostmot2_t *hm2, hm2_profile_step_t step) {
+    hm2_profile_hal_t *hal;
+    rtapi_s64 now;
+    rtapi_s32 t;
+
+    if (hm2->config.enable_profile == 0) return;
+
+    now = rtapi_get_time();
+    t = now - hm2->profile.last;
+    hm2->profile.last = now;
+
+    hal = &hm2->profile.hal[step];
+    *hal->time = t;
+    if (t > hal->tmax) {
+        hal->tmax = t;
+    }
+}
@@ -796,7 +796,7 @@ int hm2_sserial_parse_md(hostmot2_t *hm2, int md_index){
                         inst->device_id);
                 goto fail0;}
             // Nothing happens without a "Do It" command
-            if ((r = hm2_register_tram_write_region(hm2,inst->command_reg_addr,
+            if ((r = hm2_register_tram_write_region_always(hm2,inst->command_reg_addr,
                                        sizeof(rtapi_u32),
                                        &inst->command_reg_write)) < 0){
                 HM2_ERR("error registering tram DoIt write to sserial "
@@ -1469,7 +1469,7 @@ int hm2_sserial_register_tram(hostmot2_t *hm2, hm2_sserial_remote_t *chan){
 
     // Register the TRAM WRITE
 
-    r = hm2_register_tram_write_region(hm2, chan->reg_cs_addr, sizeof(rtapi_u32),
+    r = hm2_register_tram_write_region_always(hm2, chan->reg_cs_addr, sizeof(rtapi_u32),
                                        &(chan->reg_cs_write));
     if (r < 0) { HM2_ERR("error registering tram write region for sserial"
                         "interface cs register (%d)\n", r);
@@ -1477,7 +1477,7 @@ int hm2_sserial_register_tram(hostmot2_t *hm2, hm2_sserial_remote_t *chan){
     }
     
     for (i = 0; i < chan->num_write_regs; i++) {
-        r = hm2_register_tram_write_region(hm2, chan->rw_addr[i], sizeof(rtapi_u32),
+        r = hm2_register_tram_write_region_always(hm2, chan->rw_addr[i], sizeof(rtapi_u32),
                                           &chan->write[i]);
         if (r < 0) { HM2_ERR("error registering tram read region for sserial "
                              "interface %i register (%d)\n" , i, r);
@@ -33,93 +33,127 @@
 
 
 
-// 
+//
 // read accumulator to figure out where the stepper has gotten to
-// 
+//
+// The arithmetic that every instance needs is done in passes over the
+// contiguous accumulator, delta and subcount arrays, which the compiler
+// can vectorize.  Only the scale check, the rare index and probe
+// latches and the HAL pins are handled one instance at a time.
+//
+
+// The HM2 Accumulator Register is a 16.16 bit fixed-point
+// representation of the current stepper position.
+// The fractional part gives accurate velocity at low speeds, and
+// sub-step position feedback (like sw stepgen).
+//
+// The change since the previous reading is taken modulo 2^32, as the
+// register wraps.  A change across the wrap has always been counted one
+// subcount short (modulo UINT32_MAX), so this keeps doing that.  It is
+// all 32-bit arithmetic without branches, so that the pass over all the
+// instances vectorizes.
+static inline rtapi_s32 hm2_stepgen_accumulator_delta(rtapi_u32 acc, rtapi_u32 prev) {
+    rtapi_s32 delta = (rtapi_s32)(acc - prev);
+
+    delta += (acc > prev) & (delta < 0);
+    delta -= (acc < prev) & (delta > 0);
+    return delta;
+}
+
+
+static void hm2_stepgen_accumulator_deltas(int n, const rtapi_u32 *restrict acc,
+        const rtapi_u32 *restrict prev_acc, rtapi_s64 *restrict acc_delta) {
+    int i;
+
+    for (i = 0; i < n; i ++) {
+        acc_delta[i] = hm2_stepgen_accumulator_delta(acc[i], prev_acc[i]);
+    }
+}
+
+
+static void hm2_stepgen_accumulate(int n, const rtapi_u32 *restrict acc,
+        rtapi_u32 *restrict prev_acc, const rtapi_s64 *restrict acc_delta,
+        rtapi_s64 *restrict subcounts) {
+    int i;
+
+    for (i = 0; i < n; i ++) {
+        subcounts[i] += acc_delta[i];
+        prev_acc[i] = acc[i];
+    }
+}
+
+
+static void hm2_stepgen_instance_handle_latch(hostmot2_t *hm2, int i) {
+    hm2_stepgen_instance_t *s = &hm2->stepgen.instance[i];
+    rtapi_u32 mode = hm2->stepgen.mode_reg[i] & HM2_STEPGEN_MODE_MASK;
+    rtapi_u32 latch = hm2->stepgen.mode_reg[i] & HM2_STEPGEN_LATCH_MASK;
+    rtapi_s64 latch_delta;
+
+    if (s->written_index_enable) {     // searching for index
+        if ((mode & HM2_STEPGEN_LATCH_ON_INDEX) == 0) {   // hardware index detected and position at index latched
+            latch_delta = hm2_stepgen_accumulator_delta(latch, hm2->stepgen.prev_accumulator[i]);
+            *s->hal.pin.position_latch = ((double)(hm2->stepgen.subcounts[i]+latch_delta) / 65536.0) / s->hal.param.position_scale;
+            hm2->stepgen.acc_delta[i] -= latch_delta;
+            hm2->stepgen.subcounts[i] = 0;
+            *s->hal.pin.index_enable = 0;
+            s->written_index_enable = 0;
+        }
+    } else if (s->written_probe_enable) {
+        if ((mode & HM2_STEPGEN_LATCH_ON_PROBE) == 0) {
+            latch_delta = hm2_stepgen_accumulator_delta(latch, hm2->stepgen.prev_accumulator[i]);
+            *s->hal.pin.position_latch = ((double)(hm2->stepgen.subcounts[i]+latch_delta) / 65536.0) / s->hal.param.position_scale;
+            *s->hal.pin.latch_enable = 0;
+            s->written_probe_enable = 0;
+        }
+    }
+}
+
 
 void hm2_stepgen_process_tram_read(hostmot2_t *hm2, long l_period_ns) {
     (void)l_period_ns;
+    rtapi_s64 *subcounts = hm2->stepgen.subcounts;
+    int n = hm2->stepgen.num_instances;
     int i;
-    rtapi_u32 mode = 0;
-    rtapi_u32 latch = 0;
-    for (i = 0; i < hm2->stepgen.num_instances; i ++) {
-        rtapi_u32 acc = hm2->stepgen.accumulator_reg[i];
-        if (hm2->stepgen.firmware_supports_index) {
-            mode = hm2->stepgen.mode_reg[i] & HM2_STEPGEN_MODE_MASK ;
-            latch = hm2->stepgen.mode_reg[i] & HM2_STEPGEN_LATCH_MASK;
-        }
-        rtapi_s64 acc_delta;
-        rtapi_s64 latch_delta;
+
+    hm2_stepgen_accumulator_deltas(n, hm2->stepgen.accumulator_reg,
+            hm2->stepgen.prev_accumulator, hm2->stepgen.acc_delta);
+
+    for (i = 0; i < n; i ++) {
+        hm2_stepgen_instance_t *s = &hm2->stepgen.instance[i];
 
         // those tricky users are always trying to get us to divide by zero
-        if (fabs(hm2->stepgen.instance[i].hal.param.position_scale) < 1e-6) {
-            if (hm2->stepgen.instance[i].hal.param.position_scale >= 0.0) {
-                hm2->stepgen.instance[i].hal.param.position_scale = 1.0;
+        if (fabs(s->hal.param.position_scale) < 1e-6) {
+            if (s->hal.param.position_scale >= 0.0) {
+                s->hal.param.position_scale = 1.0;
                 HM2_ERR("stepgen %d position_scale is too close to 0, resetting to 1.0\n", i);
             } else {
-                hm2->stepgen.instance[i].hal.param.position_scale = -1.0;
+                s->hal.param.position_scale = -1.0;
                 HM2_ERR("stepgen %d position_scale is too close to 0, resetting to -1.0\n", i);
             }
         }
 
-        // The HM2 Accumulator Register is a 16.16 bit fixed-point
-        // representation of the current stepper position.
-        // The fractional part gives accurate velocity at low speeds, and
-        // sub-step position feedback (like sw stepgen).
-        acc_delta = (rtapi_s64)acc - (rtapi_s64)hm2->stepgen.instance[i].prev_accumulator;
-        if (acc_delta > RTAPI_INT32_MAX) {
-            acc_delta -= RTAPI_UINT32_MAX;
-        } else if (acc_delta < RTAPI_INT32_MIN) {
-            acc_delta += RTAPI_UINT32_MAX;
-        }
-
-
-
         if (hm2->stepgen.firmware_supports_index) {
-            if (hm2->stepgen.instance[i].written_index_enable)  {     // searching for index
-                if ((mode & HM2_STEPGEN_LATCH_ON_INDEX) == 0) {   // hardware index detected and position at index latched
-                    latch_delta = (rtapi_s64)latch - (rtapi_s64)hm2->stepgen.instance[i].prev_accumulator;
-                    if (latch_delta > RTAPI_INT32_MAX) {
-                        latch_delta -= RTAPI_UINT32_MAX;
-                    } else if (latch_delta < RTAPI_INT32_MIN) {
-                        latch_delta += RTAPI_UINT32_MAX;
-                    }
-                    *hm2->stepgen.instance[i].hal.pin.position_latch = ((double)(hm2->stepgen.instance[i].subcounts+latch_delta) / 65536.0) / hm2->stepgen.instance[i].hal.param.position_scale;
-                    acc_delta -= latch_delta;		
-                    hm2->stepgen.instance[i].subcounts = 0;
-                    *hm2->stepgen.instance[i].hal.pin.index_enable = 0;
-                    hm2->stepgen.instance[i].written_index_enable  = 0;
-                }
-            }
-            else if (hm2->stepgen.instance[i].written_probe_enable) {
-                if ((mode & HM2_STEPGEN_LATCH_ON_PROBE) == 0) {
-                    latch_delta = (rtapi_s64)latch - (rtapi_s64)hm2->stepgen.instance[i].prev_accumulator;
-                    if (latch_delta > RTAPI_INT32_MAX) {
-                        latch_delta -= RTAPI_UINT32_MAX;
-                    } else if (latch_delta < RTAPI_INT32_MIN) {
-                        latch_delta += RTAPI_UINT32_MAX;
-                    }
-                    *hm2->stepgen.instance[i].hal.pin.position_latch = ((double)(hm2->stepgen.instance[i].subcounts+latch_delta) / 65536.0) / hm2->stepgen.instance[i].hal.param.position_scale;
-                    *hm2->stepgen.instance[i].hal.pin.latch_enable = 0;
-                     hm2->stepgen.instance[i].written_probe_enable  = 0;
-                } 
-            }
+            hm2_stepgen_instance_handle_latch(hm2, i);
         }
+    }
+
+    hm2_stepgen_accumulate(n, hm2->stepgen.accumulator_reg, hm2->stepgen.prev_accumulator,
+            hm2->stepgen.acc_delta, subcounts);
 
-        hm2->stepgen.instance[i].subcounts += acc_delta;
+    for (i = 0; i < n; i ++) {
+        hm2_stepgen_instance_t *s = &hm2->stepgen.instance[i];
 
-        if ((*hm2->stepgen.instance[i].hal.pin.position_reset) != 0) {
-            hm2->stepgen.instance[i].subcounts = 0;
+        if ((*s->hal.pin.position_reset) != 0) {
+            subcounts[i] = 0;
         }
 
-        *(hm2->stepgen.instance[i].hal.pin.counts) = hm2->stepgen.instance[i].subcounts >> 16;
+        *(s->hal.pin.counts) = subcounts[i] >> 16;
 
         // note that it's important to use "subcounts/65536.0" instead of just
         // "counts" when computing position_fb, because position_fb needs sub-count
         // precision
-        *(hm2->stepgen.instance[i].hal.pin.position_fb) = ((double)hm2->stepgen.instance[i].subcounts / 65536.0) / hm2->stepgen.instance[i].hal.param.position_scale;
-        hm2->stepgen.instance[i].prev_accumulator = acc;
-    }    
+        *(s->hal.pin.position_fb) = ((double)subcounts[i] / 65536.0) / s->hal.param.position_scale;
+    }
 }
 
 
@@ -657,7 +691,7 @@ void hm2_stepgen_tram_init(hostmot2_t *hm2) {
     int i;
 
     for (i = 0; i < hm2->stepgen.num_instances; i ++) {
-        hm2->stepgen.instance[i].prev_accumulator = hm2->stepgen.accumulator_reg[i];
+        hm2->stepgen.prev_accumulator[i] = hm2->stepgen.accumulator_reg[i];
         hm2->stepgen.instance[i].old_position_cmd = *hm2->stepgen.instance[i].hal.pin.position_cmd;
     }
 }
@@ -771,6 +805,15 @@ int hm2_stepgen_parse_md(hostmot2_t *hm2, int md_index) {
         goto fail0;
     }
 
+    hm2->stepgen.prev_accumulator = (rtapi_u32 *)hal_malloc(hm2->stepgen.num_instances * sizeof(rtapi_u32));
+    hm2->stepgen.subcounts = (rtapi_s64 *)hal_malloc(hm2->stepgen.num_instances * sizeof(rtapi_s64));
+    hm2->stepgen.acc_delta = (rtapi_s64 *)hal_malloc(hm2->stepgen.num_instances * sizeof(rtapi_s64));
+    if ((hm2->stepgen.prev_accumulator == NULL) || (hm2->stepgen.subcounts == NULL) || (hm2->stepgen.acc_delta == NULL)) {
+        HM2_ERR("out of memory!\n");
+        r = -ENOMEM;
+        goto fail0;
+    }
+
     hm2->stepgen.clock_frequency = md->clock_freq;
     hm2->stepgen.version = md->version;
 
@@ -1164,7 +1207,7 @@ int hm2_stepgen_parse_md(hostmot2_t *hm2, int md_index) {
             hm2->stepgen.instance[i].hal.param.maxvel = 0.0;
             hm2->stepgen.instance[i].hal.param.maxaccel = 1.0;
 
-            hm2->stepgen.instance[i].subcounts = 0;
+            hm2->stepgen.subcounts[i] = 0;
 
             // start out the slowest possible, let the user speed up if they want
             hm2->stepgen.instance[i].hal.param.steplen   = (double)0x3FFF * ((double)1e9 / (double)hm2->stepgen.clock_frequency);
@@ -1188,7 +1231,8 @@ int hm2_stepgen_parse_md(hostmot2_t *hm2, int md_index) {
             hm2->stepgen.instance[i].hal.param.table[2] = 0;
             hm2->stepgen.instance[i].hal.param.table[3] = 0;
 
-            hm2->stepgen.instance[i].prev_accumulator = 0;
+            hm2->stepgen.prev_accumulator[i] = 0;
+            hm2->stepgen.acc_delta[i] = 0;
 
         }
     }
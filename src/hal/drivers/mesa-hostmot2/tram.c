@@ -55,6 +55,7 @@ int hm2_register_tram_read_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 siz
     tram_entry->addr = addr;
     tram_entry->size = size;
     tram_entry->buffer = buffer;
+    tram_entry->flags = 0;
 
     rtapi_list_add_tail(&tram_entry->list, &hm2->tram_read_entries);
 
@@ -64,7 +65,7 @@ int hm2_register_tram_read_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 siz
 }
 
 
-int hm2_register_tram_write_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer) {
+static int hm2_register_tram_write_entry(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer, int flags) {
     hm2_tram_entry_t *tram_entry;
 
     tram_entry = rtapi_kmalloc(sizeof(hm2_tram_entry_t), RTAPI_GFP_KERNEL);
@@ -76,6 +77,7 @@ int hm2_register_tram_write_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 si
     tram_entry->addr = addr;
     tram_entry->size = size;
     tram_entry->buffer = buffer;
+    tram_entry->flags = flags;
 
     rtapi_list_add_tail(&tram_entry->list, &hm2->tram_write_entries);
 
@@ -85,6 +87,22 @@ int hm2_register_tram_write_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 si
 }
 
 
+int hm2_register_tram_write_region(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer) {
+    return hm2_register_tram_write_entry(hm2, addr, size, buffer, 0);
+}
+
+
+//
+// Like hm2_register_tram_write_region(), for registers where the write
+// itself does something: these are written every cycle, even when
+// unchanged writes are suppressed.
+//
+
+int hm2_register_tram_write_region_always(hostmot2_t *hm2, rtapi_u16 addr, rtapi_u16 size, rtapi_u32 **buffer) {
+    return hm2_register_tram_write_entry(hm2, addr, size, buffer, HM2_TRAM_WRITE_ALWAYS);
+}
+
+
 int hm2_allocate_tram_regions(hostmot2_t *hm2) {
     struct rtapi_list_head *ptr;
     rtapi_u16 offset;
@@ -126,6 +144,14 @@ int hm2_allocate_tram_regions(hostmot2_t *hm2) {
     if(hm2->tram_write_size>old_tram_write_size)
         memset((char*)hm2->tram_write_buffer+old_tram_write_size, 0, hm2->tram_write_size-old_tram_write_size);
 
+    // the shadow is only compared once all registers were written
+    hm2->tram_write.shadow = (rtapi_u32 *)rtapi_krealloc(hm2->tram_write.shadow, hm2->tram_write_size, RTAPI_GFP_KERNEL);
+    if (hm2->tram_write.shadow == NULL) {
+        HM2_ERR("Error while (re)allocating Translation RAM write shadow (%d bytes)\n", hm2->tram_write_size);
+        return -ENOMEM;
+    }
+    hm2_tram_write_invalidate(hm2);
+
     HM2_DBG("buffer address %p\n", &hm2->tram_write_buffer);
     HM2_DBG("Translation RAM read buffer:\n");
     offset = 0;
@@ -189,20 +215,153 @@ int hm2_finish_read(hostmot2_t *hm2) {
 }
 
 
+int hm2_tram_write_export_hal(hostmot2_t *hm2) {
+    int r;
+
+    hm2->tram_write.hal = (hm2_tram_write_hal_t *)hal_malloc(sizeof(hm2_tram_write_hal_t));
+    if (hm2->tram_write.hal == NULL) {
+        HM2_ERR("out of memory!\n");
+        return -ENOMEM;
+    }
+
+    r = hal_pin_u32_newf(HAL_OUT, &(hm2->tram_write.hal->pin.bytes),
+            hm2->llio->comp_id, "%s.tram-write.bytes", hm2->llio->name);
+    if (r < 0) {
+        HM2_ERR("error adding pin '%s.tram-write.bytes', aborting\n", hm2->llio->name);
+        return r;
+    }
+
+    r = hal_pin_u32_newf(HAL_OUT, &(hm2->tram_write.hal->pin.commands),
+            hm2->llio->comp_id, "%s.tram-write.commands", hm2->llio->name);
+    if (r < 0) {
+        HM2_ERR("error adding pin '%s.tram-write.commands', aborting\n", hm2->llio->name);
+        return r;
+    }
+
+    r = hal_param_bit_newf(HAL_RW, &(hm2->tram_write.hal->param.suppress_unchanged),
+            hm2->llio->comp_id, "%s.tram-write.suppress-unchanged", hm2->llio->name);
+    if (r < 0) {
+        HM2_ERR("error adding param '%s.tram-write.suppress-unchanged', aborting\n", hm2->llio->name);
+        return r;
+    }
+
+    r = hal_param_u32_newf(HAL_RW, &(hm2->tram_write.hal->param.refresh_cycles),
+            hm2->llio->comp_id, "%s.tram-write.refresh-cycles", hm2->llio->name);
+    if (r < 0) {
+        HM2_ERR("error adding param '%s.tram-write.refresh-cycles', aborting\n", hm2->llio->name);
+        return r;
+    }
+
+    *hm2->tram_write.hal->pin.bytes = 0;
+    *hm2->tram_write.hal->pin.commands = 0;
+    hm2->tram_write.hal->param.suppress_unchanged = 0;
+    hm2->tram_write.hal->param.refresh_cycles = 1000;
+
+    return 0;
+}
+
+
+//
+// The FPGA's registers may no longer hold what was last written (the
+// board was reset, or its state forced), so write them all next time.
+//
+
+void hm2_tram_write_invalidate(hostmot2_t *hm2) {
+    hm2->tram_write.full = 1;
+}
+
+
+//
+// A run of registers, adjacent both in the FPGA and in the TRAM write
+// buffer, waiting to be queued as a single write.
+//
+
+typedef struct {
+    rtapi_u16 addr;
+    rtapi_u16 size;
+    rtapi_u8 *buffer;
+} hm2_tram_write_run_t;
+
+// Clean registers in a gap this small are written along with their
+// neighbours: each write command costs as much as a register.
+#define HM2_TRAM_WRITE_MAX_GAP (sizeof(rtapi_u32))
+
 static rtapi_u32 tram_write_iteration = 0;
+
+static int hm2_tram_write_flush(hostmot2_t *hm2, hm2_tram_write_run_t *run, rtapi_u32 *bytes, rtapi_u32 *commands) {
+    if (run->size == 0) return 0;
+    if (!hm2->llio->queue_write(hm2->llio, run->addr, run->buffer, run->size)) {
+        HM2_ERR("TRAM write error! (addr=0x%04x, size=%d, iter=%u)\n", run->addr, run->size, tram_write_iteration);
+        return -EIO;
+    }
+    *bytes += run->size;
+    (*commands)++;
+    run->size = 0;
+    return 0;
+}
+
+static int hm2_tram_write_add(hostmot2_t *hm2, hm2_tram_write_run_t *run, rtapi_u16 addr, rtapi_u8 *buffer, rtapi_u16 size, rtapi_u32 *bytes, rtapi_u32 *commands) {
+    if (run->size != 0) {
+        int gap = (int)addr - (int)(run->addr + run->size);
+
+        // the registers in between come from the buffer too, so the
+        // FPGA and buffer offsets must match
+        if (gap >= 0 && gap <= (int)HM2_TRAM_WRITE_MAX_GAP && buffer - run->buffer == addr - run->addr) {
+            run->size = addr + size - run->addr;
+            return 0;
+        }
+        if (hm2_tram_write_flush(hm2, run, bytes, commands) < 0) return -EIO;
+    }
+    run->addr = addr;
+    run->buffer = buffer;
+    run->size = size;
+    return 0;
+}
+
 int hm2_tram_write(hostmot2_t *hm2) {
     struct rtapi_list_head *ptr;
+    hm2_tram_write_run_t run = { 0, 0, NULL };
+    rtapi_u32 bytes = 0, commands = 0;
+    int suppress = hm2->tram_write.hal->param.suppress_unchanged;
+
+    if (suppress && !hm2->tram_write.written_suppress_unchanged)
+        hm2->tram_write.full = 1;
+    hm2->tram_write.written_suppress_unchanged = suppress;
+    if (suppress && ++hm2->tram_write.cycles >= hm2->tram_write.hal->param.refresh_cycles)
+        hm2->tram_write.full = 1;
+    if (hm2->tram_write.full) {
+        suppress = 0;
+        hm2->tram_write.full = 0;
+        hm2->tram_write.cycles = 0;
+    }
 
     rtapi_list_for_each(ptr, &hm2->tram_write_entries) {
         hm2_tram_entry_t *tram_entry = rtapi_list_entry(ptr, hm2_tram_entry_t, list);
+        rtapi_u32 *buffer = *tram_entry->buffer;
+        rtapi_u32 *shadow;
+        int i;
+
+        if (!suppress || (tram_entry->flags & HM2_TRAM_WRITE_ALWAYS)) {
+            if (hm2_tram_write_add(hm2, &run, tram_entry->addr, (rtapi_u8 *)buffer, tram_entry->size, &bytes, &commands) < 0)
+                return -EIO;
+            continue;
+        }
 
-        if (!hm2->llio->queue_write(hm2->llio, tram_entry->addr, *tram_entry->buffer, tram_entry->size)) {
-            HM2_ERR("TRAM write error! (addr=0x%04x, size=%d, iter=%u)\n", tram_entry->addr, tram_entry->size, tram_write_iteration);
-            return -EIO;
+        shadow = hm2->tram_write.shadow + (buffer - hm2->tram_write_buffer);
+        for (i = 0; i < tram_entry->size / 4; i++) {
+            if (buffer[i] == shadow[i]) continue;
+            if (hm2_tram_write_add(hm2, &run, tram_entry->addr + i * 4, (rtapi_u8 *)&buffer[i], 4, &bytes, &commands) < 0)
+                return -EIO;
         }
     }
+    if (hm2_tram_write_flush(hm2, &run, &bytes, &commands) < 0)
+        return -EIO;
+    memcpy(hm2->tram_write.shadow, hm2->tram_write_buffer, hm2->tram_write_size);
     tram_write_iteration ++;
 
+    *hm2->tram_write.hal->pin.bytes = bytes;
+    *hm2->tram_write.hal->pin.commands = commands;
+
     return 0;
 }
 
@@ -235,5 +394,6 @@ void hm2_tram_cleanup(hostmot2_t *hm2) {
     // free the tram buffers
     if (hm2->tram_read_buffer != NULL) rtapi_kfree(hm2->tram_read_buffer);
     if (hm2->tram_write_buffer != NULL) rtapi_kfree(hm2->tram_write_buffer);
+    if (hm2->tram_write.shadow != NULL) rtapi_kfree(hm2->tram_write.shadow);
 }
 
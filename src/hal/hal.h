@@ -1027,6 +1027,15 @@ extern int hal_export_functf(void (*funct) (void *, long),
 extern int hal_create_thread(const char *name, unsigned long period_nsec,
     int uses_fp);
 
+/** hal_create_thread_cpu() is the same as hal_create_thread(), but
+    binds the thread to CPU 'cpu'.  Use it to give threads that would
+    otherwise delay each other a core of their own.  The CPU should be
+    isolated from normal Linux scheduling (isolcpus=).  A 'cpu' of -1
+    gives the default placement used by hal_create_thread().
+*/
+extern int hal_create_thread_cpu(const char *name, unsigned long period_nsec,
+    int uses_fp, int cpu);
+
 /** hal_thread_delete() deletes a realtime thread.
     'name' is the name of the thread, which must have been created
     by 'hal_create_thread()'.
@@ -1037,6 +1046,20 @@ extern int hal_create_thread(const char *name, unsigned long period_nsec,
 */
 extern int hal_thread_delete(const char *name);
 
+/** hal_thread_add_worker() gives the thread 'name' a worker task on
+    CPU 'cpu'.  The workers of a thread help it run the functions of
+    its parallel groups, see hal_add_funct_to_group().  A worker runs
+    at the priority of the thread and busy-waits while the thread runs
+    its functions, so 'cpu' must be a CPU of its own, not the one of
+    the thread or of another realtime thread.  A thread can have up to
+    HAL_THREAD_WORKERS workers.  Workers are only created when RTAPI
+    runs with realtime scheduling, otherwise the call does nothing and
+    the groups run one function after the other.
+    Returns 0, or a negative error code.  Call only from realtime init
+    code, not from user space or realtime code.
+*/
+extern int hal_thread_add_worker(const char *name, int cpu);
+
 #endif /* RTAPI */
 
 /** hal_add_funct_to_thread() adds a function exported by a
@@ -1063,6 +1086,24 @@ extern int hal_thread_delete(const char *name);
 extern int hal_add_funct_to_thread(const char *funct_name, const char *thread_name,
     int position);
 
+/** hal_add_funct_to_group() is the same as hal_add_funct_to_thread(),
+    but puts the function in the parallel group 'group' of the thread.
+    Functions that are next to each other in a thread and that are in
+    the same group do not depend on each other, so the thread hands
+    them to its workers (see hal_thread_add_worker()) and runs them at
+    the same time.  The thread continues with the next function when
+    all functions of the group are done.  A thread without workers runs
+    the functions of a group one after the other.  A NULL or empty
+    'group' is the same as hal_add_funct_to_thread().  A thread can
+    have up to HAL_THREAD_GROUPS different group names.
+    Returns 0, or a negative error code.  Call only from within user
+    space or init code, not from realtime code.
+*/
+#define HAL_THREAD_GROUPS 16
+#define HAL_THREAD_WORKERS 8
+extern int hal_add_funct_to_group(const char *funct_name, const char *thread_name,
+    int position, const char *group);
+
 /** hal_init_funct_to_thread() registers a function to run exactly once,
     in the realtime context of 'thread_name', before the thread executes
     any cyclic (addf-registered) function. The init list is invoked in a
@@ -1253,6 +1294,14 @@ extern hal_type_t hal_stream_element_type(hal_stream_t *stream, int idx);
 
 // only one reader and one writer is allowed.
 extern int hal_stream_read(hal_stream_t *stream, hal_stream_data_u *buf, unsigned *sampleno);
+/** hal_stream_read_many() reads up to @param max_samples rows in one pass.
+    Rows are stored back to back in @param buf, which must hold
+    max_samples * hal_stream_element_count() elements.  If @param sampleno
+    is not NULL it must hold max_samples entries and receives the sample
+    number of each row.  Returns the number of rows read (at least 1), or
+    -ENOSPC if the stream was empty.
+*/
+extern int hal_stream_read_many(hal_stream_t *stream, hal_stream_data_u *buf, unsigned *sampleno, int max_samples);
 extern bool hal_stream_readable(hal_stream_t *stream);
 extern int hal_stream_depth(hal_stream_t *stream);
 extern unsigned hal_stream_maxdepth(hal_stream_t *stream);
@@ -1396,6 +1445,10 @@ typedef enum {
 #define COMPONENT_TYPE_REALTIME HAL_COMP_TYPE_REALTIME
 #define COMPONENT_TYPE_OTHER    HAL_COMP_TYPE_OTHER
 
+// Number of bins in a function or thread execution time histogram. The bins
+// are log2 spaced with two bins per octave, see hal_histogram_bin_start().
+#define HAL_HIST_BINS 64
+
 // Only enable the query API when we are compiling the user-land HAL library
 #ifdef ULAPI
 
@@ -1426,6 +1479,8 @@ typedef struct {
     rtapi_intptr_t funct; // Return: Pointer to function code
     rtapi_intptr_t arg;   // Return: Argument for function
     bool reentrant;       // Return: True if function is re-entrant
+    const rtapi_u64 *hist; // Return: HAL_HIST_BINS execution time counts or NULL if never switched on
+    bool hist_on;         // Return: True if the histogram is counting
 } hal_query_funct_t;
 
 typedef struct {
@@ -1433,9 +1488,15 @@ typedef struct {
     const char *comp;     // Return: Component's name
     int priority;         // Return: Thread priority
     long int period;      // Return: Thread period in nsec
+    int cpu;              // Return: CPU the thread is bound to, -1 for default
+    int workers;          // Return: Number of worker tasks
+    const int *worker_cpu; // Return: CPUs of the worker tasks
+    const rtapi_u64 *hist; // Return: HAL_HIST_BINS execution time counts or NULL if never switched on
+    bool hist_on;         // Return: True if the histogram is counting
     int functidx;         // Return: Function iteration counter
     const char *funct;    // Return: Attached function name
     bool is_init;         // Return: True if funct is an init function
+    const char *group;    // Return: Parallel group of the function or NULL
 } hal_query_thread_t;
 
 typedef union {
@@ -1545,6 +1606,15 @@ int hal_getref_s(hal_query_t *query);
 int hal_get_s(hal_query_t *query, hal_query_cb cb, void *arg);
 int hal_set_s(hal_query_t *query, hal_query_cb cb, void *arg);
 
+// The generation changes whenever a pin, param or signal is created,
+// deleted or renamed and whenever a pin is linked or unlinked. Programs
+// that read the same objects repeatedly may keep the references from
+// hal_getref_[ps]() and read through them with hal_get_xxx(), without
+// the mutex, for as long as hal_generation() returns the value it had
+// before the references were retrieved. Returns zero if the HAL is not
+// mapped.
+rtapi_u32 hal_generation(void);
+
 //
 // *** HAL structure iteration functions ***
 //
@@ -1606,6 +1676,34 @@ int hal_comp_invoke_make(const char *compname, const char *newname, const char *
 // The 'args' argument must be in HAL memory.
 int hal_comp_insmod_args(const char *compname, const char *args);
 
+// Hold the HAL mutex from hal_batch_begin() until hal_batch_end(), so a
+// series of HAL calls does not take and give back the mutex for each
+// call. Other processes can not access the HAL in between. You
+// _MUST_NOT_ wait for another process that uses the HAL (loadrt,
+// loadusr, etc.) while holding the batch lock. Calls may be nested.
+// Returns zero (0) on success or -EFAULT if the HAL is not mapped.
+int hal_batch_begin(void);
+int hal_batch_end(void);
+
+// Execution time histograms of functions and threads
+// The thread that runs a function (or the thread itself) counts every
+// execution time in one of HAL_HIST_BINS bins while the histogram is on.
+// The counts are returned in the 'hist' member of hal_query_funct_t and
+// hal_query_thread_t. Switching a histogram off keeps its counts, reset
+// clears them.
+// Returns zero (0) on success, -ENOENT if 'name' is neither a function nor
+// a thread or -ENOMEM if there is no shared memory left for the histogram.
+typedef enum {
+    HAL_HIST_OFF,
+    HAL_HIST_ON,
+    HAL_HIST_RESET
+} hal_hist_cmd_t;
+int hal_histogram(const char *name, hal_hist_cmd_t cmd);
+
+// Lowest execution time in nsec counted in histogram bin 'bin'. The bin
+// counts execution times up to, but not including, the start of the next bin.
+rtapi_u64 hal_histogram_bin_start(int bin);
+
 // -----------------------------------------------------
 // Release the HAL mutex with brute force
 // WARNING:
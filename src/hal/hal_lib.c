@@ -165,12 +165,68 @@ static void free_funct_entry_struct(hal_funct_entry_t * funct_entry);
 static void free_thread_struct(hal_thread_t * thread);
 #endif /* RTAPI */
 
+/** The name index functions maintain the hash table that the
+    'halpr_find_xxx_by_name()' functions use.  'index_add()' must be
+    called for every name an object can be found by when it is added to
+    its list, and 'index_remove()' before the object is freed or renamed.
+    If the index cannot grow because shared memory is exhausted, it is
+    dropped and lookups fall back to walking the lists.
+    All of these functions assume that the caller has already grabbed
+    the hal_data mutex.
+*/
+#define HAL_INDEX_COMP   1
+#define HAL_INDEX_PIN    2
+#define HAL_INDEX_SIG    3
+#define HAL_INDEX_PARAM  4
+#define HAL_INDEX_FUNCT  5
+#define HAL_INDEX_THREAD 6
+#define HAL_INDEX_KIND_MASK 7u
+#define HAL_INDEX_INITIAL_SIZE 1024
+#define HAL_INDEX_DELETED (-1)
+
+static void index_init(void);
+static void index_add(unsigned kind, void *obj, const char *name);
+static void index_remove(unsigned kind, void *obj, const char *name);
+static void *index_find(unsigned kind, const char *name);
+
+/** 'bump_generation()' changes hal_data->generation, which tells
+    programs that keep references to pins, params and signals (see
+    'hal_generation()') that a name may now refer to another object or
+    a pin to another signal.  It is called by 'index_add()',
+    'index_remove()' and wherever a pin is linked or unlinked.
+*/
+static void bump_generation(void);
+
 #ifdef RTAPI
 /** 'thread_task()' is a function that is invoked as a realtime task.
     It implements a thread, by running down the thread's function list
     and calling each function in turn.
 */
 static void thread_task(void *arg);
+
+/** 'worker_task()' is the realtime task of a worker of a thread.  It
+    follows the cycles of the thread and helps it run the functions of
+    its parallel groups.  'run_group()' hands the group that starts at
+    'entry' to the workers and returns the first entry after it, when
+    all functions of the group are done.  'run_work()' runs dispatched
+    functions until there are none left to claim.
+*/
+static void worker_task(void *arg);
+static hal_funct_entry_t *run_group(hal_thread_t *thread,
+    hal_funct_entry_t *root, hal_funct_entry_t *entry);
+static void run_work(hal_thread_t *thread);
+
+/** 'funct_timing()' updates the execution time data of a function
+    after it ran for 'runtime' nsec.
+*/
+static void funct_timing(hal_funct_t *funct, long long int runtime);
+
+/** 'hist_add()' counts execution time 'ns' in histogram 'h'.
+    'hist_clear()' stops and clears a histogram of a function or thread
+    that is freed, so the histogram can be re-used with the struct.
+*/
+static void hist_add(hal_hist_t *h, long long int ns);
+static void hist_clear(hal_hist_t *h);
 #endif /* RTAPI */
 
 //
@@ -445,6 +501,7 @@ int hal_init(const char *name)
     /* insert new structure at head of list */
     comp->next_ptr = hal_data->comp_list_ptr;
     hal_data->comp_list_ptr = SHMOFF(comp);
+    index_add(HAL_INDEX_COMP, comp, comp->name);
     /* done with list, release mutex */
     halpr_mutex_release();
     /* done */
@@ -1175,6 +1232,7 @@ int hal_pin_new(const char *name, hal_type_t type, hal_pin_dir_t dir,
 	    /* reached end of list, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_PIN, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -1184,6 +1242,7 @@ int hal_pin_new(const char *name, hal_type_t type, hal_pin_dir_t dir,
 	    /* found the right place for it, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_PIN, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -1279,6 +1338,12 @@ int hal_pin_alias(const char *pin_name, const char *alias)
 	prev = &(pin->next_ptr);
 	next = *prev;
     }
+    /* drop the pin's names from the index, they are about to change */
+    index_remove(HAL_INDEX_PIN, pin, pin->name);
+    if ( pin->oldname != 0 ) {
+	oldname = SHMPTR(pin->oldname);
+	index_remove(HAL_INDEX_PIN, pin, oldname->name);
+    }
     if ( alias != NULL ) {
 	/* adding a new alias */
 	if ( pin->oldname == 0 ) {
@@ -1299,6 +1364,12 @@ int hal_pin_alias(const char *pin_name, const char *alias)
 	    free_oldname_struct(oldname);
 	}
     }
+    /* and add the new names */
+    index_add(HAL_INDEX_PIN, pin, pin->name);
+    if ( pin->oldname != 0 ) {
+	oldname = SHMPTR(pin->oldname);
+	index_add(HAL_INDEX_PIN, pin, oldname->name);
+    }
     /* insert pin back into list in proper place */
     prev = &(hal_data->pin_list_ptr);
     next = *prev;
@@ -1412,6 +1483,7 @@ int hal_signal_new(const char *name, hal_type_t type)
 	    /* reached end of list, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_SIG, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -1421,6 +1493,7 @@ int hal_signal_new(const char *name, hal_type_t type)
 	    /* found the right place for it, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_SIG, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -1641,6 +1714,7 @@ int hal_link(const char *pin_name, const char *sig_name)
     }
     /* and update the pin */
     pin->signal = SHMOFF(sig);
+    bump_generation();
     /* done, release the mutex and return */
     halpr_mutex_release();
     return 0;
@@ -1920,6 +1994,7 @@ static int hal_param_new_anyapi(const char *name, hal_type_t type, hal_pdir_t di
 	    /* reached end of list, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_PARAM, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -1929,6 +2004,7 @@ static int hal_param_new_anyapi(const char *name, hal_type_t type, hal_pdir_t di
 	    /* found the right place for it, insert here */
 	    new->next_ptr = next;
 	    *prev = SHMOFF(new);
+	    index_add(HAL_INDEX_PARAM, new, new->name);
 	    halpr_mutex_release();
 	    return 0;
 	}
@@ -2251,6 +2327,12 @@ int hal_param_alias(const char *param_name, const char *alias)
 	prev = &(param->next_ptr);
 	next = *prev;
     }
+    /* drop the param's names from the index, they are about to change */
+    index_remove(HAL_INDEX_PARAM, param, param->name);
+    if ( param->oldname != 0 ) {
+	oldname = SHMPTR(param->oldname);
+	index_remove(HAL_INDEX_PARAM, param, oldname->name);
+    }
     if ( alias != NULL ) {
 	/* adding a new alias */
 	if ( param->oldname == 0 ) {
@@ -2271,6 +2353,12 @@ int hal_param_alias(const char *param_name, const char *alias)
 	    free_oldname_struct(oldname);
 	}
     }
+    /* and add the new names */
+    index_add(HAL_INDEX_PARAM, param, param->name);
+    if ( param->oldname != 0 ) {
+	oldname = SHMPTR(param->oldname);
+	index_add(HAL_INDEX_PARAM, param, oldname->name);
+    }
     /* insert param back into list in proper place */
     prev = &(hal_data->param_list_ptr);
     next = *prev;
@@ -2481,6 +2569,7 @@ int hal_export_funct(const char *name, void (*funct) (void *, long),
 	prev = &(fptr->next_ptr);
 	next = *prev;
     }
+    index_add(HAL_INDEX_FUNCT, new, new->name);
     /* at this point we have a new function and can yield the mutex */
     halpr_mutex_release();
 
@@ -2509,6 +2598,12 @@ int hal_export_funct(const char *name, void (*funct) (void *, long),
 }
 
 int hal_create_thread(const char *name, unsigned long period_nsec, int uses_fp)
+{
+    return hal_create_thread_cpu(name, period_nsec, uses_fp, -1);
+}
+
+int hal_create_thread_cpu(const char *name, unsigned long period_nsec,
+    int uses_fp, int cpu)
 {
     (void)uses_fp;
     int next, cmp, prev_priority;
@@ -2518,7 +2613,7 @@ int hal_create_thread(const char *name, unsigned long period_nsec, int uses_fp)
     char buf[HAL_NAME_LEN + 1];
 
     rtapi_print_msg(RTAPI_MSG_DBG,
-	"HAL: creating thread %s, %ld nsec\n", name, period_nsec);
+	"HAL: creating thread %s, %ld nsec, cpu %d\n", name, period_nsec, cpu);
     if (hal_data == NULL) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL: ERROR: create_thread called before init\n");
@@ -2640,9 +2735,21 @@ int hal_create_thread(const char *name, unsigned long period_nsec, int uses_fp)
 	return -EINVAL;
     }
     new->task_id = retval;
+    new->cpu = cpu;
+    if (cpu >= 0) {
+	retval = rtapi_task_set_cpu(new->task_id, cpu);
+	if (retval < 0) {
+	    rtapi_task_delete(new->task_id);
+	    halpr_mutex_release();
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"HAL_LIB: could not bind thread %s to CPU %d: %d\n", name, cpu, retval);
+	    return -EINVAL;
+	}
+    }
     /* start task */
     retval = rtapi_task_start(new->task_id, new->period);
     if (retval < 0) {
+	rtapi_task_delete(new->task_id);
 	halpr_mutex_release();
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL_LIB: could not start task for thread %s: %d\n", name, retval);
@@ -2651,6 +2758,7 @@ int hal_create_thread(const char *name, unsigned long period_nsec, int uses_fp)
     /* insert new structure at head of list */
     new->next_ptr = hal_data->thread_list_ptr;
     hal_data->thread_list_ptr = SHMOFF(new);
+    index_add(HAL_INDEX_THREAD, new, new->name);
 
     // The counter that increases monotonically once every thread loop cycle.
     // This is a 'fast' counter with normal access semantics. Separated from
@@ -2744,14 +2852,101 @@ extern int hal_thread_delete(const char *name)
     return -ENOENT;
 }
 
+int hal_thread_add_worker(const char *name, int cpu)
+{
+    hal_thread_t *thread;
+    int retval, task_id;
+
+    if (hal_data == NULL) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: thread_add_worker called before init\n");
+	return -EFAULT;
+    }
+    if (hal_data->lock & HAL_LOCK_CONFIG) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: thread_add_worker called while HAL is locked\n");
+	return -EPERM;
+    }
+    if (cpu < 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: worker of thread '%s' needs a CPU\n", name);
+	return -EINVAL;
+    }
+    if (!rtapi_is_realtime()) {
+	/* without realtime scheduling the tasks do not run at the same
+	   time, a spinning worker would only delay the thread */
+	rtapi_print_msg(RTAPI_MSG_INFO,
+	    "HAL: no realtime, thread '%s' runs its groups without workers\n", name);
+	return 0;
+    }
+
+    halpr_mutex_acquire();
+    thread = halpr_find_thread_by_name(name);
+    if (thread == NULL) {
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: thread '%s' not found\n", name);
+	return -ENOENT;
+    }
+    if (thread->nworkers >= HAL_THREAD_WORKERS) {
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: thread '%s' has too many workers\n", name);
+	return -ENOSPC;
+    }
+    if (cpu == thread->cpu) {
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: worker of thread '%s' can not share its CPU %d\n", name, cpu);
+	return -EINVAL;
+    }
+    /* the worker runs at the priority of its thread */
+    retval = rtapi_task_new(worker_task, thread, thread->priority,
+	lib_module_id, HAL_STACKSIZE, 1);
+    if (retval < 0) {
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL_LIB: could not create worker task for thread %s\n", name);
+	return -EINVAL;
+    }
+    task_id = retval;
+    retval = rtapi_task_set_cpu(task_id, cpu);
+    if (retval < 0) {
+	rtapi_task_delete(task_id);
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL_LIB: could not bind worker of thread %s to CPU %d: %d\n", name, cpu, retval);
+	return -EINVAL;
+    }
+    retval = rtapi_task_start(task_id, thread->period);
+    if (retval < 0) {
+	rtapi_task_delete(task_id);
+	halpr_mutex_release();
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL_LIB: could not start worker task for thread %s: %d\n", name, retval);
+	return -EINVAL;
+    }
+    thread->worker_task_id[thread->nworkers] = task_id;
+    thread->worker_cpu[thread->nworkers] = cpu;
+    /* the thread hands groups to the workers from now on */
+    thread->nworkers++;
+    halpr_mutex_release();
+    return 0;
+}
+
 #endif /* RTAPI */
 
 int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int position)
+{
+    return hal_add_funct_to_group(funct_name, thread_name, position, NULL);
+}
+
+int hal_add_funct_to_group(const char *funct_name, const char *thread_name,
+    int position, const char *group)
 {
     hal_thread_t *thread;
     hal_funct_t *funct;
     hal_list_t *list_root, *list_entry;
-    int n;
+    int n, group_id;
     hal_funct_entry_t *funct_entry;
 
     if (hal_data == NULL) {
@@ -2820,6 +3015,31 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
     /* uses_fp is deprecated and ignored; all threads are FP-capable.
        The FP compatibility check has been removed since all threads
        and functions now effectively have uses_fp=1. */
+    /* look up the group, add it if the thread does not know it yet */
+    group_id = 0;
+    if (group && *group) {
+	if (strlen(group) > HAL_NAME_LEN) {
+	    halpr_mutex_release();
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"HAL: ERROR: group name '%s' is too long\n", group);
+	    return -EINVAL;
+	}
+	for (n = 0; n < HAL_THREAD_GROUPS && thread->group_names[n][0]; n++) {
+	    if (strcmp(thread->group_names[n], group) == 0) {
+		break;
+	    }
+	}
+	if (n == HAL_THREAD_GROUPS) {
+	    halpr_mutex_release();
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"HAL: ERROR: thread '%s' has too many groups\n", thread_name);
+	    return -ENOSPC;
+	}
+	if (!thread->group_names[n][0]) {
+	    rtapi_snprintf(thread->group_names[n], sizeof(thread->group_names[n]), "%s", group);
+	}
+	group_id = n + 1;
+    }
     /* find insertion point */
     list_root = &(thread->funct_list);
     list_entry = list_root;
@@ -2866,6 +3086,7 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
     funct_entry->funct_ptr = SHMOFF(funct);
     funct_entry->arg = funct->arg;
     funct_entry->funct = funct->funct;
+    funct_entry->group = group_id;
     /* add the entry to the list */
     list_add_after((hal_list_t *) funct_entry, list_entry);
     /* update the function usage count */
@@ -3194,11 +3415,259 @@ hal_list_t *list_remove_entry(hal_list_t * entry)
     return next;
 }
 
+/***********************************************************************
+*                     NAME INDEX FUNCTIONS                             *
+************************************************************************/
+
+/* 32 bit FNV-1a hash of 'name', with the low bits replaced by 'kind'
+   so that objects of different kinds never compare equal */
+static rtapi_u32 index_key(unsigned kind, const char *name)
+{
+    rtapi_u32 h = 2166136261u;
+
+    while (*name) {
+	h ^= (unsigned char) *name++;
+	h *= 16777619u;
+    }
+    return (h & ~HAL_INDEX_KIND_MASK) | kind;
+}
+
+/* true if 'obj', an object of type 'kind', is found by 'name' */
+static int index_obj_matches(unsigned kind, void *obj, const char *name)
+{
+    const char *objname;
+    rtapi_intptr_t oldname = 0;
+
+    switch (kind) {
+    case HAL_INDEX_COMP:
+	objname = ((hal_comp_t *) obj)->name;
+	break;
+    case HAL_INDEX_PIN:
+	objname = ((hal_pin_t *) obj)->name;
+	oldname = ((hal_pin_t *) obj)->oldname;
+	break;
+    case HAL_INDEX_SIG:
+	objname = ((hal_sig_t *) obj)->name;
+	break;
+    case HAL_INDEX_PARAM:
+	objname = ((hal_param_t *) obj)->name;
+	oldname = ((hal_param_t *) obj)->oldname;
+	break;
+    case HAL_INDEX_FUNCT:
+	objname = ((hal_funct_t *) obj)->name;
+	break;
+    case HAL_INDEX_THREAD:
+	objname = ((hal_thread_t *) obj)->name;
+	break;
+    default:
+	return 0;
+    }
+    if (strcmp(objname, name) == 0) {
+	return 1;
+    }
+    return oldname != 0
+	&& strcmp(((hal_oldname_t *) SHMPTR(oldname))->name, name) == 0;
+}
+
+/* put an entry into 'table', which must have a free slot */
+static int index_insert(hal_index_entry_t *table, int size, rtapi_u32 key, rtapi_s32 obj)
+{
+    int mask = size - 1;
+    int n = (key >> 3) & mask;
+    int slot = -1;
+
+    while (table[n].obj != 0) {
+	if (table[n].obj == HAL_INDEX_DELETED && slot < 0) {
+	    /* remember the first deleted slot, it can be reused */
+	    slot = n;
+	}
+	n = (n + 1) & mask;
+    }
+    if (slot < 0) {
+	slot = n;
+    }
+    table[slot].key = key;
+    table[slot].obj = obj;
+    /* returns 1 if a previously empty slot was used */
+    return slot == n;
+}
+
+/* rebuild 'table' where it is, dropping the deleted entries.  Live
+   entries still to be moved are marked by a negated offset (objects
+   are never at offset 0 or 1, hal_data is there); each one is taken
+   out and put back, and when it lands on another entry still to be
+   moved the two swap and that one is put back next. */
+static void index_rehash_in_place(hal_index_entry_t *table, int size)
+{
+    hal_index_entry_t e, tmp;
+    int mask = size - 1;
+    int n, k;
+
+    for (n = 0; n < size; n++) {
+	if (table[n].obj == HAL_INDEX_DELETED) {
+	    table[n].obj = 0;
+	} else if (table[n].obj > 0) {
+	    table[n].obj = -table[n].obj;
+	}
+    }
+    for (n = 0; n < size; n++) {
+	if (table[n].obj >= 0) {
+	    continue;
+	}
+	e.key = table[n].key;
+	e.obj = -table[n].obj;
+	table[n].obj = 0;
+	k = (e.key >> 3) & mask;
+	while (table[k].obj != 0) {
+	    if (table[k].obj < 0) {
+		tmp.key = table[k].key;
+		tmp.obj = -table[k].obj;
+		table[k] = e;
+		e = tmp;
+		k = (e.key >> 3) & mask;
+	    } else {
+		k = (k + 1) & mask;
+	    }
+	}
+	table[k] = e;
+    }
+}
+
+/* get rid of the deleted entries, in a bigger table if it would be
+   more than half full */
+static int index_rehash(void)
+{
+    hal_index_entry_t *old, *table;
+    int n, live, size;
+
+    old = SHMPTR(hal_data->name_index);
+    live = 0;
+    for (n = 0; n < hal_data->name_index_size; n++) {
+	if (old[n].obj > 0) {
+	    live++;
+	}
+    }
+    size = hal_data->name_index_size;
+    while ((live + 1) * 2 > size) {
+	size *= 2;
+    }
+    if (size == hal_data->name_index_size) {
+	/* mostly deleted entries, no need for more memory */
+	index_rehash_in_place(old, size);
+	hal_data->name_index_used = live;
+	return 0;
+    }
+    /* the old table can not be given back, shmalloc has no free */
+    table = shmalloc_dn(size * sizeof(hal_index_entry_t));
+    if (table == NULL) {
+	return -ENOMEM;
+    }
+    memset(table, 0, size * sizeof(hal_index_entry_t));
+    for (n = 0; n < hal_data->name_index_size; n++) {
+	if (old[n].obj > 0) {
+	    index_insert(table, size, old[n].key, old[n].obj);
+	}
+    }
+    hal_data->name_index = SHMOFF(table);
+    hal_data->name_index_size = size;
+    hal_data->name_index_used = live;
+    rtapi_print_msg(RTAPI_MSG_DBG, "HAL: name index resized to %d entries\n", size);
+    return 0;
+}
+
+static void index_init(void)
+{
+    hal_index_entry_t *table;
+    long int bytes = HAL_INDEX_INITIAL_SIZE * sizeof(hal_index_entry_t);
+
+    hal_data->name_index = 0;
+    hal_data->name_index_size = 0;
+    hal_data->name_index_used = 0;
+    table = shmalloc_dn(bytes);
+    if (table == NULL) {
+	return;
+    }
+    memset(table, 0, bytes);
+    hal_data->name_index = SHMOFF(table);
+    hal_data->name_index_size = HAL_INDEX_INITIAL_SIZE;
+}
+
+static void bump_generation(void)
+{
+    atomic_fetch_add_explicit(&hal_data->generation, 1, memory_order_release);
+}
+
+static void index_add(unsigned kind, void *obj, const char *name)
+{
+    bump_generation();
+    if (hal_data->name_index_size == 0) {
+	return;
+    }
+    /* keep the table at most 3/4 full (including deleted entries) */
+    if ((hal_data->name_index_used + 1) * 4 > hal_data->name_index_size * 3) {
+	if (index_rehash() != 0) {
+	    /* out of memory, fall back to searching the lists */
+	    rtapi_print_msg(RTAPI_MSG_WARN,
+		"HAL: WARNING: insufficient memory for name index, lookups will be slower\n");
+	    hal_data->name_index_size = 0;
+	    hal_data->name_index = 0;
+	    return;
+	}
+    }
+    hal_data->name_index_used += index_insert(SHMPTR(hal_data->name_index),
+	hal_data->name_index_size, index_key(kind, name), SHMOFF(obj));
+}
+
+static void index_remove(unsigned kind, void *obj, const char *name)
+{
+    hal_index_entry_t *table;
+    rtapi_u32 key;
+    rtapi_s32 ofs;
+    int mask, n;
+
+    bump_generation();
+    if (hal_data->name_index_size == 0) {
+	return;
+    }
+    table = SHMPTR(hal_data->name_index);
+    key = index_key(kind, name);
+    ofs = SHMOFF(obj);
+    mask = hal_data->name_index_size - 1;
+    for (n = (key >> 3) & mask; table[n].obj != 0; n = (n + 1) & mask) {
+	if (table[n].key == key && table[n].obj == ofs) {
+	    table[n].obj = HAL_INDEX_DELETED;
+	    return;
+	}
+    }
+}
+
+static void *index_find(unsigned kind, const char *name)
+{
+    hal_index_entry_t *table;
+    rtapi_u32 key;
+    int mask, n;
+
+    table = SHMPTR(hal_data->name_index);
+    key = index_key(kind, name);
+    mask = hal_data->name_index_size - 1;
+    for (n = (key >> 3) & mask; table[n].obj != 0; n = (n + 1) & mask) {
+	if (table[n].key == key && table[n].obj > 0
+	    && index_obj_matches(kind, SHMPTR(table[n].obj), name)) {
+	    return SHMPTR(table[n].obj);
+	}
+    }
+    return NULL;
+}
+
 hal_comp_t *halpr_find_comp_by_name(const char *name)
 {
     int next;
     hal_comp_t *comp;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_COMP, name);
+    }
+
     /* search component list for 'name' */
     next = hal_data->comp_list_ptr;
     while (next != 0) {
@@ -3220,6 +3689,10 @@ hal_pin_t *halpr_find_pin_by_name(const char *name)
     hal_pin_t *pin;
     hal_oldname_t *oldname;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_PIN, name);
+    }
+
     /* search pin list for 'name' */
     next = hal_data->pin_list_ptr;
     while (next != 0) {
@@ -3247,6 +3720,10 @@ hal_sig_t *halpr_find_sig_by_name(const char *name)
     int next;
     hal_sig_t *sig;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_SIG, name);
+    }
+
     /* search signal list for 'name' */
     next = hal_data->sig_list_ptr;
     while (next != 0) {
@@ -3268,6 +3745,10 @@ hal_param_t *halpr_find_param_by_name(const char *name)
     hal_param_t *param;
     hal_oldname_t *oldname;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_PARAM, name);
+    }
+
     /* search parameter list for 'name' */
     next = hal_data->param_list_ptr;
     while (next != 0) {
@@ -3295,6 +3776,10 @@ hal_thread_t *halpr_find_thread_by_name(const char *name)
     int next;
     hal_thread_t *thread;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_THREAD, name);
+    }
+
     /* search thread list for 'name' */
     next = hal_data->thread_list_ptr;
     while (next != 0) {
@@ -3315,6 +3800,10 @@ hal_funct_t *halpr_find_funct_by_name(const char *name)
     int next;
     hal_funct_t *funct;
 
+    if (hal_data->name_index_size) {
+	return index_find(HAL_INDEX_FUNCT, name);
+    }
+
     /* search function list for 'name' */
     next = hal_data->funct_list_ptr;
     while (next != 0) {
@@ -3650,8 +4139,18 @@ static void thread_task(void *arg)
 	    start_time = rtapi_get_time();
 	    end_time = start_time;
 	    thread_start_time = start_time;
+	    /* let the workers know that a cycle started */
+	    thread->cycle++;
 	    /* run thru function list */
 	    while (funct_entry != funct_root) {
+		if (funct_entry->group && thread->nworkers > 0) {
+		    /* run the parallel group together with the workers,
+		       they time the functions they run themselves */
+		    funct_entry = run_group(thread, funct_root, funct_entry);
+		    end_time = rtapi_get_time();
+		    start_time = end_time;
+		    continue;
+		}
 		/* call the function */
 		funct_entry->funct(funct_entry->arg, thread->period);
 		/* capture execution time */
@@ -3659,29 +4158,151 @@ static void thread_task(void *arg)
 		/* point to function structure */
 		funct = SHMPTR(funct_entry->funct_ptr);
 		/* update execution time data */
-		rtapi_s32 runtime = hal_set_si32(funct->runtime, end_time - start_time);
-		if ( runtime > hal_get_si32(funct->maxtime)) {
-		    hal_set_si32(funct->maxtime, runtime);
-		    hal_set_bool(funct->maxtime_increased, 1);
-		} else {
-		    hal_set_bool(funct->maxtime_increased, 0);
-		}
+		funct_timing(funct, end_time - start_time);
 		/* point to next next entry in list */
 		funct_entry = SHMPTR(funct_entry->links.next);
 		/* prepare to measure time for next funct */
 		start_time = end_time;
 	    }
+	    thread->cycle_done = thread->cycle;
 	    /* update thread execution time */
 	    rtapi_s32 runtime = hal_set_si32(thread->runtime, end_time - thread_start_time);
 	    if ( runtime > hal_get_si32(thread->maxtime)) {
 	        hal_set_si32(thread->maxtime, runtime);
 	    }
+	    if (thread->hist) {
+		hal_hist_t *hist = SHMPTR(thread->hist);
+		if (hist->enabled) {
+		    hist_add(hist, end_time - thread_start_time);
+		}
+	    }
             hal_set_sint(thread->threadbeat, ++thread->beatcnt);
 	}
 	/* wait until next period */
 	rtapi_wait();
     }
 }
+
+static void funct_timing(hal_funct_t *funct, long long int runtime)
+{
+    rtapi_s32 rt = hal_set_si32(funct->runtime, runtime);
+    if (rt > hal_get_si32(funct->maxtime)) {
+	hal_set_si32(funct->maxtime, rt);
+	hal_set_bool(funct->maxtime_increased, 1);
+    } else {
+	hal_set_bool(funct->maxtime_increased, 0);
+    }
+    if (funct->hist) {
+	hal_hist_t *hist = SHMPTR(funct->hist);
+	if (hist->enabled) {
+	    hist_add(hist, runtime);
+	}
+    }
+}
+
+static hal_funct_entry_t *run_group(hal_thread_t *thread,
+    hal_funct_entry_t *root, hal_funct_entry_t *entry)
+{
+    int group = entry->group;
+    int n = 0;
+
+    while (entry != root && entry->group == group && n < HAL_GROUP_DISPATCH) {
+	thread->work[n++] = SHMOFF(entry);
+	entry = SHMPTR(entry->links.next);
+    }
+    thread->work_done = 0;
+    /* the entries must be visible before the workers can claim them */
+    __sync_synchronize();
+    thread->work_state = (rtapi_u32) n << 16;
+    /* run our share and wait for the workers to finish theirs */
+    run_work(thread);
+    while (thread->work_done < n) {
+    }
+    __sync_synchronize();
+    return entry;
+}
+
+static void run_work(hal_thread_t *thread)
+{
+    rtapi_u32 state;
+    hal_funct_entry_t *entry;
+    long long int start_time;
+
+    while (1) {
+	state = thread->work_state;
+	if ((state & 0xffff) >= (state >> 16)) {
+	    /* every dispatched entry has been claimed */
+	    return;
+	}
+	if (!__sync_bool_compare_and_swap(&thread->work_state, state, state + 1)) {
+	    /* somebody else claimed it, try the next one */
+	    continue;
+	}
+	entry = SHMPTR(thread->work[state & 0xffff]);
+	start_time = rtapi_get_time();
+	entry->funct(entry->arg, thread->period);
+	funct_timing(SHMPTR(entry->funct_ptr), rtapi_get_time() - start_time);
+	__sync_fetch_and_add(&thread->work_done, 1);
+    }
+}
+
+static void worker_task(void *arg)
+{
+    hal_thread_t *thread = arg;
+    rtapi_u32 cycle = thread->cycle;
+    long long int deadline;
+
+    while (1) {
+	if (hal_data->threads_running > 0) {
+	    /* wait for the thread to start its next cycle, but not
+	       longer than a period so a stopped thread does not keep
+	       us spinning */
+	    deadline = rtapi_get_time() + thread->period;
+	    while (thread->cycle == cycle && rtapi_get_time() < deadline) {
+	    }
+	    if (thread->cycle != cycle) {
+		cycle = thread->cycle;
+		/* wake up just after the thread starts the next cycle */
+		rtapi_task_self_resync();
+		/* help with the parallel groups until the cycle is done */
+		while ((rtapi_s32) (thread->cycle_done - cycle) < 0) {
+		    run_work(thread);
+		}
+	    }
+	}
+	rtapi_wait();
+    }
+}
+
+/* The bins are log2 spaced with two bins per octave: bin 2n counts
+   2^n up to 1.5*2^n nsec and bin 2n+1 counts 1.5*2^n up to 2^(n+1)
+   nsec.  Bins 0 and 1 count 0 and 1 nsec, the last bin also counts
+   everything longer.  hal_histogram_bin_start() must match this. */
+static void hist_add(hal_hist_t *h, long long int ns)
+{
+    int bin, n;
+
+    if (h->reset) {
+	memset(h->count, 0, sizeof(h->count));
+	h->reset = 0;
+    }
+    if (ns < 2) {
+	bin = ns < 0 ? 0 : (int) ns;
+    } else if (ns >= (1LL << (HAL_HIST_BINS / 2))) {
+	bin = HAL_HIST_BINS - 1;
+    } else {
+	n = 31 - __builtin_clz((unsigned int) ns);
+	bin = 2 * n + (int) ((ns >> (n - 1)) & 1);
+    }
+    h->count[bin]++;
+}
+
+static void hist_clear(hal_hist_t *h)
+{
+    h->enabled = 0;
+    h->reset = 0;
+    memset(h->count, 0, sizeof(h->count));
+}
 #endif /* RTAPI */
 
 /* see the declarations of these functions (near top of file) for
@@ -3744,6 +4365,9 @@ static int init_hal_data(void)
     hal_data->shmem_bot = sizeof(hal_data_t);
     hal_data->shmem_top = HAL_SIZE;
     hal_data->lock = HAL_LOCK_NONE;
+    /* set up the name index */
+    index_init();
+    atomic_init(&hal_data->generation, 0);
     /* done, release mutex */
     halpr_mutex_release();
     return 0;
@@ -3976,6 +4600,9 @@ static hal_funct_t *alloc_funct_struct(void)
     } else {
 	/* nothing on free list, allocate a brand new one */
 	p = shmalloc_dn(sizeof(hal_funct_t));
+	if (p) {
+	    p->hist = 0;
+	}
     }
     if (p) {
 	/* make sure it's empty */
@@ -4015,6 +4642,7 @@ static hal_funct_entry_t *alloc_funct_entry_struct(void)
 	p->funct_ptr = 0;
 	p->arg = NULL;
 	p->funct = NULL;
+	p->group = 0;
     }
     return p;
 }
@@ -4034,6 +4662,9 @@ static hal_thread_t *alloc_thread_struct(void)
     } else {
 	/* nothing on free list, allocate a brand new one */
 	p = shmalloc_dn(sizeof(hal_thread_t));
+	if (p) {
+	    p->hist = 0;
+	}
     }
     if (p) {
 	/* make sure it's empty */
@@ -4046,6 +4677,12 @@ static hal_thread_t *alloc_thread_struct(void)
 	list_init_entry(&(p->init_funct_list));
 	p->init_done = 0;
 	p->name[0] = '\0';
+	p->nworkers = 0;
+	p->cycle = 0;
+	p->cycle_done = 0;
+	p->work_state = 0;
+	p->work_done = 0;
+	memset(p->group_names, 0, sizeof(p->group_names));
     }
     return p;
 }
@@ -4060,6 +4697,7 @@ static void free_comp_struct(hal_comp_t * comp)
     hal_pin_t *pin;
     hal_param_t *param;
 
+    index_remove(HAL_INDEX_COMP, comp, comp->name);
     /* can't delete the component until we delete its "stuff" */
     /* need to check for functs only if a realtime component */
 #ifdef RTAPI
@@ -4186,15 +4824,19 @@ static void unlink_pin(hal_pin_t * pin)
     }
     /* mark pin as unlinked */
     pin->signal = 0;
+    bump_generation();
     }
 }
 
 static void free_pin_struct(hal_pin_t * pin)
 {
     unlink_pin(pin);
+    index_remove(HAL_INDEX_PIN, pin, pin->name);
     /* clear contents of struct */
     if ( pin->oldname != 0 ) {
-        free_oldname_struct(SHMPTR(pin->oldname));
+        hal_oldname_t *oldname = SHMPTR(pin->oldname);
+        index_remove(HAL_INDEX_PIN, pin, oldname->name);
+        free_oldname_struct(oldname);
         pin->oldname = 0;
     }
     pin->data_ptr_addr = 0;
@@ -4213,6 +4855,7 @@ static void free_sig_struct(hal_sig_t * sig)
 {
     hal_pin_t *pin;
 
+    index_remove(HAL_INDEX_SIG, sig, sig->name);
     /* look for pins linked to this signal */
     pin = halpr_find_pin_by_sig(sig, NULL);
     while (pin != NULL) {
@@ -4235,9 +4878,12 @@ static void free_sig_struct(hal_sig_t * sig)
 
 static void free_param_struct(hal_param_t * p)
 {
+    index_remove(HAL_INDEX_PARAM, p, p->name);
     /* clear contents of struct */
     if ( p->oldname != 0 ) {
-        free_oldname_struct(SHMPTR(p->oldname));
+        hal_oldname_t *oldname = SHMPTR(p->oldname);
+        index_remove(HAL_INDEX_PARAM, p, oldname->name);
+        free_oldname_struct(oldname);
         p->oldname = 0;
     }
     p->data_ptr = 0;
@@ -4271,6 +4917,7 @@ static void free_funct_struct(hal_funct_t * funct)
 
 /*  int next_thread, next_entry;*/
 
+    index_remove(HAL_INDEX_FUNCT, funct, funct->name);
     if (funct->users > 0) {
 	/* We can't casually delete the function, there are thread(s) which
 	   will call it.  So we must check all the threads and remove any
@@ -4325,6 +4972,9 @@ static void free_funct_struct(hal_funct_t * funct)
     funct->arg = 0;
     funct->funct = 0;
     funct->runtime = 0;
+    if (funct->hist) {
+	hist_clear(SHMPTR(funct->hist));
+    }
     funct->name[0] = '\0';
     /* add it to free list */
     funct->next_ptr = hal_data->funct_free_ptr;
@@ -4345,6 +4995,7 @@ static void free_funct_entry_struct(hal_funct_entry_t * funct_entry)
     funct_entry->funct_ptr = 0;
     funct_entry->arg = NULL;
     funct_entry->funct = NULL;
+    funct_entry->group = 0;
     /* add it to free list */
     list_add_after((hal_list_t *) funct_entry, &(hal_data->funct_entry_free));
 }
@@ -4361,16 +5012,26 @@ static void free_thread_struct(hal_thread_t * thread)
     hal_param_t *param;
 #endif
 
+    index_remove(HAL_INDEX_THREAD, thread, thread->name);
     /* if we're deleting a thread, we need to stop all threads */
     hal_data->threads_running = 0;
     /* and stop the task associated with this thread */
     rtapi_task_pause(thread->task_id);
     rtapi_task_delete(thread->task_id);
+    /* and the tasks of its workers */
+    while (thread->nworkers > 0) {
+	thread->nworkers--;
+	rtapi_task_pause(thread->worker_task_id[thread->nworkers]);
+	rtapi_task_delete(thread->worker_task_id[thread->nworkers]);
+    }
     /* clear contents of struct */
     thread->uses_fp = 0;
     thread->period = 0;
     thread->priority = 0;
     thread->task_id = 0;
+    if (thread->hist) {
+	hist_clear(SHMPTR(thread->hist));
+    }
     /* clear the function entry list */
     list_root = &(thread->funct_list);
     list_entry = list_next(list_root);
@@ -5033,6 +5694,35 @@ int hal_stream_read(hal_stream_t *stream, hal_stream_data_u *buf, unsigned *this
     return 0;
 }
 
+int hal_stream_read_many(hal_stream_t *stream, hal_stream_data_u *buf, unsigned *this_sample, int max_samples)
+{
+    if(!stream || !stream->fifo || !buf || max_samples <= 0) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "hal_stream_read_many: Invalid stream\n");
+        return -EINVAL;
+    }
+    /* one acquire of 'in' covers every row up to it, and one release
+       of 'out' hands all of them back to the writer at once */
+    unsigned in = hal_stream_atomic_load_in(stream);
+    unsigned out = hal_stream_atomic_load_out(stream);
+    if(in == out) {
+        stream->fifo->num_underruns++;
+        return -ENOSPC;
+    }
+    unsigned depth = stream->fifo->depth;
+    int num_pins = stream->fifo->num_pins;
+    int stride = num_pins + 1;
+    int n;
+    for(n = 0; n < max_samples && out != in; n++) {
+        hal_stream_data_u *dptr = &stream->fifo->data[out * stride];
+        memcpy(buf, dptr, sizeof(hal_stream_data_u) * num_pins);
+        buf += num_pins;
+        if(this_sample) this_sample[n] = dptr[num_pins].s;
+        if(++out >= depth) out = 0;
+    }
+    hal_stream_atomic_store_out(stream, out);
+    return n;
+}
+
 int hal_stream_attach(hal_stream_t *stream, int comp_id, int key, const char *typestring)
 {
     if(!stream) {
@@ -5236,8 +5926,11 @@ EXPORT_SYMBOL(hal_export_funct);
 EXPORT_SYMBOL(hal_export_functf);
 
 EXPORT_SYMBOL(hal_create_thread);
+EXPORT_SYMBOL(hal_create_thread_cpu);
+EXPORT_SYMBOL(hal_thread_add_worker);
 
 EXPORT_SYMBOL(hal_add_funct_to_thread);
+EXPORT_SYMBOL(hal_add_funct_to_group);
 EXPORT_SYMBOL(hal_init_funct_to_thread);
 EXPORT_SYMBOL(hal_del_funct_from_thread);
 
@@ -5280,6 +5973,7 @@ EXPORT_SYMBOL_GPL(hal_stream_depth);
 EXPORT_SYMBOL_GPL(hal_stream_maxdepth);
 EXPORT_SYMBOL_GPL(hal_stream_write);
 EXPORT_SYMBOL_GPL(hal_stream_read);
+EXPORT_SYMBOL_GPL(hal_stream_read_many);
 EXPORT_SYMBOL_GPL(hal_stream_attach);
 EXPORT_SYMBOL_GPL(hal_stream_detach);
 EXPORT_SYMBOL_GPL(hal_stream_element_count);
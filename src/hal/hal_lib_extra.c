@@ -17,6 +17,7 @@
 
 #include "hal.h"
 #include "hal_priv.h"
+#include <rtapi_string.h>
 
 //
 // Allow user-land to forcefully release the HAL mutex.
@@ -113,3 +114,114 @@ int hal_comp_insmod_args(const char *compname, const char *args)
     halpr_mutex_release();
     return 0;
 }
+
+//
+// Keep the HAL mutex locked across several HAL calls. The mutex is
+// recursive, so the calls in between still work, but they no longer
+// compete for the lock one by one.
+//
+int hal_batch_begin(void)
+{
+    if(NULL == hal_data) {
+        rtapi_print_msg(RTAPI_MSG_DBG, "hal_batch_begin: HAL shared memory not mapped\n");
+        return -EFAULT;
+    }
+    halpr_mutex_acquire();
+    return 0;
+}
+
+int hal_batch_end(void)
+{
+    if(NULL == hal_data) {
+        rtapi_print_msg(RTAPI_MSG_DBG, "hal_batch_end: HAL shared memory not mapped\n");
+        return -EFAULT;
+    }
+    halpr_mutex_release();
+    return 0;
+}
+
+//
+// Switch the execution time histogram of a function or thread on or off, or
+// clear its counts. The histogram is allocated the first time it is switched
+// on. The realtime thread is the only one writing the counts while it runs,
+// so a reset is handed to the thread when the histogram is counting.
+//
+int hal_histogram(const char *name, hal_hist_cmd_t cmd)
+{
+    if(NULL == hal_data) {
+        rtapi_print_msg(RTAPI_MSG_DBG, "hal_histogram: HAL shared memory not mapped\n");
+        return -EFAULT;
+    }
+    if(!name || cmd < HAL_HIST_OFF || cmd > HAL_HIST_RESET) {
+        rtapi_print_msg(RTAPI_MSG_DBG, "hal_histogram: Invalid arguments\n");
+        return -EINVAL;
+    }
+
+    halpr_mutex_acquire();
+    SHMFIELD(hal_hist_t) *histref;
+    hal_funct_t *funct = halpr_find_funct_by_name(name);
+    if(funct) {
+        histref = &funct->hist;
+    } else {
+        hal_thread_t *thread = halpr_find_thread_by_name(name);
+        if(!thread) {
+            halpr_mutex_release();
+            rtapi_print_msg(RTAPI_MSG_DBG, "hal_histogram: Function or thread '%s' not found\n", name);
+            return -ENOENT;
+        }
+        histref = &thread->hist;
+    }
+
+    if(!*histref) {
+        if(HAL_HIST_ON != cmd) {
+            // Never switched on, there is nothing to switch off or clear
+            halpr_mutex_release();
+            return 0;
+        }
+        hal_hist_t *h = (hal_hist_t *)hal_malloc(sizeof(hal_hist_t));
+        if(!h) {
+            halpr_mutex_release();
+            rtapi_print_msg(RTAPI_MSG_ERR, "hal_histogram: No memory for histogram of '%s'\n", name);
+            return -ENOMEM;
+        }
+        memset(h, 0, sizeof(*h));
+        // The thread may see the histogram as soon as it is linked
+        __sync_synchronize();
+        *histref = SHMOFF(h);
+    }
+
+    hal_hist_t *h = (hal_hist_t *)SHMPTR(*histref);
+    switch(cmd) {
+    case HAL_HIST_OFF:
+        h->enabled = 0;
+        break;
+    case HAL_HIST_ON:
+        h->enabled = 1;
+        break;
+    case HAL_HIST_RESET:
+        if(h->enabled && hal_data->threads_running > 0) {
+            h->reset = 1;
+        } else {
+            memset(h->count, 0, sizeof(h->count));
+            h->reset = 0;
+        }
+        break;
+    }
+    halpr_mutex_release();
+    return 0;
+}
+
+//
+// Start of a histogram bin in nsec. This must match the binning in
+// hist_add() in hal_lib.c: two bins per octave, where bin 2n starts at 2^n
+// and bin 2n+1 starts at 1.5*2^n nsec.
+//
+rtapi_u64 hal_histogram_bin_start(int bin)
+{
+    if(bin < 2)
+        return bin < 0 ? 0 : bin;
+    if(bin >= HAL_HIST_BINS)
+        bin = HAL_HIST_BINS - 1;
+    int n = bin / 2;
+    return (bin & 1) ? (rtapi_u64)3 << (n - 1) : (rtapi_u64)1 << n;
+}
@@ -604,6 +604,20 @@ int hal_getref_p(hal_query_t *q)
     return 0;
 }
 
+//
+// hal_generation() - Retrieve the HAL topology generation
+//
+// Read without taking the mutex. A reference from hal_getref_[ps]() is
+// still the one the name resolves to while the generation is the same as
+// it was before the reference was retrieved.
+//
+rtapi_u32 hal_generation(void)
+{
+    if(NULL == hal_data)
+        return 0;
+    return atomic_load_explicit(&hal_data->generation, memory_order_acquire);
+}
+
 //
 // Iterate all pins/params with a callback
 //
@@ -836,6 +850,21 @@ int hal_list_comp(hal_query_t *q, hal_query_cb cb, void *arg)
     return rv;
 }
 
+//
+// Histogram counts for a function or thread query, NULL if the histogram
+// was never switched on
+//
+static const rtapi_u64 *query_hist(SHMFIELD(hal_hist_t) hist, bool *on)
+{
+    if(!hist) {
+        *on = false;
+        return NULL;
+    }
+    hal_hist_t *h = (hal_hist_t *)SHMPTR(hist);
+    *on = !!h->enabled;
+    return h->count;
+}
+
 //
 // Iterate all functions with a callback
 //
@@ -867,6 +896,7 @@ int hal_list_funct(hal_query_t *q, hal_query_cb cb, void *arg)
         q->funct.arg     = (rtapi_intptr_t)funct->arg;   // Purely informational
         q->funct.funct   = (rtapi_intptr_t)funct->funct; // Purely informational
         q->funct.reentrant = !!funct->reentrant;
+        q->funct.hist    = query_hist(funct->hist, &q->funct.hist_on);
         if(0 != (rv = cb(q, arg))) {
             // Non-zero return from the callback breaks the loop and we're done
             break;
@@ -916,9 +946,14 @@ int hal_list_thread(hal_query_t *q, hal_query_cb cb, void *arg)
         q->thread.comp = compname;
         q->thread.priority = thread->priority;
         q->thread.period   = thread->period;
+        q->thread.cpu      = thread->cpu;
+        q->thread.hist     = query_hist(thread->hist, &q->thread.hist_on);
+        q->thread.workers  = thread->nworkers;
+        q->thread.worker_cpu = thread->worker_cpu;
         q->thread.functidx = 0;
         q->thread.funct    = NULL;
         q->thread.is_init  = 0;
+        q->thread.group    = NULL;
         q->qtype           = HAL_QTYPE_THREAD;
         // Callback on the thread
         if(0 != (rv = cb(q, arg))) {
@@ -937,11 +972,16 @@ int hal_list_thread(hal_query_t *q, hal_query_cb cb, void *arg)
                 q->thread.comp = compname;
                 q->thread.priority = thread->priority;
                 q->thread.period   = thread->period;
+                q->thread.cpu      = thread->cpu;
+                q->thread.hist     = query_hist(thread->hist, &q->thread.hist_on);
+                q->thread.workers  = thread->nworkers;
+                q->thread.worker_cpu = thread->worker_cpu;
                 // Function level data
                 q->qtype           = HAL_QTYPE_THREAD_FUNCT;
                 q->thread.functidx = cnt;
                 q->thread.funct    = funct->name;
                 q->thread.is_init  = 0;
+                q->thread.group    = entry->group ? thread->group_names[entry->group - 1] : NULL;
                 if(0 != (rv = cb(q, arg))) {
                     // Non-zero return from the callback quits and we're done
                     halpr_mutex_release();
@@ -960,11 +1000,16 @@ int hal_list_thread(hal_query_t *q, hal_query_cb cb, void *arg)
                 q->thread.comp = compname;
                 q->thread.priority = thread->priority;
                 q->thread.period   = thread->period;
+                q->thread.cpu      = thread->cpu;
+                q->thread.hist     = query_hist(thread->hist, &q->thread.hist_on);
+                q->thread.workers  = thread->nworkers;
+                q->thread.worker_cpu = thread->worker_cpu;
                 // Function level data
                 q->qtype           = HAL_QTYPE_THREAD_FUNCT;
                 q->thread.functidx = cnt;
                 q->thread.funct    = funct->name;
                 q->thread.is_init  = 1;
+                q->thread.group    = NULL;
                 if(0 != (rv = cb(q, arg))) {
                     // Non-zero return from the callback quits and we're done
                     halpr_mutex_release();
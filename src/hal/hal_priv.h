@@ -94,6 +94,7 @@
 
 #include <rtapi.h>
 #include <rtapi_mutex.h>
+#include <rtapi_atomic.h>
 
 /* IMPORTANT:  If any of the structures in this file are changed, the
    version code (HAL_VER) must be incremented, to ensure that 
@@ -118,7 +119,7 @@
 */
 
 #define HAL_KEY   0x48414C32	/* key used to open HAL shared memory */
-#define HAL_VER   0x00000014	/* version code */
+#define HAL_VER   0x00000019	/* version code */
 #define HAL_SIZE  (2*256*4096)
 
 /* These pointers are set by hal_init() to point to the shmem block
@@ -238,6 +239,19 @@ typedef struct hal_oldname_t {
     char name[HAL_NAME_LEN + 1];	/* the original name */
 } hal_oldname_t;
 
+/** HAL "name index" data structure.
+    The name index is an open addressing hash table, stored in shared
+    memory, that maps object names to the object.  It is used by the
+    'halpr_find_xxx_by_name()' functions instead of walking the lists.
+    'key' holds the hash of the name with the object kind in the low
+    bits, 'obj' is the offset of the object, zero for an empty slot and
+    -1 for a deleted one.
+*/
+typedef struct hal_index_entry_t {
+    rtapi_u32 key;		/* name hash and object kind */
+    rtapi_s32 obj;		/* offset of object, 0 empty, -1 deleted */
+} hal_index_entry_t;
+
 typedef struct hal_comp_t hal_comp_t;
 typedef struct hal_pin_t hal_pin_t;
 typedef struct hal_sig_t hal_sig_t;
@@ -245,6 +259,7 @@ typedef struct hal_param_t hal_param_t;
 typedef struct hal_funct_t hal_funct_t;
 typedef struct hal_funct_entry_t hal_funct_entry_t;
 typedef struct hal_thread_t hal_thread_t;
+typedef struct hal_hist_t hal_hist_t;
 
 /* Master HAL data structure
    There is a single instance of this structure in the machine.
@@ -296,6 +311,11 @@ typedef struct hal_data_t {
 				   period request exactly */
     rtapi_realtime_type_t realtime_type;	/* reflects the running realtime type */
     unsigned char lock;         /* hal locking, can be one of the HAL_LOCK_* types */
+    SHMFIELD(hal_index_entry_t) name_index;	/* hash table of object names */
+    int name_index_size;	/* slots in name_index, 0 if not in use */
+    int name_index_used;	/* slots holding an entry or a deleted entry */
+    rtapi_atomic_uint generation;	/* changed when objects are added, removed,
+				   renamed, linked or unlinked */
 } hal_data_t;
 
 //
@@ -388,6 +408,19 @@ struct hal_param_t {
     that identify the functions connected to that thread.
 */
 
+/** An execution time histogram is allocated the first time it is
+    switched on and stays with its function or thread from then on.
+    The realtime thread is the only writer of the counts: user space
+    requests a reset by setting 'reset' and the thread clears the counts
+    before it adds the next sample.  A re-entrant function that is
+    called from more than one thread may occasionally lose a count.
+*/
+struct hal_hist_t {
+    volatile int enabled;	/* non-zero while samples are counted */
+    volatile int reset;		/* set by user space, cleared by the thread */
+    rtapi_u64 count[HAL_HIST_BINS];	/* number of samples per bin */
+};
+
 struct hal_funct_t {
     SHMFIELD(hal_funct_t) next_ptr;		/* next function in linked list */
     int uses_fp;		/* floating point flag */
@@ -402,6 +435,7 @@ struct hal_funct_t {
     hal_sint_t runtime;	/* (pin) duration of last run, in CPU cycles */
     hal_sint_t maxtime;	/* (param) duration of longest run, in CPU cycles */
     hal_bool_t maxtime_increased;	/* (param) on last call, maxtime increased */
+    SHMFIELD(hal_hist_t) hist;	/* execution time histogram, 0 if never used */
     char name[HAL_NAME_LEN + 1];	/* function name */
 };
 
@@ -410,16 +444,29 @@ struct hal_funct_entry_t {
     void *arg;			/* argument for function */
     void (*funct) (void *, long);	/* ptr to function code */
     SHMFIELD(hal_funct_t) funct_ptr;		/* pointer to function */
+    int group;			/* parallel group, index into the thread's
+				   group_names plus one, 0 if none */
 };
 
 #define HAL_STACKSIZE 16384	/* realtime task stacksize */
 
+/** The functions of a parallel group are handed to the workers of a
+    thread HAL_GROUP_DISPATCH at a time.  'work_state' holds the number
+    of dispatched entries in the upper 16 bits and the index of the next
+    entry to run in the lower 16 bits.  The thread and its workers claim
+    entries by incrementing the index with a compare-and-swap, and count
+    the entries they finished in 'work_done'.  A dispatch only starts
+    after all entries of the previous one are done.
+*/
+#define HAL_GROUP_DISPATCH 32
+
 struct hal_thread_t {
     SHMFIELD(hal_thread_t) next_ptr;		/* next thread in linked list */
     int uses_fp;		/* floating point flag */
     long int period;		/* period of the thread, in nsec */
     int priority;		/* priority of the thread */
     int task_id;		/* ID of the task that runs this thread */
+    int cpu;			/* CPU the task is bound to, -1 for default */
     // IMPORTANT: The pins and params are valid as seen from the context that
     // created them. For uspace that is rtapi_app and in the kernel it is the
     // kernel's module context.
@@ -427,11 +474,21 @@ struct hal_thread_t {
     hal_sint_t maxtime;	/* (param) duration of longest run, in ns */
     hal_sint_t threadbeat; /* (pin) visible monotonic loop beat counter */
     rtapi_sint beatcnt;    /* Thread monotonic increasing loop beat counter (so we don't need to read/write volatile) */
+    SHMFIELD(hal_hist_t) hist;	/* execution time histogram, 0 if never used */
     hal_list_t funct_list;	/* list of functions to run */
     hal_list_t init_funct_list;	/* list of init functions, run once before first cyclic cycle */
     int init_done;		/* 0 = init pending, 1 = init cycle has executed */
     char name[HAL_NAME_LEN + 1];	/* thread name */
     int comp_id;
+    int nworkers;		/* number of worker tasks */
+    int worker_task_id[HAL_THREAD_WORKERS];	/* tasks of the workers */
+    int worker_cpu[HAL_THREAD_WORKERS];	/* CPUs of the workers */
+    volatile rtapi_u32 cycle;	/* incremented when a cycle starts */
+    volatile rtapi_u32 cycle_done;	/* set to 'cycle' when the cycle ends */
+    volatile rtapi_u32 work_state;	/* dispatched entries and next one */
+    volatile int work_done;	/* number of dispatched entries done */
+    SHMFIELD(hal_funct_entry_t) work[HAL_GROUP_DISPATCH];	/* dispatched entries */
+    char group_names[HAL_THREAD_GROUPS][HAL_NAME_LEN + 1];	/* parallel groups */
 };
 
 /***********************************************************************
@@ -478,7 +535,9 @@ hal_list_t *list_remove_entry(hal_list_t * entry);
 
 /** The 'find_xxx_by_name()' functions search the appropriate list for
     an object that matches 'name'.  They return a pointer to the object,
-    or NULL if no matching object is found.
+    or NULL if no matching object is found.  The lookup goes through the
+    name index in hal_data, pins and parameters are also found by their
+    original name if they have been aliased.
 */
 extern hal_comp_t *halpr_find_comp_by_name(const char *name);
 extern hal_pin_t *halpr_find_pin_by_name(const char *name);
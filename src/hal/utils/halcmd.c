@@ -138,7 +138,7 @@ struct halcmd_command halcmd_commands[] = {
     {"alias",   FUNCT(do_alias_cmd, cp_cp_cp), A_THREE },
     {"delf",    FUNCT(do_delf_cmd, cp_cp),     A_TWO | A_OPTIONAL },
     {"delsig",  FUNCT(do_delsig_cmd, cp),      A_ONE },
-    {"debug",   FUNCT(do_set_debug_cmd, cp),   A_ONE },
+    {"debug",   FUNCT(do_set_debug_cmd, cp),   A_ONE | A_EXTERNAL },
     {"echo",    FUNCT(do_echo_cmd, v),         A_ZERO },
     {"getp",    FUNCT(do_getp_cmd, cp),        A_ONE },
     {"gets",    FUNCT(do_gets_cmd, cp),        A_ONE },
@@ -146,11 +146,12 @@ struct halcmd_command halcmd_commands[] = {
     {"ptype",   FUNCT(do_ptype_cmd, cp),       A_ONE },
     {"stype",   FUNCT(do_stype_cmd, cp),       A_ONE },
     {"help",    FUNCT(do_help_cmd, cp),        A_ONE | A_OPTIONAL },
+    {"histogram", FUNCT(do_histogram_cmd, cp_cpp), A_ONE | A_PLUS },
     {"linkps",  FUNCT(do_linkps_cmd, cp_cp),   A_TWO | A_REMOVE_ARROWS },
     {"linksp",  FUNCT(do_linksp_cmd, cp_cp),   A_TWO | A_REMOVE_ARROWS },
     {"list",    FUNCT(do_list_cmd, cp_cpp),    A_ONE | A_PLUS },
-    {"loadrt",  FUNCT(do_loadrt_cmd, cp_cpp),  A_ONE | A_PLUS },
-    {"loadusr", FUNCT(do_loadusr_cmd, ccpp),   A_PLUS | A_TILDE },
+    {"loadrt",  FUNCT(do_loadrt_cmd, cp_cpp),  A_ONE | A_PLUS | A_EXTERNAL },
+    {"loadusr", FUNCT(do_loadusr_cmd, ccpp),   A_PLUS | A_TILDE | A_EXTERNAL },
     {"lock",    FUNCT(do_lock_cmd, cp),        A_ONE | A_OPTIONAL },
     {"net",     FUNCT(do_net_cmd, cp_cpp),     A_ONE | A_PLUS | A_REMOVE_ARROWS },
     {"newsig",  FUNCT(do_newsig_cmd, cp_cp),   A_TWO },
@@ -166,11 +167,11 @@ struct halcmd_command halcmd_commands[] = {
     {"unalias", FUNCT(do_unalias_cmd, cp_cp),  A_TWO },
     {"unecho",  FUNCT(do_unecho_cmd, v),       A_ZERO },
     {"unlinkp", FUNCT(do_unlinkp_cmd, cp),     A_ONE },
-    {"unload",  FUNCT(do_unload_cmd, cp),      A_ONE },
-    {"unloadrt", FUNCT(do_unloadrt_cmd, cp),   A_ONE },
-    {"unloadusr", FUNCT(do_unloadusr_cmd, cp), A_ONE },
+    {"unload",  FUNCT(do_unload_cmd, cp),      A_ONE | A_EXTERNAL },
+    {"unloadrt", FUNCT(do_unloadrt_cmd, cp),   A_ONE | A_EXTERNAL },
+    {"unloadusr", FUNCT(do_unloadusr_cmd, cp), A_ONE | A_EXTERNAL },
     {"unlock",  FUNCT(do_unlock_cmd, cp),      A_ONE | A_OPTIONAL },
-    {"waitusr", FUNCT(do_waitusr_cmd, cp),     A_ONE },
+    {"waitusr", FUNCT(do_waitusr_cmd, cp),     A_ONE | A_EXTERNAL },
 };
 int halcmd_ncommands = (sizeof(halcmd_commands) / sizeof(halcmd_commands[0]));
 
@@ -303,25 +304,32 @@ static int count_args(const char **argv) {
 #define ARG(i) (argc > i ? argv[i] : NULL)
 #define REST(i) (argc > i ? argv + i : argv + argc)
 
-static int parse_cmd1(const char **argv) {
+/* check_cmd1() looks up the command in argv[0] and checks the number
+   of arguments, after removing any arrows the command allows.  On
+   success '*commandp' is the command, or NULL for an empty line or a
+   "pin/param = newvalue" line.
+*/
+static int check_cmd1(const char **argv, struct halcmd_command **commandp,
+		      int *argcp) {
     struct halcmd_command *command = bsearch(argv[0],
                 halcmd_commands, halcmd_ncommands,
 		sizeof(struct halcmd_command), compare_command);
     int argc = count_args(argv);
 
+    *commandp = NULL;
+    *argcp = argc;
     if(argc == 0)
         return 0;
 
     if(!command) {
 	// special case: pin/param = newvalue
 	if(argc == 3 && !strcmp(argv[1], "=")) {
-	    return do_setp_cmd(argv[0], argv[2]);
+	    return 0;
 	} else {
             halcmd_error("Unknown command '%s'\n", argv[0]);
             return -EINVAL;
         }
     } else {
-	int result = -EINVAL;
 	int is_optional = command->type & A_OPTIONAL,
 	    is_plus = command->type & A_PLUS,
 	    nargs = command->type & 0xff,
@@ -340,6 +348,7 @@ static int parse_cmd1(const char **argv) {
 	    }
 	    argv[d] = NULL;
 	    argc = d;
+	    *argcp = argc;
 	}
 
         posargs = argc - 1;
@@ -354,7 +363,56 @@ static int parse_cmd1(const char **argv) {
 		command->name, is_optional ? "at most " : "", nargs, posargs);
 	    return -EINVAL;
         }
+	*commandp = command;
+	return 0;
+    }
+}
+
+/* In batch mode the HAL mutex is kept from one command to the next,
+   instead of being taken and given back by every HAL call the command
+   makes.  It is let go before commands that need another process to
+   get at the HAL (A_EXTERNAL), and by halcmd_batch_end().
+*/
+static int batch_mode = 0;
+static int batch_locked = 0;
+
+static void batch_lock(int lock) {
+    if(!batch_mode || lock == batch_locked) return;
+    if(lock) {
+	if(hal_batch_begin() != 0) return;
+    } else {
+	hal_batch_end();
+    }
+    batch_locked = lock;
+}
+
+void halcmd_batch_begin(void) {
+    batch_mode = 1;
+}
+
+void halcmd_batch_end(void) {
+    batch_lock(0);
+    batch_mode = 0;
+    hal_flag = 0;
+}
+
+static int parse_cmd1(const char **argv) {
+    struct halcmd_command *command;
+    int argc;
+    int result = check_cmd1(argv, &command, &argc);
 
+    if(result != 0 || argc == 0)
+        return result;
+
+    if(!command) {
+	batch_lock(1);
+	return do_setp_cmd(argv[0], argv[2]);
+    } else {
+	int is_plus = command->type & A_PLUS,
+	    nargs = command->type & 0xff;
+
+	result = -EINVAL;
+	batch_lock(!(command->type & A_EXTERNAL));
 #ifndef NO_INI
 	if(command->type & A_TILDE)
 	{
@@ -427,9 +485,8 @@ static int parse_cmd1(const char **argv) {
     }
 }
 
-int halcmd_parse_cmd(const char *tokens[])
+static void sort_commands(void)
 {
-    int retval;
     static int first_time = 1;
 
     if(first_time) {
@@ -438,13 +495,30 @@ int halcmd_parse_cmd(const char *tokens[])
                 sizeof(struct halcmd_command), sort_command);
         first_time = 0;
     }
+}
 
+int halcmd_parse_cmd(const char *tokens[])
+{
+    int retval;
+
+    sort_commands();
     hal_flag = 1;
     retval = parse_cmd1(tokens);
-    hal_flag = 0;
+    /* while batch mode holds the mutex the signal handler must not
+       exit directly */
+    hal_flag = batch_locked;
     return retval;
 }
 
+int halcmd_check_cmd(const char *tokens[])
+{
+    struct halcmd_command *command;
+    int argc;
+
+    sort_commands();
+    return check_cmd1(tokens, &command, &argc);
+}
+
 /* tokenize() sets an array of pointers to each non-whitespace
    token in the input line.  It expects that variable substitution
    and comment removal have already been done, and that any
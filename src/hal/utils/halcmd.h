@@ -48,6 +48,9 @@ extern int halcmd_startup(int quiet);
 extern void halcmd_shutdown();
 extern int halcmd_parse_cmd(const char * tokens[]);
 extern int halcmd_parse_line(char * line);
+extern int halcmd_check_cmd(const char * tokens[]);
+extern void halcmd_batch_begin(void);
+extern void halcmd_batch_end(void);
 extern void halcmd_shutdown(void);
 extern int prompt_mode, echo_mode, errorcount, halcmd_done;
 extern int halcmd_preprocess_line (char *line, const char **tokens);
@@ -74,6 +77,7 @@ enum halcmd_argtype {
     A_REMOVE_ARROWS = 0x200, /* removes any arrows from command */
     A_OPTIONAL = 0x400,      /* arguments may be NULL */
     A_TILDE = 0x800,         /* tilde-expand all arguments */
+    A_EXTERNAL = 0x1000,     /* needs another process to access the HAL */
 };
 
 
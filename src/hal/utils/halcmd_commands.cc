@@ -71,6 +71,7 @@ static void print_script_sig_info(int type, const char **patterns);
 static void print_param_info(int type, const char **patterns);
 static void print_funct_info(const char **patterns);
 static void print_thread_info(const char **patterns);
+static void print_histogram_info(const char **patterns);
 static void print_comp_names(const char **patterns);
 static void print_pin_names(const char **patterns);
 static void print_sig_names(const char **patterns);
@@ -272,13 +273,25 @@ int do_unecho_cmd(void) {
     return 0;
 }
 int do_addf_cmd(const char *func, const char *thread, const char **opt) {
-    const char *position_str = opt ? opt[0] : NULL;
+    const char *group = NULL;
     int position = -1;
     int retval;
 
+    /* usage: addf [--group=name] <funct> <thread> [position] */
+    if(strncmp(func, "--group=", 8) == 0) {
+        group = func + 8;
+        func = thread;
+        thread = opt ? opt[0] : NULL;
+        if(!thread || !*thread) {
+            halcmd_error("addf: missing thread name\n");
+            return -EINVAL;
+        }
+        opt++;
+    }
+    const char *position_str = opt ? opt[0] : NULL;
     if(position_str && *position_str) position = atoi(position_str);
 
-    retval = hal_add_funct_to_thread(func, thread, position);
+    retval = hal_add_funct_to_group(func, thread, position, group);
     if(retval == 0) {
         halcmd_info("Function '%s' added to thread '%s'\n",
                     func, thread);
@@ -847,6 +860,8 @@ int do_show_cmd(const char *type, const char **patterns)
 	print_funct_info(patterns);
     } else if (strcmp(type, "thread") == 0) {
 	print_thread_info(patterns);
+    } else if (strcmp(type, "funct-histogram") == 0) {
+	print_histogram_info(patterns);
     } else if (strcmp(type, "alias") == 0) {
 	print_pin_aliases(patterns);
 	print_param_aliases(patterns);
@@ -892,6 +907,56 @@ int do_list_cmd(const char *type, const char **patterns)
     return 0;
 }
 
+struct histogram_arg {
+    const char **patterns;
+    hal_hist_cmd_t cmd;
+    int matched;
+    int retval;
+};
+
+static int histogram_cb(hal_query_t *q, void *arg)
+{
+    struct histogram_arg *ha = (struct histogram_arg *)arg;
+    if(!match(ha->patterns, q->name))
+        return 0;
+    ha->matched++;
+    int retval = hal_histogram(q->name, ha->cmd);
+    if(retval) {
+        halcmd_error("Histogram of '%s' failed: %s\n", q->name, strerror(-retval));
+        ha->retval = retval;
+    }
+    return 0;
+}
+
+int do_histogram_cmd(const char *command, const char **patterns)
+{
+    struct histogram_arg ha = {};
+    if (strcmp(command, "on") == 0) {
+	ha.cmd = HAL_HIST_ON;
+    } else if (strcmp(command, "off") == 0) {
+	ha.cmd = HAL_HIST_OFF;
+    } else if (strcmp(command, "reset") == 0) {
+	ha.cmd = HAL_HIST_RESET;
+    } else {
+	halcmd_error("Unknown 'histogram' command '%s'\n", command);
+	return -1;
+    }
+    ha.patterns = patterns;
+    hal_query_t q = {};
+    hal_list_funct(&q, histogram_cb, &ha);
+    q = {};
+    q.qtype = HAL_QTYPE_THREAD;
+    hal_list_thread(&q, histogram_cb, &ha);
+    if (ha.retval) {
+	return ha.retval;
+    }
+    if (!ha.matched) {
+	halcmd_error("No function or thread matches\n");
+	return -EINVAL;
+    }
+    return 0;
+}
+
 int do_status_cmd(const char *type)
 {
 
@@ -1770,12 +1835,25 @@ static int print_thread_info_cb(hal_query_t *q, void *arg)
         } else {
             rtapi_print_msg(RTAPI_MSG_ERR, "unexpected: cannot find time/tmax pin for %s thread\n", q->name);
         }
+        if(!scriptmode && q->thread.cpu >= 0) {
+            halcmd_output("                    (bound to CPU %d)\n", q->thread.cpu);
+        }
+        if(!scriptmode && q->thread.workers > 0) {
+            halcmd_output("                    (workers on CPU");
+            for(int i = 0; i < q->thread.workers; i++)
+                halcmd_output(" %d", q->thread.worker_cpu[i]);
+            halcmd_output(")\n");
+        }
     }
 
     // Any attached function has a different connection ID
     if(HAL_QTYPE_THREAD_FUNCT == q->qtype) {
         if(!scriptmode) {
-            halcmd_output("                 %2d %s\n", q->thread.functidx + 1, q->thread.funct);
+            if(q->thread.group) {
+                halcmd_output("                 %2d %s [%s]\n", q->thread.functidx + 1, q->thread.funct, q->thread.group);
+            } else {
+                halcmd_output("                 %2d %s\n", q->thread.functidx + 1, q->thread.funct);
+            }
         } else {
             // scriptmode only uses one line per thread, which contains: 
             // thread period, FP flag, name, then all functs separated by spaces
@@ -1801,6 +1879,63 @@ static void print_thread_info(const char **patterns)
     halcmd_output("\n");
 }
 
+static void print_histogram(const char *name, const rtapi_u64 *hist, bool on)
+{
+    rtapi_u64 total = 0;
+    for(int i = 0; i < HAL_HIST_BINS; i++)
+        total += hist[i];
+    if(!scriptmode) {
+        halcmd_output("%s (%s, %llu samples)\n", name, on ? "on" : "off", (unsigned long long)total);
+    }
+    for(int i = 0; i < HAL_HIST_BINS; i++) {
+        if(!hist[i])
+            continue;
+        unsigned long long from = hal_histogram_bin_start(i);
+        if(!scriptmode) {
+            if(i + 1 < HAL_HIST_BINS) {
+                halcmd_output("  %12llu  %12llu  %12llu  %6.2f%%\n", from,
+                    (unsigned long long)hal_histogram_bin_start(i + 1),
+                    (unsigned long long)hist[i], 100.0 * hist[i] / total);
+            } else {
+                halcmd_output("  %12llu  %12s  %12llu  %6.2f%%\n", from, "-",
+                    (unsigned long long)hist[i], 100.0 * hist[i] / total);
+            }
+        } else {
+            halcmd_output("%s %llu %llu\n", name, from, (unsigned long long)hist[i]);
+        }
+    }
+}
+
+static int print_funct_histogram_cb(hal_query_t *q, void *arg)
+{
+    const char **patterns = (const char **)arg;
+    if(q->funct.hist && match(patterns, q->name))
+        print_histogram(q->name, q->funct.hist, q->funct.hist_on);
+    return 0;
+}
+
+static int print_thread_histogram_cb(hal_query_t *q, void *arg)
+{
+    const char **patterns = (const char **)arg;
+    if(q->thread.hist && match(patterns, q->name))
+        print_histogram(q->name, q->thread.hist, q->thread.hist_on);
+    return 0;
+}
+
+static void print_histogram_info(const char **patterns)
+{
+    if(!scriptmode) {
+        halcmd_output("Execution Time Histograms:\n");
+        halcmd_output("  %12s  %12s  %12s  %7s\n", "From (ns)", "To (ns)", "Count", "Share");
+    }
+    hal_query_t q = {};
+    hal_list_funct(&q, print_funct_histogram_cb, (void *)patterns);
+    q = {};
+    q.qtype = HAL_QTYPE_THREAD;
+    hal_list_thread(&q, print_thread_histogram_cb, (void *)patterns);
+    halcmd_output("\n");
+}
+
 static int print_any_names_cb(hal_query_t *q, void *arg)
 {
     const char **patterns = (const char **)arg;
@@ -2362,7 +2497,11 @@ static int save_threads_cb(hal_query_t *q, void *arg)
 {
     if(HAL_QTYPE_THREAD_FUNCT == q->qtype) {
         const char *f = q->thread.is_init ? "initf" : "addf";
-        fprintf((FILE *)arg, "%s %s %s\n", f, q->thread.funct, q->name);
+        if(q->thread.group) {
+            fprintf((FILE *)arg, "%s --group=%s %s %s\n", f, q->thread.group, q->thread.funct, q->name);
+        } else {
+            fprintf((FILE *)arg, "%s %s %s\n", f, q->thread.funct, q->name);
+        }
     }
     return 0;
 }
@@ -2526,6 +2665,11 @@ int do_help_cmd(const char *command)
 	printf("  'position' means position with respect to the end of the\n");
 	printf("  thread.  For example '1' is start of thread, '-1' is the\n");
 	printf("  end of the thread, '-3' is third from the end.\n");
+	printf("addf --group=name functname threadname [position]\n");
+	printf("  Adds the function to the parallel group 'name' of the\n");
+	printf("  thread.  Functions of a group that are next to each other\n");
+	printf("  in the thread run at the same time on the workers of the\n");
+	printf("  thread.\n");
     } else if (strcmp(command, "delf") == 0) {
 	printf("delf functname threadname\n");
 	printf("  Removes function 'functname' from thread 'threadname'.\n");
@@ -2533,10 +2677,18 @@ int do_help_cmd(const char *command)
 	printf("show [type] [pattern]\n");
 	printf("  Prints info about HAL items of the specified type.\n");
 	printf("  'type' is 'comp', 'pin', 'sig', 'param', 'funct',\n");
-	printf("  'thread', or 'all'.  If 'type' is omitted, it assumes\n");
-	printf("  'all' with no pattern.  If 'pattern' is specified\n");
+	printf("  'thread', 'funct-histogram', or 'all'.  If 'type' is\n");
+	printf("  omitted, it assumes 'all' with no pattern.  If\n");
+	printf("  'pattern' is specified\n");
 	printf("  it prints only those items whose names match the\n");
 	printf("  pattern, which may be a 'shell glob'.\n");
+    } else if (strcmp(command, "histogram") == 0) {
+	printf("histogram on|off|reset [pattern]\n");
+	printf("  Switches the execution time histograms of the functions\n");
+	printf("  and threads whose names match 'pattern' on or off, or\n");
+	printf("  clears their counts.  Without 'pattern' it applies to\n");
+	printf("  all functions and threads.  Use 'show funct-histogram'\n");
+	printf("  to print the histograms.\n");
     } else if (strcmp(command, "list") == 0) {
 	printf("list type [pattern]\n");
 	printf("  Prints the names of HAL items of the specified type.\n");
@@ -2647,6 +2799,7 @@ static void print_help_commands(void)
     printf("  setp, sets          Set the value of a pin, parameter or signal\n");
     printf("  addf, delf          Add/remove function to/from a thread\n");
     printf("  show                Display info about HAL objects\n");
+    printf("  histogram           Switch function/thread execution time histograms\n");
     printf("  list                Display names of HAL objects\n");
     printf("  source              Execute commands from another .hal file\n");
     printf("  status              Display status information\n");
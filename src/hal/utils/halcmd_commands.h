@@ -73,6 +73,7 @@ extern int do_ptype_cmd(const char *name);
 extern int do_stype_cmd(const char *name);
 extern int do_show_cmd(const char *type, const char **patterns);
 extern int do_list_cmd(const char *type, const char **patterns);
+extern int do_histogram_cmd(const char *command, const char **patterns);
 extern int do_source_cmd(const char *type);
 extern int do_status_cmd(const char *type);
 extern int do_set_debug_cmd(const char *level);
@@ -53,6 +53,7 @@ static const char *command_table[] = {
     "net", "newsig", "delsig", "getp", "gets", "setp", "sets", "ptype", "stype",
     "addf", "delf", "show", "list", "status", "save", "source",
     "start", "stop", "quit", "exit", "help", "alias", "unalias", 
+    "histogram",
     NULL,
 };
 
@@ -68,6 +69,12 @@ static const char *alias_table[] = {
 
 static const char *show_table[] = {
     "all", "alias", "comp", "pin", "sig", "param", "funct", "thread",
+    "funct-histogram",
+    NULL,
+};
+
+static const char *histogram_table[] = {
+    "on", "off", "reset",
     NULL,
 };
 
@@ -795,6 +802,12 @@ char **halcmd_completer(const char *text, int start, int end, hal_completer_func
                 result = func(text, thread_generator);
             }
         }
+    } else if(startswith(buffer, "histogram ")) {
+        if (argno == 1) {
+            result = completion_matches_table(text, histogram_table, func);
+        } else {
+            result = func(text, funct_generator);
+        }
     } else if(startswith(buffer, "save ") && argno == 1) {
         result = completion_matches_table(text, save_table, func);
     } else if(startswith(buffer, "status ") && argno == 1) {
@@ -74,6 +74,8 @@ static char *seprintf(char *buf, char *ebuf, const char *fmt, ...) {
 }
 
 static int get_input(FILE *srcfile, char *buf, size_t bufsize);
+static int get_line(FILE *srcfile, char *eline, char *elineend, int *linenumber);
+static int run_batch(FILE *srcfile, int keep_going);
 static void print_help_general(int showR);
 static int release_HAL_mutex(void);
 static int propose_completion(char *all, char *fragment, int start);
@@ -84,6 +86,7 @@ static char *prompt_interactive = "halcmd: ";
 static char *prompt_continue    = "halcmd+: ";
 
 #define MAX_EXTEND_LINES 20
+#define ELINE_LEN ((LINELEN + 2) * (MAX_EXTEND_LINES + 1))
 
 /***********************************************************************
 *                   LOCAL FUNCTION DEFINITIONS                         *
@@ -94,10 +97,10 @@ int main(int argc, char **argv)
     int c, fd;
     int keep_going, retval, errorcount;
     int filemode = 0;
+    int batchmode = 0;
     char *filename = NULL;
     FILE *srcfile = NULL;
-    char raw_buf[MAX_CMD_LEN+1];
-    int linenumber = 1;
+    int linenumber = 0;
     char *cf=NULL, *cw=NULL, *cl=NULL;
 
     if (argc < 2) {
@@ -111,7 +114,7 @@ int main(int argc, char **argv)
     keep_going = 0;
     /* start parsing the command line, options first */
     while(1) {
-        c = getopt(argc, argv, "+RCfi:kqQsvVhe");
+        c = getopt(argc, argv, "+BRCfi:kqQsvVhe");
         if(c == -1) break;
         switch(c) {
             case 'R':
@@ -161,6 +164,10 @@ int main(int argc, char **argv)
 	    case 'f':
                 filemode = 1;
 		break;
+	    case 'B':
+		/* -B = check the whole file, then run it as one batch */
+		batchmode = 1;
+		break;
 	    case 'C':
                 cl = getenv("COMP_LINE");
                 cw = getenv("COMP_POINT");
@@ -210,6 +217,10 @@ int main(int argc, char **argv)
 		break;
         }
     }
+    if(batchmode && !filemode) {
+        fprintf(stderr, "-B may only be used together with -f\n");
+        exit(-1);
+    }
     if(filemode) {
         /* it's the first -f (ignore repeats) */
         if (argc > optind) {
@@ -260,34 +271,13 @@ int main(int argc, char **argv)
                 errorcount++;
             }
         }
+    } else if (batchmode) {
+        errorcount = run_batch(srcfile, keep_going);
     } else {
-        int   extend_ct = 0; // extend lines with backslash (\)
-        char  eline [(LINELEN + 2) * (MAX_EXTEND_LINES + 1)] = {0,};
-        char *elineptr=eline, *elineend=eline + sizeof(eline);
+        char eline[ELINE_LEN];
 	/* read command line(s) from 'srcfile' */
-	while (get_input(srcfile, raw_buf, MAX_CMD_LEN)) {
+	while (get_line(srcfile, eline, eline + sizeof(eline), &linenumber)) {
 	    const char *tokens[MAX_TOK+1];
-            int   newLinePos;
-
-	    halcmd_set_linenumber(linenumber++);
-
-            newLinePos = (int)strlen(raw_buf) - 1; // interactive
-            if (raw_buf[newLinePos] == '\n') { raw_buf[newLinePos]=0; newLinePos--; }  // tty
-
-            if (newLinePos >= 0 && raw_buf[newLinePos] == '\\') { // backslash
-                raw_buf[newLinePos] = 0;
-                newLinePos++;
-                if (!extend_ct) { //first extend
-                    if (prompt == prompt_interactive) prompt = prompt_continue;
-                }
-                elineptr = seprintf(elineptr, elineend, "%s", raw_buf);
-                extend_ct++;
-                continue; // get next line to extend
-            } else { // no backslash
-                elineptr = seprintf(elineptr, elineend, "%s", raw_buf);
-            }
-            extend_ct = 0;
-            if (prompt == prompt_continue) { prompt = prompt_interactive; }
 
 	    /* remove comments, do var substitution, and tokenise */
 	    retval = halcmd_preprocess_line(eline, tokens);
@@ -318,10 +308,7 @@ int main(int argc, char **argv)
 		/* exit from loop */
 		break;
 	    }
-            elineptr=eline;
-            *eline = 0;
-	} //while get_input()
-        extend_ct=0;
+	} //while get_line()
     }
     /* all done */
     halcmd_shutdown();
@@ -333,6 +320,120 @@ int main(int argc, char **argv)
 
 }
 
+/* get_line() reads one command from 'srcfile' into 'eline', joining
+   lines that end with a backslash.  'linenumber' is advanced for each
+   line read.  Returns zero at the end of the input.
+*/
+static int get_line(FILE *srcfile, char *eline, char *elineend, int *linenumber)
+{
+    char raw_buf[MAX_CMD_LEN+1];
+    char *elineptr = eline;
+    int newLinePos;
+
+    *eline = 0;
+    while (get_input(srcfile, raw_buf, MAX_CMD_LEN)) {
+        halcmd_set_linenumber(++*linenumber);
+
+        newLinePos = (int)strlen(raw_buf) - 1; // interactive
+        if (raw_buf[newLinePos] == '\n') { raw_buf[newLinePos]=0; newLinePos--; }  // tty
+
+        if (newLinePos >= 0 && raw_buf[newLinePos] == '\\') { // backslash
+            raw_buf[newLinePos] = 0;
+            if (prompt == prompt_interactive) prompt = prompt_continue;
+            elineptr = seprintf(elineptr, elineend, "%s", raw_buf);
+            continue; // get next line to extend
+        }
+        elineptr = seprintf(elineptr, elineend, "%s", raw_buf);
+        if (prompt == prompt_continue) { prompt = prompt_interactive; }
+        return 1;
+    }
+    return 0;
+}
+
+/* run_batch() reads all of 'srcfile' and checks every command before
+   any of them is executed, so that a file with a typo, unknown command
+   or wrong number of arguments anywhere changes nothing in the HAL.
+   The commands are then run with the HAL mutex held from one command
+   to the next, see halcmd_batch_begin().  Errors that can only be
+   found by running a command (a pin that does not exist, incompatible
+   types, ...) still stop the batch at that command, unless -k is given.
+*/
+static int run_batch(FILE *srcfile, int keep_going)
+{
+    char eline[ELINE_LEN];
+    const char *tokens[MAX_TOK+1];
+    char **lines = NULL;
+    int *linenumbers = NULL;
+    int nlines = 0, maxlines = 0;
+    int linenumber = 0;
+    int n, retval, errorcount = 0;
+
+    /* first pass: read and check everything, nothing is executed yet */
+    while (get_line(srcfile, eline, eline + sizeof(eline), &linenumber)) {
+        if (nlines == maxlines) {
+            maxlines = maxlines ? 2 * maxlines : 256;
+            lines = realloc(lines, maxlines * sizeof(*lines));
+            linenumbers = realloc(linenumbers, maxlines * sizeof(*linenumbers));
+            if (!lines || !linenumbers) {
+                halcmd_error("out of memory\n");
+                exit(-1);
+            }
+        }
+        lines[nlines] = strdup(eline);
+        linenumbers[nlines] = linenumber;
+        retval = halcmd_preprocess_line(eline, tokens);
+        if (retval == 0) {
+            if ( ( strcasecmp(tokens[0],"quit") == 0 ) ||
+                 ( strcasecmp(tokens[0],"exit") == 0 ) ) {
+                free(lines[nlines]);
+                break;
+            }
+            retval = halcmd_check_cmd(tokens);
+        }
+        nlines++;
+        if ( retval != 0 ) {
+            errorcount++;
+        }
+    }
+    if ( errorcount > 0 ) {
+        fprintf(stderr, "%s: %d error(s), no commands were executed\n",
+            halcmd_get_filename(), errorcount);
+        goto out;
+    }
+
+    /* second pass: execute */
+    halcmd_batch_begin();
+    for (n = 0; n < nlines; n++) {
+        halcmd_set_linenumber(linenumbers[n]);
+        retval = halcmd_preprocess_line(lines[n], tokens);
+        if(echo_mode) {
+            halcmd_echo("%s\n", lines[n]);
+        }
+        if (retval == 0) {
+            retval = halcmd_parse_cmd(tokens);
+        }
+        if ( halcmd_done ) {
+            errorcount++;
+            break;
+        }
+        if ( retval != 0 ) {
+            errorcount++;
+        }
+        if (( errorcount > 0 ) && ( keep_going == 0 )) {
+            break;
+        }
+    }
+    halcmd_batch_end();
+
+out:
+    for (n = 0; n < nlines; n++) {
+        free(lines[n]);
+    }
+    free(lines);
+    free(linenumbers);
+    return errorcount;
+}
+
 /* release_HAL_mutex() unconditionally releases the hal_mutex
    very useful after a program segfaults while holding the mutex
 */
@@ -368,6 +469,8 @@ static void print_help_general(int showR)
     printf("\nUsage:   halcmd [options] [cmd [args]]\n\n");
     printf("\n         halcmd [options] -f [filename]\n\n");
     printf("options:\n\n");
+    printf("  -B             Batch - check all commands in the file given\n");
+    printf("                 with -f before running any of them. (Faster)\n");
     printf("  -e             echo the commands from stdin to stderr\n");
     printf("  -f [filename]  Read commands from 'filename', not command\n");
     printf("                 line.  If no filename, read from stdin.\n");
@@ -212,8 +212,20 @@ struct REMOTE_LOGIN_REPLY:public REMOTE_CMS_REPLY {
 enum CMS_REMOTE_SUBSCRIPTION_REQUEST_TYPE {
     CMS_POLLED_SUBSCRIPTION = 1,
     CMS_NO_SUBSCRIPTION,
-    CMS_VARIABLE_SUBSCRIPTION
-};
+    CMS_VARIABLE_SUBSCRIPTION,
+    CMS_DELTA_SUBSCRIPTION
+};
+
+/* A delta subscriber is sent each new message as soon as the server sees
+   it, as a variable subscriber is, but only the parts of it that changed
+   since the message sent before.  The data following each reply header is,
+   in big-endian 32 bit words, the write id of the message the changes
+   apply to, or 0 if what follows is the whole message, the size of the
+   new message, and then runs of an offset, a length and that many bytes
+   of the new message.  A subscriber that cannot apply the changes
+   reconnects, and so is sent the whole message again. */
+#define CMS_DELTA_HEADER_SIZE 8
+#define CMS_DELTA_RUN_HEADER_SIZE 8
 
 struct REMOTE_SET_SUBSCRIPTION_REQUEST:public REMOTE_CMS_REQUEST {
     REMOTE_SET_SUBSCRIPTION_REQUEST()
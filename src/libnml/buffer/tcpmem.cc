@@ -34,6 +34,7 @@
 #include "recvn.h"		/* recvn() */
 #include "sendn.h"		/* sendn() */
 #include "libnml/cms/tcp_opts.hh"		/* SET_TCP_NODELAY */
+#include "libnml/cms/cms_delta.hh"		/* cms_apply_delta() */
 #include "libnml/linklist/linklist.hh"          /* LinkedList */
 
 int tcpmem_sigpipe_count = 0;
@@ -72,7 +73,8 @@ TCPMEM::TCPMEM(const char *_bufline, const char *_procline)
     reconnect_needed(0),
     sigpipe_count(0),
     old_handler((void (*)(int))SIG_ERR),
-    subscription_count(0)
+    subscription_count(0),
+    delta_image_id(0)
 {
     char *max_consecutive_timeouts_string;
     max_consecutive_timeouts_string = strstr(ProcessLine, "max_timeouts=");
@@ -94,6 +96,11 @@ TCPMEM::TCPMEM(const char *_bufline, const char *_procline)
 	    subscription_type = CMS_NO_SUBSCRIPTION;
 	} else if (!strncmp(sub_info_string + 4, "var", 3)) {
 	    subscription_type = CMS_VARIABLE_SUBSCRIPTION;
+	} else if (!strncmp(sub_info_string + 4, "delta", 5)) {
+	    subscription_type = CMS_DELTA_SUBSCRIPTION;
+	    delta_data.resize(max_encoded_message_size +
+		CMS_DELTA_HEADER_SIZE + CMS_DELTA_RUN_HEADER_SIZE);
+	    delta_image.resize(max_encoded_message_size);
 	} else {
 	    poll_interval_millis =
 		((int) (atof(sub_info_string + 4) * 1000.0));
@@ -434,6 +441,7 @@ void TCPMEM::reconnect()
     waiting_message_size = 0;
     waiting_message_id = 0;
     serial_number = 0;
+    delta_image_id = 0;
 
     rcs_print_debug(PRINT_CMS_CONFIG_INFO, "Creating socket . . .\n");
 
@@ -668,6 +676,13 @@ void TCPMEM::disconnect()
 CMS_STATUS TCPMEM::handle_old_replies()
 {
     long message_size;
+    long max_message_size = max_encoded_message_size;
+    void *message_data = encoded_data;
+
+    if (subscription_type == CMS_DELTA_SUBSCRIPTION) {
+	max_message_size = delta_data.size();
+	message_data = delta_data.data();
+    }
 
     timedout_request_writeid = 0;
     status = CMS_STATUS_NOT_SET;
@@ -720,9 +735,9 @@ CMS_STATUS TCPMEM::handle_old_replies()
 		(CMS_STATUS) ntohl(*(reinterpret_cast<uint32_t *>(temp_buffer) + 1));
 	    timedout_request_writeid = ntohl(*(reinterpret_cast<uint32_t *>(temp_buffer) + 3));
 	    header.was_read = ntohl(*(reinterpret_cast<uint32_t *>(temp_buffer) + 4));
-	    if (message_size > max_encoded_message_size) {
+	    if (message_size > max_message_size) {
 		rcs_print_error("Received message is too big. (%ld > %ld)\n",
-		    message_size, max_encoded_message_size);
+		    message_size, max_message_size);
 		fatal_error_occurred = 1;
 		reconnect_needed = 1;
 		return (status = CMS_INSUFFICIENT_SPACE_ERROR);
@@ -732,7 +747,7 @@ CMS_STATUS TCPMEM::handle_old_replies()
 	}
 	if (message_size > 0) {
 	    if (recvn
-		(socket_fd, encoded_data, message_size, 0, timeout,
+		(socket_fd, message_data, message_size, 0, timeout,
 		    &recvd_bytes) < 0) {
 		if (recvn_timedout) {
 		    if (!waiting_for_message) {
@@ -766,6 +781,18 @@ CMS_STATUS TCPMEM::handle_old_replies()
 	    if (waiting_for_message) {
 		timedout_request_writeid = waiting_message_id;
 	    }
+	    if (subscription_type == CMS_DELTA_SUBSCRIPTION) {
+		if (apply_delta(message_size) == 0) {
+		    delta_image_id = timedout_request_writeid;
+		} else {
+		    /* reconnecting brings the whole message again */
+		    rcs_print_error
+			("TCPMEM: changes received for %s do not apply to the message it has.\n",
+			BufferName);
+		    reconnect_needed = 1;
+		    timedout_request_writeid = in_buffer_id;
+		}
+	    }
 	}
 	break;
 
@@ -889,6 +916,22 @@ CMS_STATUS TCPMEM::handle_old_replies()
     return status;
 }
 
+/* Applies the message_size bytes of changes in delta_data to the whole
+   message they were taken against, and leaves the result in encoded_data.
+   Returns -1 if they were not taken against the message this subscriber
+   has. */
+int TCPMEM::apply_delta(long message_size)
+{
+    long size = cms_apply_delta(delta_image, delta_image_id,
+	delta_data.data(), message_size);
+
+    if (size < 0) {
+	return -1;
+    }
+    memcpy(encoded_data, delta_image.data(), size);
+    return 0;
+}
+
 CMS_STATUS TCPMEM::read()
 {
     long message_size, id;
@@ -17,6 +17,7 @@
 
 #include "libnml/cms/cms.hh"		/* class CMS */
 #include "rem_msg.hh"		// REMOTE_CMS_REQUEST_TYPE
+#include <vector>
 
 class TCPMEM:public CMS {
   public:
@@ -41,6 +42,7 @@ class TCPMEM:public CMS {
 
   protected:
       CMS_STATUS handle_old_replies();
+    int apply_delta(long message_size);
     void send_diag_info();
     char diag_info_buf[0x400];
     int recvd_bytes;
@@ -74,6 +76,10 @@ class TCPMEM:public CMS {
     void reenable_sigpipe();
     void verify_bufname();
     int subscription_count;
+    std::vector<char> delta_data;	/* changes received by a delta
+					   subscriber */
+    std::vector<char> delta_image;	/* the whole message they apply to */
+    unsigned long delta_image_id;
 };
 
 #endif
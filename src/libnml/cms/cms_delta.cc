@@ -0,0 +1,112 @@
+/********************************************************************
+* Description: cms_delta.cc
+*   Taking and applying the changes between two encoded messages, for
+*   delta subscriptions.
+*
+* Author:
+* License: LGPL Version 2
+* System: Linux
+*
+* Copyright (c) 2004 All rights reserved.
+*
+* Last change:
+********************************************************************/
+
+#include <string.h>		/* memcmp(), memcpy() */
+#include <stdint.h>		/* uint32_t */
+#include <arpa/inet.h>		/* htonl(), ntohl() */
+
+#include "cms_delta.hh"
+#include "libnml/buffer/rem_msg.hh"	/* CMS_DELTA_HEADER_SIZE */
+
+static void putbe32(char *addr, uint32_t val) {
+    val = htonl(val);
+    memcpy(addr, &val, sizeof(val));
+}
+
+static uint32_t getbe32(const char *addr) {
+    uint32_t val;
+    memcpy(&val, addr, sizeof(val));
+    return ntohl(val);
+}
+
+/* True if the 32 bit word at offset i of data differs from old, or if old
+   is too short to have it. */
+static bool word_changed(const std::vector<char> &old, const char *data,
+    long size, long i)
+{
+    long n = size - i < 4 ? size - i : 4;
+    return i + n > (long) old.size() || memcmp(old.data() + i, data + i, n);
+}
+
+/* Encoders such as XDR put every field on a 32 bit boundary, so comparing
+   words finds the fields that changed.  Unchanged stretches too short to
+   be worth a run header of their own are sent with the runs around
+   them. */
+int cms_make_delta(const std::vector<char> &old, unsigned long base_id,
+    const char *data, long size, std::vector<char> &delta)
+{
+    const long max_gap = CMS_DELTA_RUN_HEADER_SIZE;
+    const long whole = CMS_DELTA_HEADER_SIZE + CMS_DELTA_RUN_HEADER_SIZE + size;
+    long i = 0;
+
+    delta.resize(CMS_DELTA_HEADER_SIZE);
+    putbe32(delta.data(), base_id);
+    putbe32(delta.data() + 4, size);
+    while (i < size) {
+	if (!word_changed(old, data, size, i)) {
+	    i += 4;
+	    continue;
+	}
+	long start = i;
+	long end = i;
+	for (; i < size && i - end < max_gap; i += 4) {
+	    if (word_changed(old, data, size, i)) {
+		end = i + 4 < size ? i + 4 : size;
+	    }
+	}
+	long at = delta.size();
+	delta.resize(at + CMS_DELTA_RUN_HEADER_SIZE + (end - start));
+	putbe32(delta.data() + at, start);
+	putbe32(delta.data() + at + 4, end - start);
+	memcpy(delta.data() + at + CMS_DELTA_RUN_HEADER_SIZE, data + start,
+	    end - start);
+	if ((long) delta.size() >= whole) {
+	    return -1;
+	}
+	i = end;
+    }
+    return 0;
+}
+
+long cms_apply_delta(std::vector<char> &image, unsigned long image_id,
+    const char *delta, long delta_size)
+{
+    const char *p = delta;
+    const char *end = delta + delta_size;
+
+    if (delta_size < CMS_DELTA_HEADER_SIZE) {
+	return -1;
+    }
+    unsigned long base_id = getbe32(p);
+    long size = getbe32(p + 4);
+    if ((base_id != 0 && base_id != image_id)
+	|| size > (long) image.size()) {
+	return -1;
+    }
+    p += CMS_DELTA_HEADER_SIZE;
+    while (p < end) {
+	if (end - p < CMS_DELTA_RUN_HEADER_SIZE) {
+	    return -1;
+	}
+	long offset = getbe32(p);
+	long length = getbe32(p + 4);
+	p += CMS_DELTA_RUN_HEADER_SIZE;
+	if (offset + length > size || length > end - p) {
+	    return -1;
+	}
+	memcpy(image.data() + offset, p, length);
+	p += length;
+    }
+    return size;
+}
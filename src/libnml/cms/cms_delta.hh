@@ -0,0 +1,31 @@
+/********************************************************************
+* Description: cms_delta.hh
+*   Taking and applying the changes between two encoded messages, for
+*   delta subscriptions (see CMS_DELTA_SUBSCRIPTION in rem_msg.hh).
+*
+* Author:
+* License: LGPL Version 2
+* System: Linux
+*
+* Copyright (c) 2004 All rights reserved.
+*
+* Last change:
+********************************************************************/
+#ifndef CMS_DELTA_HH
+#define CMS_DELTA_HH
+
+#include <vector>
+
+/* Fills delta with the changes that turn old, the message with write id
+   base_id, into the size bytes at data.  Returns -1, leaving delta in no
+   particular state, if they would come to more than the whole message. */
+int cms_make_delta(const std::vector<char> &old, unsigned long base_id,
+    const char *data, long size, std::vector<char> &delta);
+
+/* Applies the delta_size bytes of changes at delta to image, the message
+   with write id image_id.  Returns the size of the new message, or -1 if
+   the changes were not taken against image or do not fit in it. */
+long cms_apply_delta(std::vector<char> &image, unsigned long image_id,
+    const char *delta, long delta_size);
+
+#endif /* CMS_DELTA_HH */
@@ -42,6 +42,7 @@
 #include "libnml/rcs/rcs_print.hh"		/* rcs_print_error() */
 #include "libnml/linklist/linklist.hh"		/* class LinkedList */
 #include "tcp_opts.hh"		/* SET_TCP_NODELAY */
+#include "cms_delta.hh"		/* cms_make_delta() */
 #include "libnml/os_intf/timer.hh"		// esleep()
 #include "libnml/os_intf/_timer.h"
 #include "cmsdiag.hh"		// class CMS_DIAGNOSTICS_INFO
@@ -1459,7 +1460,9 @@ void CMS_SERVER_REMOTE_TCP_PORT::switch_function(CLIENT_TCP_PORT *
 		if (server->set_subscription_req.subscription_type ==
 		    CMS_POLLED_SUBSCRIPTION
 		    || server->set_subscription_req.subscription_type ==
-		    CMS_VARIABLE_SUBSCRIPTION) {
+		    CMS_VARIABLE_SUBSCRIPTION
+		    || server->set_subscription_req.subscription_type ==
+		    CMS_DELTA_SUBSCRIPTION) {
 		    add_subscription_client(buffer_number,
 			server->set_subscription_req.
 			subscription_type,
@@ -1541,6 +1544,8 @@ void CMS_SERVER_REMOTE_TCP_PORT::add_subscription_client(int buffer_number,
 	buf_info->sub_clnt_info->store_at_tail(temp_clnt_info,
 	    sizeof(*temp_clnt_info), 0);
     }
+    /* (re)subscribing starts again from the whole message */
+    temp_clnt_info->last_id_read = 0;
     temp_clnt_info->subscription_type = subscription_type;
     temp_clnt_info->poll_interval_millis = poll_interval_millis;
     recalculate_polling_interval();
@@ -1589,7 +1594,14 @@ void CMS_SERVER_REMOTE_TCP_PORT::recalculate_polling_interval()
 	    (TCP_CLIENT_SUBSCRIPTION_INFO *) buf_info->sub_clnt_info->
 	    get_head();
 	while (temp_clnt_info != NULL) {
-	    if (temp_clnt_info->poll_interval_millis <
+	    if (temp_clnt_info->subscription_type == CMS_VARIABLE_SUBSCRIPTION
+		|| temp_clnt_info->subscription_type ==
+		CMS_DELTA_SUBSCRIPTION) {
+		/* sent each new message, so look for one every tick; when
+		   there is none that costs only a look at the header */
+		min_poll_interval_millis = 0;
+		polling_enabled = 1;
+	    } else if (temp_clnt_info->poll_interval_millis <
 		min_poll_interval_millis
 		&& temp_clnt_info->subscription_type ==
 		CMS_POLLED_SUBSCRIPTION) {
@@ -1661,6 +1673,7 @@ void CMS_SERVER_REMOTE_TCP_PORT::update_subscriptions()
 	    (TCP_CLIENT_SUBSCRIPTION_INFO *) buf_info->sub_clnt_info->
 	    get_head();
 	buf_info->min_last_id = server->read_reply->write_id;
+	int delta_subscribers = 0;
 	while (temp_clnt_info != NULL) {
 	    double time_diff = cur_time - temp_clnt_info->last_sub_sent_time;
 	    int time_diff_millis = (int) ((double) time_diff * 1000.0);
@@ -1670,37 +1683,30 @@ void CMS_SERVER_REMOTE_TCP_PORT::update_subscriptions()
 			&& time_diff_millis + 10 >=
 			temp_clnt_info->poll_interval_millis)
 		    || temp_clnt_info->subscription_type ==
-		    CMS_VARIABLE_SUBSCRIPTION)
+		    CMS_VARIABLE_SUBSCRIPTION
+		    || temp_clnt_info->subscription_type ==
+		    CMS_DELTA_SUBSCRIPTION)
 		&& temp_clnt_info->last_id_read !=
 		server->read_reply->write_id) {
+		long client_last_id = temp_clnt_info->last_id_read;
+		int r;
 		temp_clnt_info->last_id_read = server->read_reply->write_id;
 		temp_clnt_info->last_sub_sent_time = cur_time;
 		temp_clnt_info->clnt_port->serial_number++;
 		putbe32(temp_buffer, temp_clnt_info->clnt_port->serial_number);
-		if (server->read_reply->size < 0x2000 - 20
-		    && server->read_reply->size > 0) {
-		    memcpy(temp_buffer + 20, server->read_reply->data,
-			server->read_reply->size);
-		    if (sendn
-			(temp_clnt_info->clnt_port->socket_fd, temp_buffer,
-			    20 + server->read_reply->size, 0, dtimeout) < 0) {
-			temp_clnt_info->clnt_port->errors++;
-			return;
-		    }
+		if (temp_clnt_info->subscription_type ==
+		    CMS_DELTA_SUBSCRIPTION) {
+		    delta_subscribers++;
+		    r = send_delta(temp_clnt_info, client_last_id,
+			server->read_reply);
 		} else {
-		    if (sendn(temp_clnt_info->clnt_port->socket_fd,
-			    temp_buffer, 20, 0, dtimeout) < 0) {
-			temp_clnt_info->clnt_port->errors++;
-			return;
-		    }
-		    if (server->read_reply->size > 0) {
-			if (sendn(temp_clnt_info->clnt_port->socket_fd,
-				server->read_reply->data,
-				server->read_reply->size, 0, dtimeout) < 0) {
-			    temp_clnt_info->clnt_port->errors++;
-			    return;
-			}
-		    }
+		    r = send_subscription_reply(temp_clnt_info->clnt_port, 20,
+			(const char *) server->read_reply->data,
+			server->read_reply->size);
+		}
+		if (r < 0) {
+		    temp_clnt_info->clnt_port->errors++;
+		    return;
 		}
 	    }
 	    if (temp_clnt_info->last_id_read < buf_info->min_last_id) {
@@ -1709,17 +1715,78 @@ void CMS_SERVER_REMOTE_TCP_PORT::update_subscriptions()
 	    temp_clnt_info = (TCP_CLIENT_SUBSCRIPTION_INFO *)
 		buf_info->sub_clnt_info->get_next();
 	}
+	if (delta_subscribers > 0) {
+	    /* what the next changes will be taken from */
+	    const char *data = (const char *) server->read_reply->data;
+	    buf_info->last_data.assign(data, data + server->read_reply->size);
+	    buf_info->last_write_id = server->read_reply->write_id;
+	    buf_info->delta_write_id = 0;
+	}
 	buf_info =
 	    (TCP_BUFFER_SUBSCRIPTION_INFO *) subscription_buffers->get_next();
     }
 }
 
+/* Sends the reply header of header_size bytes in temp_buffer followed by
+   size bytes of data, in one piece when they fit in temp_buffer together. */
+int CMS_SERVER_REMOTE_TCP_PORT::send_subscription_reply(CLIENT_TCP_PORT *
+    clnt, long header_size, const char *data, long size)
+{
+    putbe32(temp_buffer + 8, size + header_size - 20);
+    if (size + header_size < (long) sizeof(temp_buffer) && size > 0) {
+	memcpy(temp_buffer + header_size, data, size);
+	return sendn(clnt->socket_fd, temp_buffer, header_size + size, 0,
+	    dtimeout);
+    }
+    if (sendn(clnt->socket_fd, temp_buffer, header_size, 0, dtimeout) < 0) {
+	return -1;
+    }
+    if (size > 0) {
+	return sendn(clnt->socket_fd, data, size, 0, dtimeout);
+    }
+    return 0;
+}
+
+/* Sends a delta subscriber the changes since the message it has, or the
+   whole message if it has none or not the one they would apply to.  The
+   reply header is already in temp_buffer. */
+int CMS_SERVER_REMOTE_TCP_PORT::send_delta(TCP_CLIENT_SUBSCRIPTION_INFO *
+    clnt_info, long client_last_id, REMOTE_READ_REPLY * reply)
+{
+    TCP_BUFFER_SUBSCRIPTION_INFO *buf_info = clnt_info->sub_buf_info;
+    const char *data = (const char *) reply->data;
+
+    if (client_last_id != 0 && client_last_id == buf_info->last_write_id) {
+	/* every subscriber at the same message is sent the same changes */
+	if (buf_info->delta_write_id != reply->write_id) {
+	    buf_info->delta_write_id = reply->write_id;
+	    if (cms_make_delta(buf_info->last_data, buf_info->last_write_id,
+		    data, reply->size, buf_info->delta) < 0) {
+		buf_info->delta.clear();
+	    }
+	}
+	if (!buf_info->delta.empty()) {
+	    return send_subscription_reply(clnt_info->clnt_port, 20,
+		buf_info->delta.data(), buf_info->delta.size());
+	}
+    }
+    putbe32(temp_buffer + 20, 0);
+    putbe32(temp_buffer + 24, reply->size);
+    putbe32(temp_buffer + 28, 0);
+    putbe32(temp_buffer + 32, reply->size);
+    return send_subscription_reply(clnt_info->clnt_port,
+	20 + CMS_DELTA_HEADER_SIZE + CMS_DELTA_RUN_HEADER_SIZE, data,
+	reply->size);
+}
+
 TCP_BUFFER_SUBSCRIPTION_INFO::TCP_BUFFER_SUBSCRIPTION_INFO()
 {
     buffer_number = -1;
     min_last_id = 0;
     list_id = -1;
     sub_clnt_info = NULL;
+    last_write_id = 0;
+    delta_write_id = 0;
 }
 
 TCP_BUFFER_SUBSCRIPTION_INFO::~TCP_BUFFER_SUBSCRIPTION_INFO()
@@ -24,6 +24,7 @@
 #include <errno.h>		/* errno */
 #include <signal.h>		// SIGPIPE, signal()
 #include <sys/time.h>           /* struct timeval */
+#include <vector>
 
 #ifndef NO_THREADS
 #define NO_THREADS
@@ -35,6 +36,8 @@
 
 #define MAX_TCP_BUFFER_SIZE 16
 class CLIENT_TCP_PORT;
+class TCP_BUFFER_SUBSCRIPTION_INFO;
+class TCP_CLIENT_SUBSCRIPTION_INFO;
 
 class CMS_SERVER_REMOTE_TCP_PORT:public CMS_SERVER_REMOTE_PORT {
   public:
@@ -63,6 +66,10 @@ class CMS_SERVER_REMOTE_TCP_PORT:public CMS_SERVER_REMOTE_PORT {
     int polling_enabled;
     struct timeval select_timeout;
     void update_subscriptions();
+    int send_subscription_reply(CLIENT_TCP_PORT * clnt, long header_size,
+	const char *data, long size);
+    int send_delta(TCP_CLIENT_SUBSCRIPTION_INFO * clnt_info,
+	long client_last_id, REMOTE_READ_REPLY * reply);
     void add_subscription_client(int buffer_number, int subscription_type,
 	int poll_interval_millis, CLIENT_TCP_PORT * clnt);
     void remove_subscription_client(CLIENT_TCP_PORT * clnt,
@@ -86,6 +93,12 @@ class TCP_BUFFER_SUBSCRIPTION_INFO {
     int min_last_id;
     int list_id;
     LinkedList *sub_clnt_info;
+    std::vector<char> last_data;	/* message last sent to delta
+					   subscribers */
+    long last_write_id;
+    std::vector<char> delta;	/* changes from last_data to the message
+				   with delta_write_id */
+    long delta_write_id;
 };
 
 class TCP_CLIENT_SUBSCRIPTION_INFO {
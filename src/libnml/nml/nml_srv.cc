@@ -103,7 +103,9 @@ void NML_SERVER::delete_from_list()
 
 NML_SERVER_LOCAL_PORT::NML_SERVER_LOCAL_PORT(NML * _nml)
   : CMS_SERVER_LOCAL_PORT((CMS *)NULL),
-    batch_list_id(0)
+    batch_list_id(0),
+    encoded_write_id(0),
+    encoded_size(0)
 {
     local_channel_reused = 1;
     nml = _nml;
@@ -131,6 +133,23 @@ REMOTE_READ_REPLY *NML_SERVER_LOCAL_PORT::reader(REMOTE_READ_REQUEST * _req)
 	return ((REMOTE_READ_REPLY *) NULL);
     }
 
+    /* Each remote reader of a buffer that is not a queue asks for the
+       same message until it is written again, so rather than read and
+       encode it for each of them, send again what was encoded last if
+       the buffer has not been written since. */
+    if (_req->access_type == CMS_READ_ACCESS && !cms->queuing_enabled
+	&& cms->total_subdivisions <= 1 && encoded_write_id != 0
+	&& _req->last_id_read != encoded_write_id
+	&& cms->get_msg_count() == encoded_write_id
+	&& cms->status >= 0) {
+	read_reply.status = CMS_READ_OK;
+	read_reply.size = encoded_size;
+	read_reply.data = (unsigned char *) cms->encoded_data;
+	read_reply.write_id = encoded_write_id;
+	read_reply.was_read = 1;
+	return (&read_reply);
+    }
+
     /* Setup CMS channel from request arguments. */
     cms->in_buffer_id = _req->last_id_read;
 
@@ -160,6 +179,12 @@ REMOTE_READ_REPLY *NML_SERVER_LOCAL_PORT::reader(REMOTE_READ_REQUEST * _req)
 	read_reply.data = (unsigned char *) cms->encoded_data;
 	read_reply.write_id = cms->in_buffer_id;
 	read_reply.was_read = cms->header.was_read;
+	if (cms->status == CMS_READ_OK) {
+	    encoded_write_id = cms->in_buffer_id;
+	    encoded_size = cms->header.in_buffer_size;
+	} else {
+	    encoded_write_id = 0;
+	}
     }
 
     /* Reply structure contains the latest shared memory info-- now return it 
@@ -274,6 +299,7 @@ REMOTE_WRITE_REPLY *NML_SERVER_LOCAL_PORT::writer(REMOTE_WRITE_REQUEST * _req)
     /* Copy the encoded data to the location set up in CMS. */
     // memcpy(cms->encoded_data, _req->data, _req->size);
     cms->header.in_buffer_size = _req->size;
+    encoded_write_id = 0;	/* the data came in over what reader() kept */
     temp->size = _req->size;
     int *serial_number = cms->serial
 	? &(reinterpret_cast<RCS_CMD_MSG*>(temp)->serial_number)
@@ -38,6 +38,8 @@ class NML_SERVER_LOCAL_PORT:public CMS_SERVER_LOCAL_PORT {
     friend class NML_SUPER_SERVER;
     friend class NML_SERVER;
     int batch_list_id;
+    long encoded_write_id;	/* message left encoded by reader() */
+    long encoded_size;
 
   public:
       NML_SERVER_LOCAL_PORT(NML * _nml);
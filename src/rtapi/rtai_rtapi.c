@@ -768,6 +768,30 @@ static int task_delete(int task_id)
     return 0;
 }
 
+int rtapi_task_set_cpu(int task_id, int cpu)
+{
+    task_data *task;
+
+    /* validate task ID */
+    if ((task_id < 1) || (task_id > RTAPI_MAX_TASKS)) {
+	return -EINVAL;
+    }
+    task = &(task_array[task_id]);
+    if (task->state != PAUSED) {
+	return -EBUSY;
+    }
+    if (cpu < 0) {
+	cpu = rtapi_data->rt_cpu;
+    }
+    if ((cpu >= NR_CPUS) || !cpu_online(cpu)) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "RTAPI: rtapi_task_set_cpu: no CPU %d\n", cpu);
+	return -EINVAL;
+    }
+    rt_set_runnable_on_cpuid(ostask_array[task_id], cpu);
+    return 0;
+}
+
 int rtapi_task_start(int task_id, unsigned long int period_nsec)
 {
     int retval;
@@ -1728,6 +1752,7 @@ EXPORT_SYMBOL(rtapi_task_resume);
 EXPORT_SYMBOL(rtapi_task_pause);
 EXPORT_SYMBOL(rtapi_task_self);
 EXPORT_SYMBOL(rtapi_task_self_resync);
+EXPORT_SYMBOL(rtapi_task_set_cpu);
 EXPORT_SYMBOL(rtapi_shmem_new);
 EXPORT_SYMBOL(rtapi_shmem_delete);
 EXPORT_SYMBOL(rtapi_shmem_getptr);
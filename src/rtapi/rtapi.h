@@ -408,6 +408,21 @@ RTAPI_BEGIN_DECLS
  */
     extern int rtapi_task_delete(int task_id);
 
+/**
+ * @brief Selects the CPU a task will run on.
+ *
+ * By default all tasks run on the same CPU, chosen by RTAPI (on uspace the
+ * highest isolated CPU, or $RTAPI_CPU_NUMBER).  With this call tasks can
+ * be spread over several CPUs, e.g. to keep a fast base thread and the
+ * servo thread from delaying each other.
+ * @param task_id ID from a previous call to rtapi_task_new().
+ * @param cpu CPU number, or -1 for the default CPU.
+ * @return 0 on success, negative value on failure.  The task must not
+ *         have been started yet, or it will return @c -EBUSY.
+ * @note Call only from within init/cleanup code, not from realtime tasks.
+ */
+    extern int rtapi_task_set_cpu(int task_id, int cpu);
+
 /**
  * @brief Starts a task in periodic mode.
  *
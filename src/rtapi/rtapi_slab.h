@@ -20,12 +20,17 @@
 
 #ifdef __KERNEL__
 #include <linux/slab.h>
+#include <linux/vmalloc.h>
 
 #define rtapi_kfree kfree
 #define rtapi_kmalloc kmalloc
 #define rtapi_krealloc krealloc
 #define rtapi_kzalloc kzalloc
 
+/* for allocations too big for kmalloc; not from realtime context */
+#define rtapi_vzalloc vzalloc
+#define rtapi_vfree vfree
+
 #else
 #include <stdlib.h>
 
@@ -34,5 +39,8 @@
 #define rtapi_kzalloc(sz, flags) calloc(1,(sz))
 #define rtapi_krealloc(p, sz, flags) realloc((p), (sz))
 
+#define rtapi_vzalloc(sz) calloc(1,(sz))
+#define rtapi_vfree free
+
 #endif
 #endif
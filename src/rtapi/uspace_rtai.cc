@@ -102,7 +102,7 @@ struct RtaiApp : RtapiApp {
 
         int nprocs = sysconf(_SC_NPROCESSORS_ONLN);
         int cpus_allowed = 1 << (nprocs - 1); //Use last CPU as default
-        const static int rt_cpu_number = find_rt_cpu_number();
+        const int rt_cpu_number = task_cpu_number(task);
         if (rt_cpu_number != -1) {
             rtapi_print_msg(RTAPI_MSG_INFO, "rt_cpu_number = %i\n", rt_cpu_number);
             cpus_allowed = 1 << rt_cpu_number;
@@ -48,7 +48,7 @@ void WithRoot::init(uid_t ruid_ini, uid_t euid_ini) {
 }
 
 RtapiTask::RtapiTask()
-    : magic{}, id{}, owner{}, uses_fp{}, stacksize{}, prio{}, period{}, nextstart{}, pll_correction{},
+    : magic{}, id{}, owner{}, uses_fp{}, stacksize{}, prio{}, cpu{-1}, period{}, nextstart{}, pll_correction{},
       pll_correction_limit{}, arg{}, taskcode{}
 
 {
@@ -270,6 +270,31 @@ int RtapiApp::find_rt_cpu_number() {
 #endif
 }
 
+/* The CPU a task is bound to: the one set with rtapi_task_set_cpu(), or
+   else the shared default from find_rt_cpu_number(). */
+int RtapiApp::task_cpu_number(const RtapiTask *task) {
+    const static int rt_cpu_number = find_rt_cpu_number();
+    if (task->cpu >= 0)
+        return task->cpu;
+    return rt_cpu_number;
+}
+
+int RtapiApp::task_set_cpu(int task_id, int cpu) {
+    auto task = get_task(task_id);
+    if (!task)
+        return -EINVAL;
+    if (task->period) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "rtapi_task_set_cpu: task %d already started\n", task_id);
+        return -EBUSY;
+    }
+    if (cpu < -1 || cpu >= CPU_SETSIZE || cpu >= sysconf(_SC_NPROCESSORS_CONF)) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "rtapi_task_set_cpu: no CPU %d\n", cpu);
+        return -EINVAL;
+    }
+    task->cpu = cpu;
+    return 0;
+}
+
 void RtapiApp::set_namef(const char *fmt, ...) {
     char *buf = NULL;
     va_list ap;
@@ -69,6 +69,7 @@ struct RtapiTask {
     int uses_fp;
     size_t stacksize;
     int prio;
+    int cpu; /* CPU to run on, -1 for the default RT CPU */
     long period;
     struct timespec nextstart;
     long pll_correction;
@@ -100,6 +101,7 @@ struct RtapiApp {
     static RtapiTask *get_task(int task_id);
     void unexpected_realtime_delay(RtapiTask *task, int nperiod = 1);
     virtual int task_delete(int id) = 0;
+    int task_set_cpu(int task_id, int cpu);
     virtual int task_start(int task_id, unsigned long period_nsec) = 0;
     virtual int task_pause(int task_id) = 0;
     virtual int task_resume(int task_id) = 0;
@@ -113,6 +115,7 @@ struct RtapiApp {
     virtual long long do_get_time(void) = 0;
     virtual void do_delay(long ns) = 0;
     static int find_rt_cpu_number();
+    static int task_cpu_number(const RtapiTask *task);
     static void set_namef(const char *fmt, ...);
     int policy;
     long period;
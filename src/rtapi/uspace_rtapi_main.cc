@@ -1650,6 +1650,10 @@ int rtapi_task_delete(int id) {
     return App().task_delete(id);
 }
 
+int rtapi_task_set_cpu(int task_id, int cpu) {
+    return App().task_set_cpu(task_id, cpu);
+}
+
 int rtapi_task_start(int task_id, unsigned long period_nsec) {
     int ret = App().task_start(task_id, period_nsec);
     if (ret != 0) {
@@ -97,8 +97,8 @@ struct EvlApp : RtapiApp {
         if ((ret = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)) != 0)
             return -ret;
         if (nprocs > 1) {
-            const static int rt_cpu_number = find_rt_cpu_number();
-            rtapi_print_msg(RTAPI_MSG_INFO, "rt_cpu_number = %i\n", rt_cpu_number);
+            const int rt_cpu_number = task_cpu_number(task);
+            rtapi_print_msg(RTAPI_MSG_INFO, "task %d: rt_cpu_number = %i\n", task_id, rt_cpu_number);
             if (rt_cpu_number != -1) {
                 cpu_set_t cpuset;
                 CPU_ZERO(&cpuset);
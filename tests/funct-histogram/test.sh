@@ -0,0 +1,7 @@
+#!/bin/sh
+# the bins depend on the machine, so only check which histograms counted
+halrun -s histogram.hal | awk '
+    NF == 3 { n[$1] += $3 }
+    NF == 0 { print "siggen.0.update", (n["siggen.0.update"] > 0)
+              print "fast", (n["fast"] > 0)
+              delete n }'
@@ -0,0 +1,12 @@
+#!/bin/bash
+# a file with errors is rejected before any of it is executed: halcmd
+# fails, and signal 'c' must not show up when good.hal lists the
+# signals in the same session
+$REALTIME start
+halcmd -B -f bad.hal 2>&1 | grep '^bad.hal'
+if [ "${PIPESTATUS[0]}" -ne 0 ]; then
+    echo "bad.hal failed"
+fi
+halcmd -B -f good.hal
+echo "result $?"
+$REALTIME stop
@@ -0,0 +1,25 @@
+#!/bin/sh
+# sample the same constant values as text, as binary with tags, and as
+# binary written through a mapping, then decode the binary files
+rm -f text.out binary.out mmap.out
+halrun sampler.hal || exit 1
+cat text.out
+python3 - binary.out mmap.out <<'PY'
+import struct, sys
+for name in sys.argv[1:]:
+    data = open(name, 'rb').read()
+    magic, version, hsize, npins, flags = struct.unpack_from('=8s4I', data)
+    types = data[24:24 + npins].decode()
+    rowfmt = '=' + ('Q' if flags & 1 else '') + ''.join(
+        {'F': 'd', 'B': 'Q', 'U': 'Q', 'S': 'q', 'L': 'q', 'K': 'Q'}[t] for t in types)
+    rowsize = struct.calcsize(rowfmt)
+    rows = [struct.unpack_from(rowfmt, data, off)
+            for off in range(hsize, len(data), rowsize)]
+    print(magic.decode(), version, npins, flags, types, len(rows),
+          (len(data) - hsize) % rowsize)
+    if flags & 1:
+        tags = [r[0] for r in rows]
+        print('consecutive', tags == list(range(tags[0], tags[0] + len(tags))))
+        rows = [r[1:] for r in rows]
+    print(sorted(set(rows)))
+PY
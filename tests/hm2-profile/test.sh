@@ -0,0 +1,12 @@
+#!/bin/sh
+# the times depend on the machine, so only check that every step of the
+# full test board is timed, that its counters turned and which remotes
+# were found
+halrun -s profile.hal | awk '
+    $NF ~ /\.profile\..*\.time$/ { time++ }
+    $NF ~ /\.profile\..*\.tmax$/ { tmax++ }
+    $NF ~ /\.encoder\.00\.count$/ || $NF ~ /\.stepgen\.00\.counts$/ { print $NF, ($(NF-1) > 0) }
+    $NF ~ /\.(7i64|8i20)\./ { split($NF, n, "."); remote[n[3] "." n[4] "." n[5]] = 1 }
+    END { print "profile time pins", time
+          print "profile tmax params", tmax
+          for (r in remote) print r }' | sort
@@ -0,0 +1,8 @@
+#!/bin/bash
+# the program ends in an error, which is part of the result
+err=$(mktemp)
+rs274 -g test.ngc 2>$err | awk '{$1=""; print}'
+status=${PIPESTATUS[0]}
+tail -n 2 $err
+rm -f $err
+test "$status" = 1
@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# #<_hal[...]> parameters are read through references the interpreter
+# keeps after the first lookup.  Change values, links and signals between
+# reads (from the message callback, while the program runs) and check
+# that every read sees the current state.
+import os
+import subprocess
+import tempfile
+import gcode
+import hal
+
+def cmd(arg):
+    subprocess.call(arg, shell=True)
+
+h = hal.component("halparams")
+h.newpin("out", hal.HAL_FLOAT, hal.HAL_OUT)
+h.newpin("in", hal.HAL_S32, hal.HAL_IN)
+h.ready()
+h['out'] = 1.5
+
+steps = [
+    lambda: None,
+    lambda: h.__setitem__('out', 2.5),
+    lambda: None,
+    lambda: (cmd("halcmd net s32sig halparams.in"), cmd("halcmd sets s32sig 7")),
+    lambda: None,
+    lambda: cmd("halcmd sets s32sig 8"),
+    lambda: cmd("halcmd unlinkp halparams.in"),
+    lambda: (cmd("halcmd delsig s32sig"), cmd("halcmd newsig s32sig float"),
+             cmd("halcmd sets s32sig 9.5")),
+    lambda: None,
+    lambda: None,
+]
+
+class Canon:
+    use_move_batches = False
+
+    def __getattr__(self, attr):
+        def inner(*args):
+            pass
+        return inner
+
+    def message(self, text):
+        print(text)
+        steps.pop(0)()
+
+    def get_external_length_units(self): return 1.0
+    def get_external_angular_units(self): return 1.0
+    def get_axis_mask(self): return 7 # (x y z)
+    def get_block_delete(self): return False
+    def get_tool(self, pocket):
+        return -1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0
+
+with tempfile.TemporaryDirectory() as d:
+    os.chdir(d)
+    parameter = tempfile.NamedTemporaryFile()
+    canon = Canon()
+    canon.parameter_file = parameter.name
+
+    with open("test.ngc", "w") as f:
+        f.write("(debug,out #<_hal[halparams.out]>)\n"
+                "(debug,out #<_hal[halparams.out]>)\n"
+                "(debug,out #<_hal[halparams.out]>)\n"
+                "(debug,in #<_hal[halparams.in]>)\n"
+                "(debug,in #<_hal[halparams.in]>)\n"
+                "(debug,signal #<_hal[s32sig]>)\n"
+                "(debug,in #<_hal[halparams.in]>)\n"
+                "(debug,signal #<_hal[s32sig]>)\n"
+                "(debug,signal #<_hal[s32sig]>)\n"
+                "(debug,in #<_hal[halparams.in]>)\n"
+                "M2\n")
+    result, seq = gcode.parse("test.ngc", canon, '', '', '')
+    if result > gcode.MIN_ERROR:
+        print(gcode.strerror(result))
+
+h.exit()
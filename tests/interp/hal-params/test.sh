@@ -0,0 +1,6 @@
+#!/bin/bash
+$REALTIME start
+INI_FILE_NAME=$(pwd)/test.ini python3 test.py
+STATUS=$?
+$REALTIME stop
+exit $STATUS
@@ -0,0 +1,13 @@
+#!/bin/bash
+set -e
+
+# RIP layout: $HEADERS is $TOPDIR/include
+TOPDIR=$(dirname "$HEADERS")
+SRC=$TOPDIR/src/emc/rs274ngc
+
+g++ -O2 -Wall -I"$SRC" -o test_parammap test_parammap.cc "$SRC/interp_parammap.cc"
+
+# test_parammap -b compares a call frame's worth of parameters in
+# parameter_map with the std::map it replaced
+./test_parammap
+rm -f test_parammap
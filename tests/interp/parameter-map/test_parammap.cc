@@ -0,0 +1,204 @@
+/*
+ * Checks of parameter_map, the named parameter table of a call frame,
+ * and with -b a benchmark of it against the std::map it replaced.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <map>
+#include <set>
+#include <string>
+
+#include "interp_parammap.hh"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+// as strstore() does
+static const char *intern(const std::string &s)
+{
+    static std::set<std::string> strings;
+    return strings.insert(s).first->c_str();
+}
+
+static void test_find_and_insert(void)
+{
+    parameter_map m;
+
+    CHECK(m.empty());
+    CHECK(m.find("a") == m.end());
+    m[intern("a")].value = 1.0;
+    m[intern("_Global")].value = 2.0;
+    CHECK(m.size() == 2);
+    CHECK(m.find("a") != m.end() && m.find("a")->second.value == 1.0);
+    // names compare without regard to case
+    CHECK(m.find("_global") != m.end() && m.find("_GLOBAL")->second.value == 2.0);
+    CHECK(strcmp(m.find("_global")->first, "_Global") == 0);
+    CHECK(m.find("b") == m.end());
+    // operator[] adds a zero value
+    CHECK(m["new"].value == 0.0 && m["new"].attr == 0);
+    CHECK(m.size() == 3);
+}
+
+static void test_many(void)
+{
+    parameter_map m;
+    char name[32];
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "p%d", i);
+        m[intern(name)].value = i;
+    }
+    CHECK(m.size() == 1000);
+    for (i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "P%d", i);
+        parameter_map::iterator it = m.find(name);
+        CHECK(it != m.end() && it->second.value == i);
+    }
+    // entries are visited in the order they were added
+    i = 0;
+    for (parameter_map::iterator it = m.begin(); it != m.end(); ++it, i++)
+        CHECK(it->second.value == i);
+    CHECK(i == 1000);
+}
+
+static void test_references_stay(void)
+{
+    parameter_map m;
+    char name[32];
+
+    parameter_value &first = m[intern("first")];
+    first.value = 42.0;
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "x%d", i);
+        m[intern(name)].value = i;
+    }
+    CHECK(&first == &m.find("first")->second);
+    CHECK(first.value == 42.0);
+}
+
+static void test_erase(void)
+{
+    parameter_map m;
+
+    m[intern("a")].value = 1.0;
+    m[intern("b")].value = 2.0;
+    m[intern("c")].value = 3.0;
+    CHECK(m.erase("B") == 1);
+    CHECK(m.erase("b") == 0);
+    CHECK(m.size() == 2);
+    CHECK(m.find("b") == m.end());
+    CHECK(m.find("a")->second.value == 1.0);
+    CHECK(m.find("c")->second.value == 3.0);
+    parameter_map::iterator it = m.begin();
+    CHECK(strcmp(it->first, "a") == 0);
+    ++it;
+    CHECK(strcmp(it->first, "c") == 0);
+    m[intern("b")].value = 4.0;
+    CHECK(m.find("b")->second.value == 4.0);
+}
+
+static void test_clear_and_copy(void)
+{
+    parameter_map m;
+
+    m[intern("a")].value = 1.0;
+    m[intern("b")].value = 2.0;
+    m.clear();
+    CHECK(m.empty());
+    CHECK(m.find("a") == m.end());
+    CHECK(m.begin() == m.end());
+    m[intern("b")].value = 5.0;
+    CHECK(m.size() == 1 && m.find("b")->second.value == 5.0);
+
+    parameter_map copy(m);
+    m[intern("b")].value = 6.0;
+    CHECK(copy.size() == 1 && copy.find("B")->second.value == 5.0);
+    copy = m;
+    CHECK(copy.find("b")->second.value == 6.0);
+}
+
+// A subroutine's frame: its parameters are set on entry, each is read
+// several times, and they are forgotten on return.
+struct nocase_cmp {
+    bool operator()(const char *s1, const char *s2) const {
+        return strcasecmp(s1, s2) < 0;
+    }
+};
+typedef std::map<const char *, parameter_value, nocase_cmp> old_map;
+
+template <class Map>
+static double bench(const char **names, int nnames, int calls)
+{
+    Map frame;
+    double sum = 0.0;
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int c = 0; c < calls; c++) {
+        for (int i = 0; i < nnames; i++)
+            frame[names[i]].value = i + c;
+        for (int r = 0; r < 8; r++)
+            for (int i = 0; i < nnames; i++)
+                sum += frame.find(names[i])->second.value;
+        frame.clear();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (sum == 0.0)
+        printf("?\n");
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / calls;
+}
+
+static void benchmark(void)
+{
+    static const char *words[] = {
+        "x_start", "y_start", "x_end", "y_end", "depth", "step_down",
+        "feed", "plunge", "tool_dia", "stepover", "passes", "pass",
+        "x", "y", "z", "i", "j", "k", "angle", "radius",
+        "corner", "finish", "safe_z", "count", "_global_a", "_global_b",
+        "a", "b", "c", "n",
+    };
+    const int nnames = sizeof(words) / sizeof(words[0]);
+    const char *names[nnames];
+    static const int sizes[] = { 5, 10, 20, 30 };
+
+    for (int i = 0; i < nnames; i++)
+        names[i] = intern(words[i]);
+    for (int n : sizes) {
+        int calls = 2000000 / n;
+        printf("%2d parameters, 8 reads each: std::map %7.0f ns/call, "
+               "parameter_map %7.0f ns/call\n", n,
+               bench<old_map>(names, n, calls),
+               bench<parameter_map>(names, n, calls));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        benchmark();
+        return 0;
+    }
+
+    test_find_and_insert();
+    test_many();
+    test_references_stay();
+    test_erase();
+    test_clear_and_copy();
+
+    if (failures) {
+        printf("%d check(s) FAILED\n", failures);
+        return 1;
+    }
+    printf("all parameter_map checks passed\n");
+    return 0;
+}
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+# The interpreter remembers where a subroutine file was found and where its
+# definition starts across programs.  Run the same program twice, then edit
+# the subroutine file so the definition moves, and run it again.
+import os
+import tempfile
+import gcode
+
+class Canon:
+    use_move_batches = False
+
+    def __getattr__(self, attr):
+        def inner(*args):
+            pass
+        return inner
+
+    def message(self, text):
+        print(text)
+
+    def get_external_length_units(self): return 1.0
+    def get_external_angular_units(self): return 1.0
+    def get_axis_mask(self): return 7 # (x y z)
+    def get_block_delete(self): return False
+    def get_tool(self, pocket):
+        return -1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0
+
+def run(canon, name):
+    result, seq = gcode.parse(name, canon, '', '', '')
+    if result > gcode.MIN_ERROR:
+        print(gcode.strerror(result))
+
+with tempfile.TemporaryDirectory() as d:
+    os.chdir(d)
+    parameter = tempfile.NamedTemporaryFile()
+    canon = Canon()
+    canon.parameter_file = parameter.name
+
+    with open("main.ngc", "w") as f:
+        f.write("o<cached> call [1]\no<cached> call [2]\nM2\n")
+    with open("cached.ngc", "w") as f:
+        f.write("o<cached> sub\n(debug,first #1)\no<cached> endsub\nM2\n")
+
+    run(canon, "main.ngc")
+    run(canon, "main.ngc")
+
+    with open("cached.ngc", "w") as f:
+        f.write("o<other> sub\n(debug,wrong)\no<other> endsub\n"
+                "o<cached> sub\n(debug,edited #1)\no<cached> endsub\nM2\n")
+    run(canon, "main.ngc")
@@ -0,0 +1,131 @@
+/*
+ * Reads a status buffer that keeps changing through a delta subscription.
+ *
+ * "server" serves the buffer, "writer" writes N messages to it, each
+ * changing a few fields and now and then many, and "reader" follows
+ * them as a delta subscriber.  Every message carries a checksum of its
+ * fields, so a change applied to the wrong message, or not applied at
+ * all, shows up as a message that doesn't add up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libnml/nml/nml.hh"
+#include "libnml/nml/nmlmsg.hh"
+#include "libnml/nml/nml_srv.hh"
+#include "libnml/cms/cms.hh"
+#include "libnml/os_intf/timer.hh"
+
+#define TEST_STATUS_TYPE ((NMLTYPE) 7413)
+#define NVALUES 200
+
+class TEST_STATUS:public NMLmsg {
+  public:
+    TEST_STATUS():NMLmsg(TEST_STATUS_TYPE, sizeof(TEST_STATUS)) {}
+    void update(CMS *cms) {
+	cms->update(count);
+	cms->update(values, NVALUES);
+	cms->update(name, sizeof(name));
+	cms->update(sum);
+    }
+    int count;
+    double values[NVALUES];
+    char name[40];
+    int sum;
+};
+
+static int testFormat(NMLTYPE type, void *buffer, CMS *cms)
+{
+    switch (type) {
+    case TEST_STATUS_TYPE:
+	((TEST_STATUS *) buffer)->update(cms);
+	return 1;
+    }
+    return 0;
+}
+
+static int checksum(const TEST_STATUS *s)
+{
+    unsigned h = s->count;
+    for (int i = 0; i < NVALUES; i++) {
+	h = h * 31 + (unsigned) (s->values[i] * 4);
+    }
+    for (const char *p = s->name; *p; p++) {
+	h = h * 31 + (unsigned char) *p;
+    }
+    return (int) h;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+	fprintf(stderr, "usage: %s server|writer N|reader N file\n", argv[0]);
+	return 1;
+    }
+    const char *mode = argv[1];
+    const char *file = argv[argc - 1];
+    int n = argc > 3 ? atoi(argv[2]) : 0;
+
+    if (!strcmp(mode, "server")) {
+	NML *c = new NML(testFormat, "testStatus", "server", file);
+	if (!c->valid()) {
+	    return 1;
+	}
+	run_nml_servers();
+	return 0;
+    }
+
+    if (!strcmp(mode, "writer")) {
+	NML *c = new NML(testFormat, "testStatus", "writer", file);
+	if (!c->valid()) {
+	    return 1;
+	}
+	TEST_STATUS *s = new TEST_STATUS;
+	memset(s->values, 0, sizeof(s->values));
+	strcpy(s->name, "start");
+	for (int i = 1; i <= n; i++) {
+	    s->count = i;
+	    s->values[i % NVALUES] = i * 0.25;
+	    s->values[(i * 7) % NVALUES] += 1;
+	    if (i % 10 == 0) {
+		snprintf(s->name, sizeof(s->name), "%s%d",
+		    i % 20 ? "message-" : "m", i);
+	    }
+	    if (i % 25 == 0) {
+		/* most of the message changes */
+		for (int j = 0; j < NVALUES; j++) {
+		    s->values[j] = i + j;
+		}
+	    }
+	    s->sum = checksum(s);
+	    c->write(s);
+	    esleep(0.01);
+	}
+	delete s;
+	delete c;
+	return 0;
+    }
+
+    NML *c = new NML(testFormat, "testStatus", "delta", file);
+    if (!c->valid()) {
+	return 1;
+    }
+    int last = 0;
+    int bad = 0;
+    double end = etime() + 30;
+    while (last < n && etime() < end) {
+	if (c->read() == TEST_STATUS_TYPE) {
+	    TEST_STATUS *s = (TEST_STATUS *) c->get_address();
+	    if (s->sum != checksum(s) || s->count < last) {
+		bad++;
+	    }
+	    last = s->count;
+	}
+	esleep(0.001);
+    }
+    printf("reader: last message %d, %d bad\n", last, bad);
+    delete c;
+    return last == n && bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+# A delta subscriber follows a status buffer that keeps changing.
+# RIP-only: builds the test driver against the in-tree libnml headers.
+
+SCRIPTDIR="$(cd "$(dirname "$0")" && pwd)"
+TOPDIR="$(cd "$SCRIPTDIR/../../.." && pwd)"
+SRCDIR="${TOPDIR}/src"
+
+if [ ! -f "${SRCDIR}/libnml/nml/nml.hh" ]; then
+    echo "skip: libnml sources not found (RIP build required)"
+    exit 0
+fi
+
+g++ -O -Wall \
+    -I"${SRCDIR}" \
+    -I"${HEADERS}" \
+    "${SCRIPTDIR}/nmldelta.cc" \
+    -o "${SCRIPTDIR}/nmldelta" \
+    -L"${LIBDIR}" -Wl,-rpath,"${LIBDIR}" -lnml \
+    || { echo "compile failed"; exit 1; }
+
+cd "${SCRIPTDIR}"
+./nmldelta server test.nml &
+server=$!
+sleep 1
+./nmldelta reader 300 test.nml &
+reader=$!
+sleep 1
+./nmldelta writer 300 test.nml
+wait $reader
+exitval=$?
+kill $server
+wait $server 2>/dev/null
+rm -f nmldelta
+exit $exitval
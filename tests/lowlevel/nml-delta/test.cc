@@ -0,0 +1,142 @@
+/*
+ * Round trip test for cms_make_delta() and cms_apply_delta().
+ *
+ * Takes the changes between two messages and applies them to a copy of
+ * the first, for messages that change in place, grow and shrink, and
+ * checks that the copy then holds the second.  Changes taken against
+ * one message must not be applied to another.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "cms_delta.hh"
+#include "libnml/buffer/rem_msg.hh"
+
+#define MAX_SIZE 4096
+
+static int errors;
+
+static std::vector<char> message(long size, int seed)
+{
+    std::vector<char> m(size);
+    for (long i = 0; i < size; i++) {
+	m[i] = (char) (i * 7 + seed);
+    }
+    return m;
+}
+
+/* takes the changes from old (write id 17) to data, applies them to an
+   image of old, and returns the size of the delta, or -1 if it was
+   the whole message */
+static long round_trip(const char *what, const std::vector<char> &old,
+    const std::vector<char> &data)
+{
+    std::vector<char> delta;
+    std::vector<char> image(MAX_SIZE);
+
+    memcpy(image.data(), old.data(), old.size());
+    if (cms_make_delta(old, 17, data.data(), data.size(), delta) < 0) {
+	return -1;
+    }
+    long size = cms_apply_delta(image, 17, delta.data(), delta.size());
+    if (size != (long) data.size()
+	|| memcmp(image.data(), data.data(), size) != 0) {
+	printf("%s: image does not match the new message\n", what);
+	errors++;
+    }
+    return delta.size();
+}
+
+int main(void)
+{
+    std::vector<char> old = message(1002, 0);
+    std::vector<char> data;
+    std::vector<char> delta;
+    long n;
+
+    /* a few fields change, one of them in the short last word */
+    data = old;
+    data[8]++;
+    data[500]++;
+    data[503]++;
+    data[1001]++;
+    n = round_trip("changed", old, data);
+    if (n < 0 || n > CMS_DELTA_HEADER_SIZE + 3 * (CMS_DELTA_RUN_HEADER_SIZE + 4)) {
+	printf("changed: delta of %ld bytes for three words\n", n);
+	errors++;
+    }
+
+    /* nothing changes */
+    n = round_trip("unchanged", old, old);
+    if (n != CMS_DELTA_HEADER_SIZE) {
+	printf("unchanged: delta of %ld bytes\n", n);
+	errors++;
+    }
+
+    /* changes close together go in one run */
+    data = old;
+    data[100]++;
+    data[108]++;
+    round_trip("near", old, data);
+
+    /* the message grows, the new end is sent */
+    data = old;
+    data.resize(1502, 'x');
+    data[20]++;
+    if (round_trip("grown", old, data) < 0) {
+	printf("grown: sent whole\n");
+	errors++;
+    }
+
+    /* the message shrinks */
+    data = old;
+    data.resize(601);
+    data[600]++;
+    if (round_trip("shrunk", old, data) < 0) {
+	printf("shrunk: sent whole\n");
+	errors++;
+    }
+
+    /* everything changes, the whole message is cheaper */
+    data = message(1002, 1);
+    if (round_trip("rewritten", old, data) >= 0) {
+	printf("rewritten: changes sent instead of the whole message\n");
+	errors++;
+    }
+
+    /* changes for write id 17 don't apply to the image of write id 16 */
+    std::vector<char> image(MAX_SIZE);
+    data = old;
+    data[8]++;
+    cms_make_delta(old, 17, data.data(), data.size(), delta);
+    if (cms_apply_delta(image, 16, delta.data(), delta.size()) != -1) {
+	printf("stale: applied to the wrong message\n");
+	errors++;
+    }
+
+    /* nor does a message bigger than the image */
+    data = message(MAX_SIZE + 4, 0);
+    cms_make_delta(std::vector<char>(), 17, data.data(), data.size(), delta);
+    if (cms_apply_delta(image, 17, delta.data(), delta.size()) != -1) {
+	printf("too big: applied past the end of the image\n");
+	errors++;
+    }
+
+    /* a cut off delta is refused */
+    data = old;
+    data[8]++;
+    cms_make_delta(old, 17, data.data(), data.size(), delta);
+    if (cms_apply_delta(image, 17, delta.data(), delta.size() - 1) != -1) {
+	printf("truncated: applied\n");
+	errors++;
+    }
+
+    if (errors == 0) {
+	printf("test passed\n");
+    } else {
+	printf("test FAILED with %d errors\n", errors);
+    }
+    return errors != 0;
+}
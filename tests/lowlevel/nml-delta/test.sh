@@ -0,0 +1,24 @@
+#!/bin/sh
+# Round trip of the changes sent to NML delta subscribers.
+# RIP-only: builds the test driver against the in-tree libnml sources.
+
+SCRIPTDIR="$(cd "$(dirname "$0")" && pwd)"
+TOPDIR="$(cd "$SCRIPTDIR/../../.." && pwd)"
+SRCDIR="${TOPDIR}/src"
+
+if [ ! -f "${SRCDIR}/libnml/cms/cms_delta.cc" ]; then
+    echo "skip: libnml sources not found (RIP build required)"
+    exit 0
+fi
+
+g++ -O -Wall \
+    -I"${SRCDIR}" \
+    -I"${SRCDIR}/libnml/cms" \
+    "${SCRIPTDIR}/test.cc" \
+    "${SRCDIR}/libnml/cms/cms_delta.cc" \
+    -o "${SCRIPTDIR}/test" || { echo "compile failed"; exit 1; }
+
+"${SCRIPTDIR}/test"
+exitval=$?
+rm -f "${SCRIPTDIR}/test"
+exit $exitval
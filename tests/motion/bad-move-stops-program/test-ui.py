@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+#
+# Runs programs that have a move motion refuses, followed by a line
+# that makes task wait for motion, through linuxcncrsh.  The bad move
+# fills a batch of moves, so it goes to motion without task waiting
+# for it.  Each program must stop at the bad move: the Y move after it
+# must not happen and the M62 output must not come on.
+#
+
+import os
+import socket
+import subprocess
+import sys
+import time
+
+# let linuxcnc come up
+for attempt in range(80):
+    try:
+        sock = socket.create_connection(("localhost", 5007))
+        break
+    except OSError:
+        time.sleep(0.25)
+else:
+    print("connection to linuxcncrsh timed out")
+    sys.exit(1)
+sock.settimeout(60)
+rsh = sock.makefile("rw")
+
+def cmd(c):
+    rsh.write(c + "\r\n")
+    rsh.flush()
+    return rsh.readline().strip()
+
+def pin(name):
+    out = subprocess.run(["halcmd", "-s", "show", "pin", name],
+                         capture_output=True, text=True).stdout.split()
+    return out[3]
+
+cmd("hello EMC test 1.0")
+rsh.write("set echo off\r\n")
+rsh.flush()
+rsh.readline()
+cmd("set verbose on")
+cmd("set enable EMCTOO")
+cmd("set estop off")
+cmd("set machine on")
+cmd("set mode auto")
+
+res = 0
+for prog in ("g64.ngc", "m62.ngc"):
+    cmd("set open " + os.path.abspath(prog))
+    cmd("set run")
+    time.sleep(0.5)
+    end = time.time() + 30
+    while "IDLE" not in cmd("get program_status"):
+        if time.time() > end:
+            print("%s: still running" % prog)
+            sys.exit(1)
+        time.sleep(0.05)
+
+    y = float(pin("joint.1.pos-cmd"))
+    dout = pin("motion.digital-out-00")
+    print("%s: Y=%.4f digital-out-00=%s" % (prog, y, dout))
+    if y != 0.0 or dout != "FALSE":
+        print("*** ERROR %s carried on after the bad move" % prog)
+        res = 1
+
+cmd("shutdown")
+sys.exit(res)
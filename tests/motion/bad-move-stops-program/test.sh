@@ -0,0 +1,10 @@
+#!/bin/bash
+
+linuxcnc -r test.ini 1>&2 &
+linuxcncpid=$!
+
+./test-ui.py
+res=$?
+
+wait "$linuxcncpid"
+exit $res
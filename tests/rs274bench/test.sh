@@ -0,0 +1,9 @@
+#!/bin/bash
+# Timings depend on the host, so only check that every program of the
+# corpus ran and what it did: lines read and canon calls made.
+set -o pipefail
+{
+    rs274bench surface.ngc arcs.ngc nested-owords.ngc lathe-g7x.ngc \
+        canned-cycles.ngc &&
+    rs274bench -i remap.ini remap.ngc
+} | awk '$1 ~ /\.ngc$/ { print $1, $2, $3 }'
@@ -0,0 +1,7 @@
+#!/bin/sh
+# Timings depend on the host, so only check what the simulated run
+# produced: every segment planned, and a smooth polyline run near the
+# programmed feed.
+tpbench -n 2000 | awk '
+    /^segments:/ || /^path length:/ || /^programmed feed:/ { print }
+    /^achieved feed:/ { gsub(/[(%)]/, "", $5); print "achieved feed above 95%:", ($5 > 95) }'